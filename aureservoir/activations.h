@@ -95,26 +95,63 @@ inline void act_invtanh(T *data, int size)
 //! @name tanh2 activation functions
 //@{
 
-/// slope vector for tanh2
-static DEVector<double>::Type tanh2_a_;
-/// bias vector for tanh2
-static DEVector<double>::Type tanh2_b_;
-
 /*!
  * tanh2 activation function with local slope a and bias b
  * this means the following: y(x) = tanh( a*x + b )
- * where a and b are vetors with same size as the data
+ * where a and b are vetors with same size as the data,
+ * each network has its own slope and bias \sa ESN::actTanh2
  * @param data pointer to the data
  * @param size of the data
+ * @param a pointer to the slope vector
+ * @param b pointer to the bias vector
  */
 template <typename T>
-inline void act_tanh2(T *data, int size)
+inline void act_tanh2(T *data, int size, const double *a, const double *b)
 {
-  assert( tanh2_a_.length() == size );
-  assert( tanh2_b_.length() == size );
+  for(int i=0; i<size; ++i)
+    data[i] = tanh( data[i]*a[i] + b[i] );
+}
+
+/*!
+ * Gaussian-IP update of slope a and bias b of the tanh2 activation
+ * function, averaged over count pre-activation vectors.
+ * For each neuron with pre-activation x and y = tanh( a*x + b ):
+ * db = -lr * ( -mean/var + (y/var)*(2*var+1-y^2+y*mean) )
+ * b = b + db, a = a + lr/a + db*x
+ * \sa "Adapting reservoirs to get Gaussian distributions" by David
+ *     Verstraeten, Benjamin Schrauwen and Dirk Stroobandt
+ * @param x pointers to count pre-activation vectors
+ * @param count nr of pre-activation vectors
+ * @param size of each vector
+ * @param a pointer to the slope vector
+ * @param b pointer to the bias vector
+ * @param lr learnrate
+ * @param mean desired mean
+ * @param var desired variance
+ */
+template <typename T>
+inline void tanh2_ip_update(const T *const *x, int count, int size,
+                            double *a, double *b,
+                            double lr, double mean, double var)
+{
+  const double c1 = -mean/var, c2 = 2*var+1;
 
   for(int i=0; i<size; ++i)
-    data[i] = tanh( data[i]*tanh2_a_(i+1) + tanh2_b_(i+1) );
+  {
+    double db = 0., dbx = 0.;
+
+    for(int k=0; k<count; ++k)
+    {
+      double xk = x[k][i];
+      double y = tanh( xk*a[i] + b[i] );
+      double dbk = -lr * ( c1 + (y/var)*(c2-y*y+y*mean) );
+      db += dbk;
+      dbx += dbk*xk;
+    }
+
+    b[i] += db / count;
+    a[i] += lr/a[i] + dbx / count;
+  }
 }
 
 /*!
@@ -122,15 +159,14 @@ inline void act_tanh2(T *data, int size)
  * this means the following: y(x) = (atanh(x) - b) / a
  * @param data pointer to the data
  * @param size of the data
+ * @param a pointer to the slope vector
+ * @param b pointer to the bias vector
  */
 template <typename T>
-inline void act_invtanh2(T *data, int size)
+inline void act_invtanh2(T *data, int size, const double *a, const double *b)
 {
-  assert( tanh2_a_.length() == size );
-  assert( tanh2_b_.length() == size );
-
   for(int i=0; i<size; ++i)
-    data[i] = ( atanh(data[i]) - tanh2_b_(i+1) ) / tanh2_a_(i+1);
+    data[i] = ( atanh(data[i]) - b[i] ) / a[i];
 }
 
 //@}
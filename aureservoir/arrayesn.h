@@ -23,6 +23,7 @@
 #include "esn.h"
 #include <vector>
 #include <algorithm>
+#include <string>
 
 namespace aureservoir
 {
@@ -40,6 +41,15 @@ namespace aureservoir
  * This is a standard trick to boost performance, as described in
  * \sa "Harnessing nonlinearity: predicting chaotic systems and saving energy
  *      in wireless telecommunication" by Jäger and Haas
+ *
+ * Each network has its own random number stream (the seed of network i
+ * is derived from the seed and i, \sa setSeed), so the networks are
+ * initialized, trained and simulated in parallel with OpenMP and the
+ * results do not depend on the nr of threads.
+ *
+ * After training, the networks can be fused into one big network for
+ * simulation (\sa fuse), so that each step is one sparse matrix-vector
+ * product and one readout instead of one for each network.
  */
 template <typename T = float>
 class ArrayESN
@@ -63,23 +73,37 @@ class ArrayESN
     // create array of ESNs
     for(int i=0; i<array_size_; ++i)
       esns_.push_back(model);
+
+    setSeed( RandomStream::defaultSeed() );
+    fused_valid_ = false;
   }
 
   /// Destructor
   ~ArrayESN() {}
 
   /*!
-   * Initializes all networks
+   * Initializes all networks in parallel
    */
   void init()
     throw(AUExcept)
   {
+    std::string error;
+
+    #pragma omp parallel for schedule(dynamic) if(array_size_ > 1)
     for(int i=0; i<array_size_; ++i)
-      esns_[i].init();
+    {
+      set_denormal_flags();
+      try { esns_[i].init(); }
+      catch(AUExcept &e) { setError(error, e); }
+    }
+    fused_valid_ = false;
+
+    if( !error.empty() )
+      throw AUExcept(error);
   }
 
   /*!
-   * Trains all networks independently
+   * Trains all networks independently and in parallel
    *
    * @param in matrix of input values (inputs x timesteps)
    * @param out matrix of desired output values (outputs x timesteps)
@@ -91,8 +115,19 @@ class ArrayESN
              const typename ESN<T>::DEMatrix &out, int washout)
     throw(AUExcept)
   {
+    std::string error;
+
+    #pragma omp parallel for schedule(dynamic) if(array_size_ > 1)
     for(int i=0; i<array_size_; ++i)
-      esns_[i].train(in,out,washout);
+    {
+      set_denormal_flags();
+      try { esns_[i].train(in,out,washout); }
+      catch(AUExcept &e) { setError(error, e); }
+    }
+    fused_valid_ = false;
+
+    if( !error.empty() )
+      throw AUExcept(error);
   }
 
   /*!
@@ -127,12 +162,123 @@ class ArrayESN
     train(flin, flout, washout);
   }
 
+  /*!
+   * Fuses all trained networks into one network, which is used by
+   * simulate() until the networks are initialized or trained again.
+   *
+   * The reservoirs are packed into one block diagonal sparse matrix with
+   * a stacked state vector, Win and Wback are stacked and the readout
+   * is [Wout_1 ... Wout_K]/K with the summed input weights, so that the
+   * output of the fused network is the average output of the array.
+   * The states of the networks are copied into the fused network before
+   * and back after each simulation, the slope and bias of tanh2 neurons
+   * are stacked like the states.
+   *
+   * \note only possible for SIM_STD and SIM_LI with a linear output
+   *       activation function (otherwise the average of the outputs is
+   *       not a linear readout)
+   * \note with noise the results are only statistically the same,
+   *       because the fused network draws all noise from one stream
+   */
+  void fuse()
+    throw(AUExcept)
+  {
+    ESN<T> &model = esns_[0];
+    int alg = model.net_info_[ESN<T>::SIMULATE_ALG];
+    if( alg != SIM_STD && alg != SIM_LI )
+      throw AUExcept("ArrayESN::fuse: only SIM_STD and SIM_LI are supported!");
+    if( model.getOutputAct() != ACT_LINEAR )
+      throw AUExcept("ArrayESN::fuse: only linear output activation is supported!");
+
+    int N = model.neurons_;
+    int inputs = model.inputs_;
+    int outputs = model.outputs_;
+    int size = array_size_*N;
+    for(int i=0; i<array_size_; ++i)
+      if( esns_[i].Wout_.numRows() != outputs ||
+          esns_[i].Wout_.numCols() != N+inputs )
+        throw AUExcept("ArrayESN::fuse: networks must be trained first!");
+
+    // same settings and algorithms as the networks
+    fused_ = model;
+    fused_.neurons_ = size;
+
+    // block diagonal reservoir
+    typename SPMatrix<T>::Type W(size, size);
+    typedef typename SPMatrix<T>::Type::const_iterator It;
+    for(int i=0; i<array_size_; ++i)
+    {
+      const typename SPMatrix<T>::Type &Wi = esns_[i].getW();
+      for(It it=Wi.begin(); it!=Wi.end(); ++it)
+        W(i*N + it->first.first, i*N + it->first.second) = it->second;
+    }
+    W.finalize();
+    fused_.W_ = W;
+    fused_.topology_ = TOPOLOGY_SPARSE;
+    fused_.W_pending_ = false;
+
+    // stacked input and feedback weights, averaged readout
+    fused_.Win_.resize(size, inputs);
+    fused_.Wback_.resize(size, outputs);
+    fused_.Wout_.resize(outputs, size+inputs);
+    fused_.x_.resize(size);
+    std::fill_n( fused_.Wout_.data(), outputs*(size+inputs), 0 );
+    T scale = T(1) / array_size_;
+    for(int i=0; i<array_size_; ++i)
+    {
+      // column major, each column of Win_i/Wback_i is one block of rows
+      const T *win = esns_[i].Win_.data();
+      for(int j=0; j<inputs; ++j)
+        std::copy( win+j*N, win+(j+1)*N, fused_.Win_.data()+j*size+i*N );
+      const T *wback = esns_[i].Wback_.data();
+      for(int j=0; j<outputs; ++j)
+        std::copy( wback+j*N, wback+(j+1)*N, fused_.Wback_.data()+j*size+i*N );
+
+      for(int j=1; j<=outputs; ++j)
+      {
+        for(int k=1; k<=N; ++k)
+          fused_.Wout_(j,i*N+k) = scale * esns_[i].Wout_(j,k);
+        for(int k=1; k<=inputs; ++k)
+          fused_.Wout_(j,size+k) += scale * esns_[i].Wout_(j,N+k);
+      }
+    }
+
+    // stacked slope and bias of tanh2 neurons
+    if( model.getReservoirAct() == ACT_TANH2 )
+    {
+      fused_.tanh2_a_.resize(size);
+      fused_.tanh2_b_.resize(size);
+      for(int i=0; i<array_size_; ++i)
+      {
+        if( esns_[i].tanh2_a_.length() != N || esns_[i].tanh2_b_.length() != N )
+          throw AUExcept("ArrayESN::fuse: networks must be initialized first!");
+        std::copy( esns_[i].tanh2_a_.data(), esns_[i].tanh2_a_.data()+N,
+                   fused_.tanh2_a_.data()+i*N );
+        std::copy( esns_[i].tanh2_b_.data(), esns_[i].tanh2_b_.data()+N,
+                   fused_.tanh2_b_.data()+i*N );
+      }
+    }
+
+    fused_.sim_->reallocate();
+    fused_.sim_->compressReadout();
+    fused_valid_ = true;
+  }
+
   /*!
    * Simulation: the overal output is the average of all
    * individual network outputs.
    * For ESNs with feedback connections the overal output will be fed back to
    * the individual networks.
    *
+   * The networks are simulated in parallel with OpenMP. With feedback
+   * all threads simulate one step of their networks, wait at a barrier
+   * and then calculate the average output, which is the feedback for the
+   * next step (the outputs of two steps are kept, so that no second
+   * barrier is needed). Without feedback each network simulates the
+   * whole input independently and the outputs are averaged at the end.
+   * If the networks are fused, the fused network is simulated instead
+   * (\sa fuse).
+   *
    * @param in matrix of input values (inputs x timesteps)
    * @param out matrix for output values (outputs x timesteps)
    */
@@ -146,31 +292,106 @@ class ArrayESN
       throw AUExcept("ArrayESN: wrong output row size!");
 
     int steps = in.numCols();
-    typename ESN<T>::DEMatrix sim_in(esns_[0].getInputs() ,1),
-                              sim_out(esns_[0].getOutputs() ,1);
+    int inputs = esns_[0].getInputs();
+    int outputs = esns_[0].getOutputs();
+    if( steps == 0 )
+      return;
+
+    if( fused_valid_ )
+    {
+      // stacked states and last output of the networks
+      int N = esns_[0].neurons_;
+      T *x = fused_.x_.data();
+      for(int i=0; i<array_size_; ++i)
+        std::copy( esns_[i].x_.data(), esns_[i].x_.data()+N, x+i*N );
+      fused_.sim_->last_out_ = esns_[0].sim_->last_out_;
+
+      fused_.simulate(in, out);
 
-    // do single step simulation with all networks
-    for(int n=1; n<=steps; ++n)
+      for(int i=0; i<array_size_; ++i)
+      {
+        std::copy( x+i*N, x+(i+1)*N, esns_[i].x_.data() );
+        esns_[i].sim_->last_out_ = fused_.sim_->last_out_;
+      }
+      return;
+    }
+
+    if( !hasFeedback() )
     {
-      sim_in(_,1) = in(_,n);
-      // clear output vektor
-      for(int i=1; i<=esns_[0].getOutputs(); ++i)
-        out(i,n) = 0.;
+      // simulate all networks independently
+      std::vector< typename ESN<T>::DEMatrix > sim_out(array_size_);
 
-      // simulate all networks
+      #pragma omp parallel for schedule(dynamic) if(array_size_ > 1)
       for(int i=0; i<array_size_; ++i)
       {
-        esns_[i].simulate(sim_in, sim_out);
-        out(_,n) = out(_,n) + sim_out(_,1);
+        set_denormal_flags();
+        sim_out[i].resize(outputs, steps);
+        esns_[i].simulate(in, sim_out[i]);
       }
 
       // calculate average output
-      out(_,n) = out(_,n) / array_size_;
+      T *o = out.data();
+      std::fill_n( o, outputs*steps, 0 );
+      for(int i=0; i<array_size_; ++i)
+      {
+        const T *s = sim_out[i].data();
+        for(int j=0; j<outputs*steps; ++j)
+          o[j] += s[j];
+      }
+      for(int j=0; j<outputs*steps; ++j)
+        o[j] /= array_size_;
 
-      // feed back average output to all networks
+      // last overal output, like in the simulation with feedback
+      typename ESN<T>::DEVector last(outputs);
+      last = out(_,steps);
       for(int i=0; i<array_size_; ++i)
-        esns_[i].setLastOutput( out(_,n) );
+        esns_[i].setLastOutput(last);
+      return;
     }
+
+    // outputs of all networks for even and odd steps
+    std::vector< typename ESN<T>::DEMatrix > sim_out(2*array_size_);
+    for(int i=0; i<2*array_size_; ++i)
+      sim_out[i].resize(outputs, 1);
+
+    #pragma omp parallel if(array_size_ > 1)
+    {
+      set_denormal_flags();
+      typename ESN<T>::DEMatrix sim_in(inputs, 1);
+      typename ESN<T>::DEVector avg(outputs);
+
+      // do single step simulation with all networks
+      for(int n=1; n<=steps; ++n)
+      {
+        sim_in(_,1) = in(_,n);
+        int b = (n % 2) * array_size_;
+
+        #pragma omp for schedule(static)
+        for(int i=0; i<array_size_; ++i)
+        {
+          // feed back average output of the last step
+          if( n > 1 )
+            esns_[i].setLastOutput(avg);
+          esns_[i].simulate(sim_in, sim_out[b+i]);
+        }
+        // implicit barrier
+
+        // calculate average output (the same in each thread)
+        std::fill_n( avg.data(), outputs, 0 );
+        for(int i=0; i<array_size_; ++i)
+          avg += sim_out[b+i](_,1);
+        avg *= T(1) / array_size_;
+
+        #pragma omp master
+        out(_,n) = avg;
+      }
+    }
+
+    // feed back average output to all networks
+    typename ESN<T>::DEVector last(outputs);
+    last = out(_,steps);
+    for(int i=0; i<array_size_; ++i)
+      esns_[i].setLastOutput(last);
   }
 
   /*!
@@ -209,7 +430,7 @@ class ArrayESN
   }
 
   /*!
-   * Teacher-Forcing all networks independently
+   * Teacher-Forcing all networks independently and in parallel
    *
    * @param in matrix of input values (inputs x timesteps)
    * @param out matrix for output values (outputs x timesteps)
@@ -217,8 +438,18 @@ class ArrayESN
   void teacherForce(const typename ESN<T>::DEMatrix &in, typename ESN<T>::DEMatrix &out)
     throw(AUExcept)
   {
+    std::string error;
+
+    #pragma omp parallel for schedule(dynamic) if(array_size_ > 1)
     for(int i=0; i<array_size_; ++i)
-      esns_[i].teacherForce(in,out);
+    {
+      set_denormal_flags();
+      try { esns_[i].teacherForce(in,out); }
+      catch(AUExcept &e) { setError(error, e); }
+    }
+
+    if( !error.empty() )
+      throw AUExcept(error);
   }
 
  /*!
@@ -317,15 +548,56 @@ class ArrayESN
   {
     for(int i=0; i<array_size_; ++i)
       esns_[i].setNoise(noise);
+    fused_.setNoise(noise);
+  }
+
+  /*!
+   * set the seeds of the random numbers of all networks,
+   * network i gets the seed RandomStream::derive(seed,i)
+   */
+  void setSeed(unsigned long long seed)
+  {
+    for(int i=0; i<array_size_; ++i)
+      esns_[i].setSeed( RandomStream::derive(seed, i) );
   }
 
  protected:
 
+  /// stores the first error of a parallel loop, which is thrown afterwards
+  void setError(std::string &error, AUExcept &e)
+  {
+    #pragma omp critical (arrayesn_error)
+    {
+      if( error.empty() )
+        error = e.what();
+    }
+  }
+
+  /// @return true if one of the networks has feedback weights
+  bool hasFeedback()
+  {
+    for(int i=0; i<array_size_; ++i)
+    {
+      const typename ESN<T>::DEMatrix &Wback = esns_[i].getWback();
+      const T *data = Wback.data();
+      int size = Wback.numRows()*Wback.numCols();
+      for(int j=0; j<size; ++j)
+        if( data[j] != 0 )
+          return true;
+    }
+    return false;
+  }
+
   /// nr of parallel ESNs in the array
   int array_size_;
 
   /// the vector with ESNs
   std::vector< ESN<T> > esns_;
+
+  /// all networks fused into one network with a block diagonal reservoir
+  ESN<T> fused_;
+  /// true if fused_ is up to date and used for simulation
+  bool fused_valid_;
 };
 
 } // end of namespace aureservoir
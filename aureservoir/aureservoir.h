@@ -22,6 +22,8 @@
 
 #include "esn.h"
 #include "arrayesn.h"
+#include "statefactorization.h"
+#include "search.h"
 
 #include "utilities.h"
 #include "auexcept.h"
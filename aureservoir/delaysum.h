@@ -23,12 +23,15 @@
 #include "utilities.h"
 #include <complex>
 #include <math.h>
+#include <vector>
 #include <fftw3.h>
 
 namespace aureservoir
 {
 
 //! @name FFT routines using FFTW
+/// \note FFTW plans are cached in class FFTPlans, so only the first call
+///       with a new fftsize has to create a plan
 //@{
 
 /*!
@@ -49,21 +52,132 @@ void rfft(const DEVector<double>::Type &x,
 void rfft(const DEVector<float>::Type &x,
           CDEVector<float>::Type &X, int fftsize);
 
+/*!
+ * calculates real ffts with zero padding of some columns of a matrix
+ * in double precision, all columns are transformed with one batched plan
+ * @param M real input matrix
+ * @param first index of the first column
+ * @param howmany nr of columns to transform
+ * @param X complex FFT output vector, will be resized to
+ *          howmany*(fftsize/2+1), the spectrum of column first+k
+ *          starts at index k*(fftsize/2+1)+1
+ * @param fftsize fftsize, columns will be zero-padded to this size
+ * @param firstrow only rows firstrow .. M.numRows() are transformed
+ */
+void rfft(const DEMatrix<double>::Type &M, int first, int howmany,
+          CDEVector<double>::Type &X, int fftsize, int firstrow=1);
+
+/*!
+ * calculates real ffts with zero padding of some columns of a matrix
+ * in single precision, all columns are transformed with one batched plan
+ * @param M real input matrix
+ * @param first index of the first column
+ * @param howmany nr of columns to transform
+ * @param X complex FFT output vector, will be resized to
+ *          howmany*(fftsize/2+1), the spectrum of column first+k
+ *          starts at index k*(fftsize/2+1)+1
+ * @param fftsize fftsize, columns will be zero-padded to this size
+ * @param firstrow only rows firstrow .. M.numRows() are transformed
+ */
+void rfft(const DEMatrix<float>::Type &M, int first, int howmany,
+          CDEVector<float>::Type &X, int fftsize, int firstrow=1);
+
 /*!
  * calculates inverse real fft in double precision
- * @param X complex frequency domain input vector
+ * @param X complex frequency domain input vector, will be overwritten
  * @param x real IFFT output vector, will be resized to correct size
  */
 void irfft(CDEVector<double>::Type &X, DEVector<double>::Type &x);
 
 /*!
  * calculates inverse real fft in single precision
- * @param X complex frequency domain input vector
+ * @param X complex frequency domain input vector, will be overwritten
  * @param x real IFFT output vector, will be resized to correct size
  */
 void irfft(CDEVector<float>::Type &X, DEVector<float>::Type &x);
 
 //@}
+//! @name FFTW planner settings and wisdom
+//@{
+
+/*!
+ * sets the FFTW planner flags for all new plans, default is FFTW_ESTIMATE.
+ * All cached plans are destroyed, so that e.g. FFTW_MEASURE plans
+ * are used afterwards.
+ * @param flags FFTW planner flags (FFTW_ESTIMATE, FFTW_MEASURE, ...)
+ */
+void setFFTPlannerFlags(unsigned flags);
+
+/*!
+ * imports FFTW wisdom (single and double precision) from a file,
+ * so that expensive plans (FFTW_MEASURE) don't have to be recalculated
+ * @param filename file written by exportFFTWisdom
+ * @return true if the wisdom could be imported
+ */
+bool importFFTWisdom(const char *filename);
+
+/*!
+ * exports the FFTW wisdom of all plans created so far
+ * (single and double precision) to a file
+ * @param filename file for the wisdom
+ * @return true if the file could be written
+ */
+bool exportFFTWisdom(const char *filename);
+
+//@}
+
+/// key of a cached FFTW plan
+struct FFTPlanKey
+{
+  int kind;     ///< in-place real to complex or complex to real
+  int fftsize;  ///< size of one transform
+  int howmany;  ///< nr of batched transforms
+
+  bool operator==(const FFTPlanKey &k) const
+  {
+    return kind == k.kind && fftsize == k.fftsize && howmany == k.howmany;
+  }
+};
+
+/*!
+ * \class FFTPlans
+ * \brief cache of FFTW plans
+ *
+ * Plans are created only once for each fftsize, number of batched
+ * transforms and direction and then executed with FFTW's new-array
+ * interface. All plans are created with FFTW_UNALIGNED and work in-place:
+ * the real signal of length fftsize is stored zero-padded in the memory
+ * of its own complex spectrum of length fftsize/2+1.
+ * Plan creation is serialized because the FFTW planner is not thread safe.
+ * New plans are prepended to a list whose nodes are never changed, so
+ * cached plans are found and executed in parallel without any lock.
+ * Plans removed by clear() are only destroyed at exit, because other
+ * threads might still execute them.
+ * \note only implemented for float and double
+ */
+template <typename T>
+class FFTPlans
+{
+ public:
+  /*!
+   * in-place real to complex transforms
+   * @param X howmany consecutive arrays of length fftsize/2+1, each
+   *          one holds a real input signal of length fftsize
+   */
+  static void r2c(std::complex<T> *X, int fftsize, int howmany=1)
+    throw(AUExcept);
+
+  /*!
+   * in-place complex to real transform (not normalized)
+   * @param X complex spectrum of length fftsize/2+1, will be overwritten
+   *          with the real signal of length fftsize
+   */
+  static void c2r(std::complex<T> *X, int fftsize)
+    throw(AUExcept);
+
+  /// removes all cached plans, so that new plans are created
+  static void clear();
+};
 
 /*!
  * \class CalcDelay
@@ -87,6 +201,54 @@ class CalcDelay
   static int gcc(const typename CDEVector<T>::Type &X,
                  const typename CDEVector<T>::Type &Y,
                  int maxdelay=1000, int filter=0);
+
+  /*!
+   * calculates delay between x and y using the
+   * generalized cross calculation (GCC)
+   * @param X complex input vector1 in frequency domain
+   * @param Y complex input vector2 in frequency domain
+   * @param length length of both frequency domain vectors
+   * @param work scratch vector, will be resized to length, it can be
+   *             reused for all calls with the same length
+   * @param maxdelay maximum delay size for calculation
+   * @param filter pre-whitening filter type:
+   *               0 = standard cross correlation
+   *               1 = phase transform (PHAT)
+   * @return delay between the two signals
+   */
+  static int gcc(const std::complex<T> *X, const std::complex<T> *Y,
+                 int length, typename CDEVector<T>::Type &work,
+                 int maxdelay=1000, int filter=0);
+
+  /*!
+   * calculates delay between x and y with a cross correlation
+   * in time domain, evaluated only for the lags 0 .. maxdelay-1.
+   * The result is the same as gcc with filter = 0 on the spectra of
+   * x and y zero-padded to fftsize (this is a circular cross correlation).
+   * @param x input vector1 in time domain
+   * @param xlength length of x (<= fftsize)
+   * @param y input vector2 in time domain
+   * @param ylength length of y (<= fftsize)
+   * @param fftsize fftsize of the corresponding frequency domain method
+   * @param maxdelay maximum delay size for calculation
+   * @return delay between the two signals
+   */
+  static int crosscorr(const T *x, int xlength, const T *y, int ylength,
+                       int fftsize, int maxdelay=1000);
+
+  /*!
+   * cost model to choose between the delay calculation methods:
+   * the time domain cross correlation needs about maxdelay*length
+   * multiply-adds per signal pair, gcc needs an inverse FFT
+   * (and the transforms of the signals).
+   * @param length length of the signals
+   * @param fftsize fftsize for gcc
+   * @param maxdelay maximum delay size for calculation
+   * @param filter pre-whitening filter type (see gcc), only the standard
+   *               cross correlation (0) can be calculated in time domain
+   * @return true if crosscorr should be used instead of gcc
+   */
+  static bool useCrossCorr(int length, int fftsize, int maxdelay, int filter);
 };
 
 /*!
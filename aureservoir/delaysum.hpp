@@ -18,73 +18,447 @@
  ***************************************************************************/
 
 #include <assert.h>
+#include <fstream>
+#include <sstream>
 
 namespace aureservoir
 {
 
+//! @name FFTW plan cache
+//@{
+
+/// planner flags for new FFTW plans
+inline unsigned &fftPlannerFlags()
+{
+  static unsigned flags = FFTW_ESTIMATE;
+  return flags;
+}
+
+template <>
+class FFTPlans<double>
+{
+ public:
+  static void r2c(std::complex<double> *X, int fftsize, int howmany=1)
+    throw(AUExcept)
+  {
+    fftw_execute_dft_r2c( get(R2C, fftsize, howmany),
+                          reinterpret_cast<double*>(X),
+                          reinterpret_cast<fftw_complex*>(X) );
+  }
+
+  static void c2r(std::complex<double> *X, int fftsize)
+    throw(AUExcept)
+  {
+    fftw_execute_dft_c2r( get(C2R, fftsize, 1),
+                          reinterpret_cast<fftw_complex*>(X),
+                          reinterpret_cast<double*>(X) );
+  }
+
+  static void clear()
+  {
+    #pragma omp critical (fftw_planner)
+    {
+      // the plans might be executed by other threads right now,
+      // so they are only unlinked and destroyed at exit
+      for(Node *node=cache().head; node; node=node->next)
+        cache().retired.push_back(node);
+      cache().head = 0;
+      #pragma omp flush
+    }
+  }
+
+ private:
+  enum { R2C, C2R };
+
+  /// cached plan, never changed after it was added to the list
+  struct Node
+  {
+    FFTPlanKey key;
+    fftw_plan plan;
+    Node *next;
+  };
+
+  /// list of cached plans and plans removed by clear()
+  struct Cache
+  {
+    Node *head;
+    std::vector<Node*> retired;
+
+    Cache() : head(0) {}
+    ~Cache()
+    {
+      for(Node *node=head; node; node=node->next)
+        retired.push_back(node);
+      for(unsigned i=0; i<retired.size(); ++i)
+      {
+        fftw_destroy_plan(retired[i]->plan);
+        delete retired[i];
+      }
+    }
+  };
+
+  static Cache &cache()
+  {
+    static Cache plans;
+    return plans;
+  }
+
+  static Node *find(Node *node, const FFTPlanKey &key)
+  {
+    for(; node; node=node->next)
+      if( node->key == key )
+        return node;
+    return 0;
+  }
+
+  static fftw_plan get(int kind, int fftsize, int howmany)
+    throw(AUExcept)
+  {
+    FFTPlanKey key = { kind, fftsize, howmany };
+
+    // new plans are only prepended to the list, so a cached plan can
+    // be found without locking
+    Node *head;
+    #pragma omp flush
+    head = cache().head;
+    Node *node = find(head, key);
+    if( node )
+      return node->plan;
+
+    fftw_plan plan = 0;
+
+    #pragma omp critical (fftw_planner)
+    {
+      // another thread might have created the plan in the meantime
+      node = find(cache().head, key);
+
+      if( node )
+        plan = node->plan;
+      else
+      {
+        // plan with a scratch array, FFTW_MEASURE would overwrite the data
+        int nc = fftsize/2+1;
+        fftw_complex *buf = (fftw_complex*)
+          fftw_malloc( sizeof(fftw_complex)*nc*howmany );
+        unsigned flags = fftPlannerFlags() | FFTW_UNALIGNED;
+
+        if( kind == R2C )
+          plan = fftw_plan_many_dft_r2c(1, &fftsize, howmany,
+                 (double*) buf, 0, 1, 2*nc, buf, 0, 1, nc, flags);
+        else
+          plan = fftw_plan_many_dft_c2r(1, &fftsize, howmany,
+                 buf, 0, 1, nc, (double*) buf, 0, 1, 2*nc, flags);
+
+        fftw_free(buf);
+
+        // e.g. FFTW_WISDOM_ONLY without wisdom for this size
+        if( plan )
+        {
+          node = new Node;
+          node->key = key;
+          node->plan = plan;
+          node->next = cache().head;
+          #pragma omp flush
+          cache().head = node;
+          #pragma omp flush
+        }
+      }
+    }
+
+    if( !plan )
+      throw AUExcept("FFTPlans: FFTW could not create a plan!");
+
+    return plan;
+  }
+};
+
+template <>
+class FFTPlans<float>
+{
+ public:
+  static void r2c(std::complex<float> *X, int fftsize, int howmany=1)
+    throw(AUExcept)
+  {
+    fftwf_execute_dft_r2c( get(R2C, fftsize, howmany),
+                          reinterpret_cast<float*>(X),
+                          reinterpret_cast<fftwf_complex*>(X) );
+  }
+
+  static void c2r(std::complex<float> *X, int fftsize)
+    throw(AUExcept)
+  {
+    fftwf_execute_dft_c2r( get(C2R, fftsize, 1),
+                          reinterpret_cast<fftwf_complex*>(X),
+                          reinterpret_cast<float*>(X) );
+  }
+
+  static void clear()
+  {
+    #pragma omp critical (fftw_planner)
+    {
+      // the plans might be executed by other threads right now,
+      // so they are only unlinked and destroyed at exit
+      for(Node *node=cache().head; node; node=node->next)
+        cache().retired.push_back(node);
+      cache().head = 0;
+      #pragma omp flush
+    }
+  }
+
+ private:
+  enum { R2C, C2R };
+
+  /// cached plan, never changed after it was added to the list
+  struct Node
+  {
+    FFTPlanKey key;
+    fftwf_plan plan;
+    Node *next;
+  };
+
+  /// list of cached plans and plans removed by clear()
+  struct Cache
+  {
+    Node *head;
+    std::vector<Node*> retired;
+
+    Cache() : head(0) {}
+    ~Cache()
+    {
+      for(Node *node=head; node; node=node->next)
+        retired.push_back(node);
+      for(unsigned i=0; i<retired.size(); ++i)
+      {
+        fftwf_destroy_plan(retired[i]->plan);
+        delete retired[i];
+      }
+    }
+  };
+
+  static Cache &cache()
+  {
+    static Cache plans;
+    return plans;
+  }
+
+  static Node *find(Node *node, const FFTPlanKey &key)
+  {
+    for(; node; node=node->next)
+      if( node->key == key )
+        return node;
+    return 0;
+  }
+
+  static fftwf_plan get(int kind, int fftsize, int howmany)
+    throw(AUExcept)
+  {
+    FFTPlanKey key = { kind, fftsize, howmany };
+
+    // new plans are only prepended to the list, so a cached plan can
+    // be found without locking
+    Node *head;
+    #pragma omp flush
+    head = cache().head;
+    Node *node = find(head, key);
+    if( node )
+      return node->plan;
+
+    fftwf_plan plan = 0;
+
+    #pragma omp critical (fftw_planner)
+    {
+      // another thread might have created the plan in the meantime
+      node = find(cache().head, key);
+
+      if( node )
+        plan = node->plan;
+      else
+      {
+        // plan with a scratch array, FFTW_MEASURE would overwrite the data
+        int nc = fftsize/2+1;
+        fftwf_complex *buf = (fftwf_complex*)
+          fftwf_malloc( sizeof(fftwf_complex)*nc*howmany );
+        unsigned flags = fftPlannerFlags() | FFTW_UNALIGNED;
+
+        if( kind == R2C )
+          plan = fftwf_plan_many_dft_r2c(1, &fftsize, howmany,
+                 (float*) buf, 0, 1, 2*nc, buf, 0, 1, nc, flags);
+        else
+          plan = fftwf_plan_many_dft_c2r(1, &fftsize, howmany,
+                 buf, 0, 1, nc, (float*) buf, 0, 1, 2*nc, flags);
+
+        fftwf_free(buf);
+
+        // e.g. FFTW_WISDOM_ONLY without wisdom for this size
+        if( plan )
+        {
+          node = new Node;
+          node->key = key;
+          node->plan = plan;
+          node->next = cache().head;
+          #pragma omp flush
+          cache().head = node;
+          #pragma omp flush
+        }
+      }
+    }
+
+    if( !plan )
+      throw AUExcept("FFTPlans: FFTW could not create a plan!");
+
+    return plan;
+  }
+};
+
+inline void setFFTPlannerFlags(unsigned flags)
+{
+  #pragma omp critical (fftw_planner)
+  fftPlannerFlags() = flags;
+
+  FFTPlans<double>::clear();
+  FFTPlans<float>::clear();
+}
+
+inline bool importFFTWisdom(const char *filename)
+{
+  std::ifstream file(filename);
+  if( !file )
+    return false;
+
+  std::stringstream buf;
+  buf << file.rdbuf();
+  std::string wisdom = buf.str();
+
+  // double precision wisdom is followed by single precision wisdom
+  std::string::size_type pos = wisdom.find("fftwf_wisdom");
+  pos = ( pos == std::string::npos ) ? wisdom.length()
+                                     : wisdom.rfind('(', pos);
+  std::string dwisdom = wisdom.substr(0,pos), swisdom = wisdom.substr(pos);
+
+  bool success = true;
+  #pragma omp critical (fftw_planner)
+  {
+    if( dwisdom.find('(') != std::string::npos )
+      success = fftw_import_wisdom_from_string( dwisdom.c_str() ) && success;
+    if( !swisdom.empty() )
+      success = fftwf_import_wisdom_from_string( swisdom.c_str() ) && success;
+  }
+
+  return success;
+}
+
+inline bool exportFFTWisdom(const char *filename)
+{
+  char *dwisdom, *swisdom;
+
+  #pragma omp critical (fftw_planner)
+  {
+    dwisdom = fftw_export_wisdom_to_string();
+    swisdom = fftwf_export_wisdom_to_string();
+  }
+
+  std::ofstream file(filename);
+  if( file )
+    file << dwisdom << swisdom;
+
+  fftw_free(dwisdom);
+  fftwf_free(swisdom);
+
+  return file.good();
+}
+
+//@}
 //! @name FFT routines
 //@{
 
 inline void rfft(const DEVector<double>::Type &x,
           CDEVector<double>::Type &X, int fftsize)
 {
-  // zero pad to fftsize
-  DEVector<double>::Type xpad(fftsize);
-  std::fill_n(xpad.data(), fftsize, 0);
-  xpad(_(1,x.length())) = x;
-
-  // calc FFTs
-  fftw_plan p1;
+  // zero pad to fftsize in the memory of the spectrum
   X.resize(fftsize/2+1);
-  p1 = fftw_plan_dft_r2c_1d(fftsize, &xpad(1),
-                            reinterpret_cast<fftw_complex*>( &X(1) ),
-                            FFTW_ESTIMATE);
-  fftw_execute(p1);
-  fftw_destroy_plan(p1);
+  double *xpad = reinterpret_cast<double*>( X.data() );
+  std::copy( x.data(), x.data()+x.length(), xpad );
+  std::fill( xpad+x.length(), xpad+2*X.length(), 0 );
+
+  // calc FFT in-place
+  FFTPlans<double>::r2c( X.data(), fftsize );
 }
 
 inline void rfft(const DEVector<float>::Type &x,
           CDEVector<float>::Type &X, int fftsize)
 {
-  // zero pad to fftsize
-  DEVector<float>::Type xpad(fftsize);
-  std::fill_n(xpad.data(), fftsize, 0);
-  xpad(_(1,x.length())) = x;
-
-  // calc FFTs
-  fftwf_plan p1;
+  // zero pad to fftsize in the memory of the spectrum
   X.resize(fftsize/2+1);
-  p1 = fftwf_plan_dft_r2c_1d(fftsize, &xpad(1),
-                            reinterpret_cast<fftwf_complex*>( &X(1) ),
-                            FFTW_ESTIMATE);
-  fftwf_execute(p1);
-  fftwf_destroy_plan(p1);
+  float *xpad = reinterpret_cast<float*>( X.data() );
+  std::copy( x.data(), x.data()+x.length(), xpad );
+  std::fill( xpad+x.length(), xpad+2*X.length(), 0 );
+
+  // calc FFT in-place
+  FFTPlans<float>::r2c( X.data(), fftsize );
+}
+
+inline void rfft(const DEMatrix<double>::Type &M, int first, int howmany,
+          CDEVector<double>::Type &X, int fftsize, int firstrow)
+{
+  int nc = fftsize/2+1;
+  int rows = M.numRows()-firstrow+1;
+
+  // zero pad all columns to fftsize in the memory of their spectra
+  X.resize(nc*howmany);
+  double *xpad = reinterpret_cast<double*>( X.data() );
+  for(int k=0; k<howmany; ++k)
+  {
+    const double *col = &M(firstrow,first+k);
+    std::copy( col, col+rows, xpad+k*2*nc );
+    std::fill( xpad+k*2*nc+rows, xpad+(k+1)*2*nc, 0 );
+  }
+
+  // calc all FFTs in-place with one plan
+  FFTPlans<double>::r2c( X.data(), fftsize, howmany );
+}
+
+inline void rfft(const DEMatrix<float>::Type &M, int first, int howmany,
+          CDEVector<float>::Type &X, int fftsize, int firstrow)
+{
+  int nc = fftsize/2+1;
+  int rows = M.numRows()-firstrow+1;
+
+  // zero pad all columns to fftsize in the memory of their spectra
+  X.resize(nc*howmany);
+  float *xpad = reinterpret_cast<float*>( X.data() );
+  for(int k=0; k<howmany; ++k)
+  {
+    const float *col = &M(firstrow,first+k);
+    std::copy( col, col+rows, xpad+k*2*nc );
+    std::fill( xpad+k*2*nc+rows, xpad+(k+1)*2*nc, 0 );
+  }
+
+  // calc all FFTs in-place with one plan
+  FFTPlans<float>::r2c( X.data(), fftsize, howmany );
 }
 
 inline void irfft(CDEVector<double>::Type &X, DEVector<double>::Type &x)
 {
   int fftsize = 2*(X.length()-1);
 
-  // calc IFFT
+  // calc IFFT in-place
+  FFTPlans<double>::c2r( X.data(), fftsize );
+
   x.resize(fftsize);
-  fftw_plan p1 = fftw_plan_dft_c2r_1d(fftsize, 
-                          reinterpret_cast<fftw_complex*>( &X(1) ),
-                          &x(1), FFTW_ESTIMATE);
-  fftw_execute(p1);
-  fftw_destroy_plan(p1);
+  double *xout = reinterpret_cast<double*>( X.data() );
+  std::copy( xout, xout+fftsize, x.data() );
 }
 
 inline void irfft(CDEVector<float>::Type &X, DEVector<float>::Type &x)
 {
   int fftsize = 2*(X.length()-1);
 
-  // calc IFFT
+  // calc IFFT in-place
+  FFTPlans<float>::c2r( X.data(), fftsize );
+
   x.resize(fftsize);
-  fftwf_plan p1 = fftwf_plan_dft_c2r_1d(fftsize, 
-                          reinterpret_cast<fftwf_complex*>( &X(1) ),
-                          &x(1), FFTW_ESTIMATE);
-  fftwf_execute(p1);
-  fftwf_destroy_plan(p1);
+  float *xout = reinterpret_cast<float*>( X.data() );
+  std::copy( xout, xout+fftsize, x.data() );
 }
 
 //@}
@@ -97,40 +471,103 @@ int CalcDelay<T>::gcc(const typename CDEVector<T>::Type &X,
 {
   assert( X.length() == Y.length() );
 
-  typename CDEVector<T>::Type tmp( X.length() );
+  typename CDEVector<T>::Type work;
+  return gcc( X.data(), Y.data(), X.length(), work, maxdelay, filter );
+}
+
+template <typename T>
+int CalcDelay<T>::gcc(const std::complex<T> *X, const std::complex<T> *Y,
+                      int length, typename CDEVector<T>::Type &work,
+                      int maxdelay, int filter)
+{
+  if( work.length() != length )
+    work.resize( length );
+  typename CDEVector<T>::Type &tmp = work;
 
-  int fftsize = 2*(X.length()-1);
+  int fftsize = 2*(length-1);
 
   // multiplication in frequency domain
-  for(int i=1; i<=X.length(); ++i)
-    tmp(i) = conj( X(i) ) * Y(i);
+  for(int i=1; i<=length; ++i)
+    tmp(i) = conj( X[i-1] ) * Y[i-1];
 
   // calc phase transform if needed
   if( filter == 1 )
   {
-    for(int i=1; i<=X.length(); ++i)
+    for(int i=1; i<=length; ++i)
       if( std::abs(tmp(i)) != 0) tmp(i) = tmp(i) / std::abs(tmp(i));
   }
 
-  // calc crosscorr with IFFT
-  typename DEVector<T>::Type crosscorr;
-  irfft(tmp,crosscorr);
+  // calc crosscorr with in-place IFFT
+  FFTPlans<T>::c2r( tmp.data(), fftsize );
+  const T *crosscorr = reinterpret_cast<const T*>( tmp.data() );
 
   // calc delay
-  for(int i=1; i<=fftsize; ++i)
-    crosscorr(i) = std::abs( crosscorr(i) );
   int mdelay = (fftsize < maxdelay) ? fftsize : maxdelay;
+  int delay = 0;
+  T maxcorr = -1;
+  for(int i=0; i<mdelay; ++i)
+  {
+    if( std::abs( crosscorr[i] ) > maxcorr )
+    {
+      maxcorr = std::abs( crosscorr[i] );
+      delay = i;
+    }
+  }
 
-  int delay = (int) ( std::max_element( crosscorr.data(),
-                                        crosscorr.data()+mdelay )
-                      - crosscorr.data() );
+  return delay;
+}
 
-//   cout << crosscorr << "fftsize:" << fftsize << ",mdelay:" << mdelay 
-//        << "maxdelay;" << maxdelay << endl;
+template <typename T>
+int CalcDelay<T>::crosscorr(const T *x, int xlength, const T *y, int ylength,
+                            int fftsize, int maxdelay)
+{
+  assert( xlength <= fftsize && ylength <= fftsize );
+
+  int mdelay = (fftsize < maxdelay) ? fftsize : maxdelay;
+  int delay = 0;
+  T maxcorr = -1;
+
+  for(int tau=0; tau<mdelay; ++tau)
+  {
+    T corr = 0.;
+
+    // corr(tau) = sum_n x(n) * y( (n+tau) mod fftsize )
+    int nmax = std::min( xlength, ylength-tau );
+    for(int n=0; n<nmax; ++n)
+      corr += x[n] * y[n+tau];
+
+    // wrapped part of the circular cross correlation
+    nmax = std::min( xlength, ylength+fftsize-tau );
+    for(int n=fftsize-tau; n<nmax; ++n)
+      corr += x[n] * y[n+tau-fftsize];
+
+    if( std::abs(corr) > maxcorr )
+    {
+      maxcorr = std::abs(corr);
+      delay = tau;
+    }
+  }
 
   return delay;
 }
 
+template <typename T>
+bool CalcDelay<T>::useCrossCorr(int length, int fftsize, int maxdelay,
+                                int filter)
+{
+  if( filter != 0 )
+    return false;
+
+  int mdelay = (fftsize < maxdelay) ? fftsize : maxdelay;
+
+  // flops of a real inverse FFT (about 2.5*N*log2(N)) and the
+  // complex multiplication of the spectra
+  double fftcost = 2.5 * fftsize * log(fftsize)/log(2.) + 6. * (fftsize/2+1);
+  double timecost = 2. * mdelay * length;
+
+  return timecost < fftcost;
+}
+
 //@}
 //! @name class DelayLine
 //@{
@@ -77,6 +77,16 @@ at aureservoir::ESN. <br>
 All different activation functions, simulation, training and
 adaptation algorithms, etc. can be changed at runtime.
 
+Implemented initialization algorithms (see init.h):
+<ul>
+  <li> standard initialization of a random sparse reservoir as in
+       Jaeger's initial paper (see aureservoir::InitStd) </li>
+  <li> simple cycle, cycle with jumps and delay line reservoirs with
+       fast O(neurons) simulation (see aureservoir::InitCycle) </li>
+  <li> dense orthogonal circulant reservoir with FFT based simulation
+       (see aureservoir::InitCirculant) </li>
+</ul>
+
 Implemented simulation algorithms (see simulate.h):
 <ul>
   <li> standard simulation algorithm as in Jaeger's initial paper
@@ -103,8 +113,16 @@ Implemented training algorithms (see train.h):
        (see aureservoir::TrainLS) </li>
   <li> algorithm with Ridge Regression / Tikhonov Regularization
        (see aureservoir::TrainRidgeReg) </li>
+  <li> Ridge Regression with K-fold cross-validation of the
+       regularization factor (see aureservoir::TrainRidgeRegCV) </li>
   <li> offline algorithm for delay&sum readout with pseudo inverse
        (see aureservoir::TrainDSPI) </li>
+  <li> online training with recursive least squares, also for FORCE
+       learning (see aureservoir::TrainRLS) </li>
+  <li> low-latency online training with normalized least mean squares
+       inside the simulation loop (see aureservoir::TrainNLMS) </li>
+  <li> sparse readout with L1 regularization (LASSO) by coordinate
+       descent (see aureservoir::TrainLasso) </li>
 </ul>
 
 Implemented reservoir adaptation algorithms:
@@ -33,6 +33,10 @@
 namespace aureservoir
 {
 
+template <typename T> class StateFactorization;
+template <typename T> class ArrayESN;
+template <typename T> class ParamSearch;
+
 /*!
  * \class ESN
  *
@@ -72,10 +76,23 @@ class ESN
   typedef typename DEMatrix<T>::Type DEMatrix;
   typedef typename DEVector<T>::Type DEVector;
 
+  /*!
+   * callback for diagnostics of the EM delay learning \sa class TrainDSPI
+   * @param output index of the output (starting with 1)
+   * @param iteration current EM iteration (starting with 1)
+   * @param deldiff sum of absolute delay changes in this iteration
+   * @param wdiff sum of absolute weight changes in this iteration
+   * @param wmean average weight after this iteration
+   * @param data user data given in setEMCallback
+   */
+  typedef void (*EMCallback)(int output, int iteration, int deldiff,
+                             T wdiff, T wmean, void *data);
+
   /// Constructor
   ESN();
 
-  /// Copy Constructor
+  /// Copy Constructor, the copy continues the same random numbers
+  /// (use setSeed for independent noise)
   ESN(const ESN<T> &src);
 
   /// assignement operator
@@ -93,7 +110,7 @@ class ESN
    */
   void init()
     throw(AUExcept)
-  { init_->init(); }
+  { init_->init(); sim_->clearReadout(); train_->resetOnline(); }
 
   /*!
    * Reservoir Adaptation Algorithm Interface
@@ -102,12 +119,23 @@ class ESN
    * \sa "Adapting reservoirs to get Gaussian distributions" by David Verstraeten,
    *      Benjamin Schrauwen and Dirk Stroobandt
    *
+   * The adaptation is done after the simulation of each time step with
+   * the final state before the nonlinearity (for SIM_STD directly within
+   * the activation function, for the other algorithms after leakage or
+   * filtering of the state).
+   * With sequences > 1 the input is split into this number of independent
+   * sequences of equal length, which are simulated in parallel with own
+   * copies of the network (each starting from the current state), and
+   * the updates of all sequences are averaged in each time step.
+   * Then the internal state of the network itself is not changed.
+   *
    * @param in matrix of input values (inputs x timesteps),
    *           the reservoir will be adapted by this number of timesteps.
+   * @param sequences nr of independent sequences in the input
    * @return mean value of differences between all parameters before and after
    *         adaptation, can be used to see if learning still makes an progress.
    */
-  double adapt(const DEMatrix &in)
+  double adapt(const DEMatrix &in, int sequences=1)
     throw(AUExcept);
 
   /*!
@@ -133,6 +161,22 @@ class ESN
   inline void simulate(const DEMatrix &in, DEMatrix &out)
   { sim_->simulate(in, out); }
 
+  /*!
+   * Online Training Interface, only for online training algorithms
+   * (e.g. TRAIN_RLS, TRAIN_NLMS). Simulates the network and adapts the output
+   * weights after each timestep to the desired output.
+   * The network output (before the weight update) is used as feedback,
+   * like in FORCE learning.
+   * \sa class TrainRLS
+   * \sa class TrainNLMS
+   *
+   * @param in matrix of input values (inputs x timesteps)
+   * @param target matrix of desired output values (outputs x timesteps)
+   * @param out matrix for output values (outputs x timesteps)
+   */
+  void trainOnline(const DEMatrix &in, const DEMatrix &target, DEMatrix &out)
+    throw(AUExcept);
+
   /*!
    * Teacher Forcing a input and target signal without learning output weights.
    * This is useful for ESNs in generator mode to initialize the internal state.
@@ -155,6 +199,48 @@ class ESN
   void collectStates(const DEMatrix &in, DEMatrix &X, int washout=0)
     throw(AUExcept);
 
+  /*!
+   * Ridge regression training for a whole vector of regularization
+   * factors. The network is teacher forced only once and all readouts
+   * are calculated from one eigendecomposition, Wout is not changed.
+   * \sa class TrainRidgeReg
+   *
+   * @param in matrix of input values (inputs x timesteps)
+   * @param out matrix of desired output values (outputs x timesteps)
+   *            for teacher forcing
+   * @param washout washout time in samples
+   * @param alphas vector of regularization factors (like TIKHONOV_FACTOR)
+   * @param Wouts output weights for all factors, rows (k-1)*outputs+1
+   *              to k*outputs are the weights for alphas(k),
+   *              size = (alphas.length()*outputs x neurons+inputs)
+   */
+  void ridgeRegressionPath(const DEMatrix &in, const DEMatrix &out,
+                           int washout, const DEVector &alphas,
+                           DEMatrix &Wouts) throw(AUExcept);
+
+  /*!
+   * Training with several independent episodes (e.g. recordings),
+   * every episode starts with a reset network state and has its own
+   * washout. The states of all episodes are collected in parallel and
+   * the output weights are calculated with one solve, so this is only
+   * possible with offline training algorithms (TRAIN_PI, TRAIN_LS,
+   * TRAIN_RIDGEREG, TRAIN_RIDGEREG_CV).
+   * The internal state of the network is not changed.
+   * \sa TrainBase::trainEpisodes
+   *
+   * @param ins input matrices of all episodes (inputs x timesteps)
+   * @param outs desired outputs of all episodes (outputs x timesteps)
+   * @param washouts washout of each episode
+   */
+  void trainEpisodes(const std::vector<DEMatrix> &ins,
+                     const std::vector<DEMatrix> &outs,
+                     const std::vector<int> &washouts) throw(AUExcept)
+  {
+    sim_->clearReadout();
+    train_->trainEpisodes(ins, outs, washouts);
+    sim_->compressReadout();
+  }
+
    /*!
    * resets the internal state vector x of the reservoir to zero
    */
@@ -178,10 +264,13 @@ class ESN
    *
    * @param inmtx matrix of input values (inputs x timesteps),
    *              the reservoir will be adapted by this number of timesteps.
+   * @param sequences nr of independent sequences in the input
+   *                  \sa adapt(const DEMatrix &in, int sequences)
    * @return mean value of differences between all parameters before and after
    *         adaptation, can be used to see if learning still makes an progress.
    */
-  double adapt(T *inmtx, int inrows, int incols) throw(AUExcept);
+  double adapt(T *inmtx, int inrows, int incols, int sequences=1)
+    throw(AUExcept);
 
   /*!
    * C-style Training Algorithm Interface
@@ -214,7 +303,8 @@ class ESN
                        T *outmtx, int outrows, int outcols) throw(AUExcept);
 
   /*!
-   * C-style Simulation Algorithm Interface, for single step simulation
+   * C-style Simulation Algorithm Interface, for single step simulation,
+   * no memory is allocated (except in the first call)
    * \sa class SimBase
    * \todo see if we can do this in python without this additional method
    * @param inmtx input vector, size = inputs
@@ -224,6 +314,36 @@ class ESN
   inline void simulateStep(T *invec, int insize, T *outvec, int outsize)
     throw(AUExcept);
 
+  /*!
+   * C-style Online Training Interface
+   * (data will be copied into a FLENS matrix)
+   * \sa class TrainRLS
+   *
+   * @param inmtx input matrix in row major storage (usual C array)
+   *              (inputs x timesteps)
+   * @param targmtx desired output matrix in row major storage
+   *                (outputs x timesteps)
+   * @param outmtx output matrix in row major storage (outputs x timesteps),
+   *               \attention Data must be already allocated!
+   */
+  void trainOnline(T *inmtx, int inrows, int incols,
+                   T *targmtx, int targrows, int targcols,
+                   T *outmtx, int outrows, int outcols) throw(AUExcept);
+
+  /*!
+   * C-style Online Training Interface for single step simulation,
+   * adapts the output weights to the desired output of this step,
+   * no memory is allocated with TRAIN_NLMS (except in the first call)
+   * \sa class TrainRLS
+   * \sa class TrainNLMS
+   * @param invec input vector, size = inputs
+   * @param targvec desired output vector, size = outputs
+   * @param outvec output vector (before the weight update), size = outputs
+   *               \attention Data must be already allocated!
+   */
+  void trainStep(T *invec, int insize, T *targvec, int targsize,
+                 T *outvec, int outsize) throw(AUExcept);
+
   /*!
    * Teacher Forcing a input and target signal without learning output weights.
    * This is useful for ESNs in generator mode to initialize the internal state.
@@ -250,6 +370,42 @@ class ESN
                      T *outmtx, int outrows, int outcols,
                      int washout) throw(AUExcept);
 
+  /*!
+   * C-style ridge regression training for a whole vector of
+   * regularization factors, Wout is not changed.
+   * \sa class TrainRidgeReg
+   *
+   * @param inmtx input matrix in row major storage (usual C array)
+   *              (inputs x timesteps)
+   * @param outmtx output matrix in row major storage (outputs x timesteps)
+   *               for teacher forcing
+   * @param washout washout time in samples
+   * @param alphavec vector of regularization factors
+   * @param wmtx output weights for all factors in row major storage,
+   *             size = (alphasize*outputs x neurons+inputs)
+   *             \attention Data must be already allocated!
+   */
+  void ridgeRegressionPath(T *inmtx, int inrows, int incols,
+                           T *outmtx, int outrows, int outcols,
+                           int washout, T *alphavec, int alphasize,
+                           T *wmtx, int wrows, int wcols) throw(AUExcept);
+
+  /*!
+   * C-style training with several independent episodes
+   * \sa trainEpisodes(const std::vector<DEMatrix> &ins, ...)
+   *
+   * @param inmtx inputs of all episodes one after another in row major
+   *              storage (inputs x sum of all episode lengths)
+   * @param outmtx desired outputs of all episodes one after another in
+   *               row major storage (outputs x sum of all episode lengths)
+   * @param lenvec length (timesteps) of each episode
+   * @param washvec washout of each episode
+   */
+  void trainEpisodes(T *inmtx, int inrows, int incols,
+                     T *outmtx, int outrows, int outcols,
+                     int *lenvec, int lensize, int *washvec, int washsize)
+    throw(AUExcept);
+
   //@}
   //! @name Additional Interface for Bandpass and IIR-Filter Neurons
   /// \todo rethink if this is consistent -> in neue klasse tun ?
@@ -358,7 +514,7 @@ class ESN
   /// @return input weight matrix (neurons x inputs)
   const DEMatrix &getWin() { return Win_; }
   /// @return reservoir weight matrix (neurons x neurons)
-  const SPMatrix &getW() { return W_; }
+  const SPMatrix &getW() { buildW(); return W_; }
   /// @return feedback (output to reservoir) weight matrix (neurons x outputs)
   const DEMatrix &getWback() { return Wback_; }
   /// @return output weight matrix (outputs x neurons+inputs)
@@ -378,6 +534,14 @@ class ESN
    */
   DEMatrix getReservoirDelays() throw(AUExcept)
   { return sim_->getReservoirDelays(); }
+  /**
+   * query the validation errors of a cross-validated training
+   * \sa class TrainRidgeRegCV
+   * @return matrix with the regularization factors in the first column
+   *         and the validation errors of all folds in the other columns,
+   *         size = (CV_TIKHONOV_STEPS x CV_FOLDS+1)
+   */
+  DEMatrix getCVErrors() throw(AUExcept) { return train_->getCVErrors(); }
 
   //@}
   //! @name GET internal data C-style interface
@@ -420,6 +584,15 @@ class ESN
    *        size = (neurons x neurons)
    */
   void getReservoirDelays(T *wmtx, int wrows, int wcols) throw(AUExcept);
+  /**
+   * query the validation errors of a cross-validated training
+   * \sa class TrainRidgeRegCV
+   * and copies the data into a C-style matrix
+   * \attention Memory of the C array must be allocated before!
+   * @param wmtx matrix with regularization factors and validation errors
+   *        size = (CV_TIKHONOV_STEPS x CV_FOLDS+1)
+   */
+  void getCVErrors(T *wmtx, int wrows, int wcols) throw(AUExcept);
 
   //@}
   //! @name SET methods
@@ -446,9 +619,25 @@ class ESN
   /// @param noise with uniform distribution within [-noise|+noise]
   void setNoise(double noise) throw(AUExcept);
 
+  /*!
+   * set the seed of the random numbers of this network (used for
+   * initialization, noise and delays), so that results can be reproduced,
+   * by default each network gets a different seed
+   */
+  void setSeed(unsigned long long seed) { rand_.setSeed(seed); }
+
   /// set initialization parameter
   void setInitParam(InitParameter key, T value=0.);
 
+  /*!
+   * set a callback for diagnostics of the EM delay learning,
+   * it is called after each EM iteration (never concurrently)
+   * @param callback the callback function or 0 for no diagnostics
+   * @param data user data which will be passed to the callback
+   */
+  void setEMCallback(EMCallback callback, void *data=0)
+  { em_callback_ = callback; em_callback_data_ = data; }
+
   /// set reservoir activation function
   void setReservoirAct(ActivationFunction f=ACT_TANH) throw(AUExcept);
   /// set output activation function
@@ -531,6 +720,35 @@ class ESN
   void setLastOutput(T *last, int size) throw(AUExcept);
 
   //@}
+  //! @name Model files
+  //@{
+
+  /*!
+   * saves the network into a binary model file \sa class ModelWriter
+   *
+   * The file contains the sizes, algorithms and activation functions
+   * (with the slope and bias of tanh2 neurons), all initialization
+   * parameters, the reservoir in compressed row storage (or the spectrum
+   * of a circulant reservoir), all dense weights, the current state and
+   * last output and the filter coefficients and delays of the simulation
+   * algorithm.
+   * @param filename name of the model file
+   */
+  void save(const char *filename) throw(AUExcept);
+
+  /*!
+   * loads a network from a binary model file, which is mapped into memory
+   * \sa class ModelReader
+   *
+   * All records are checked first, so the network is only changed if the
+   * file is valid, then each array is copied once from the mapping.
+   * The delay lines of the readout and reservoir start with zeros,
+   * the states of the filters and of online training are reset.
+   * @param filename name of the model file
+   */
+  void load(const char *filename) throw(AUExcept);
+
+  //@}
 
  protected:
 
@@ -551,6 +769,24 @@ class ESN
   /// reservoir weight matrix
   SPMatrix W_;
 
+  /// topology of W_, structured reservoirs are simulated with the
+  /// following parameters instead of W_ (\sa class InitCycle)
+  ReservoirTopology topology_;
+  /// weight of the cycle or delay line connections
+  T cycle_weight_;
+  /// weight of the jump connections
+  T jump_weight_;
+  /// distance between the neurons of a jump
+  int jump_size_;
+  /// eigenvalues (FFT of the first column) of a circulant reservoir,
+  /// divided by neurons (size = neurons/2+1)
+  typename CDEVector<T>::Type circ_spectrum_;
+  /// true if W_ has to be built from circ_spectrum_ before it is used
+  bool W_pending_;
+
+  /// builds the dense circulant W_ from circ_spectrum_ if needed
+  void buildW();
+
   /// feedback (output to reservoir) weight matrix
   /// \todo also sparse version !?
   DEMatrix Wback_;
@@ -565,10 +801,46 @@ class ESN
 
 
   /*!
-   * activation function for the reservoir
+   * activation function for the reservoir, a member function because
+   * tanh2 uses the slope and bias of this network
    * \sa activations.h
    */
-  void (*reservoirAct_)(T *data, int size);
+  void (ESN<T>::*reservoirAct_)(T *data, int size);
+
+  /// applies the reservoir activation function
+  void reservoirAct(T *data, int size)
+  { (this->*reservoirAct_)(data, size); }
+
+  //! @name reservoir activation functions \sa activations.h
+  //@{
+  void actLinear(T *data, int size) { act_linear(data, size); }
+  void actTanh(T *data, int size) { act_tanh(data, size); }
+  void actSigmoid(T *data, int size) { act_sigmoid(data, size); }
+  void actTanh2(T *data, int size)
+  {
+    assert( tanh2_a_.length() == size );
+    assert( tanh2_b_.length() == size );
+    act_tanh2( data, size, tanh2_a_.data(), tanh2_b_.data() );
+  }
+  /// Gaussian-IP adaptation step as activation function: slope and bias
+  /// are adapted with the pre-activation, the data stays unchanged
+  /// (linear), used by adapt()
+  void actTanh2IP(T *data, int size)
+  {
+    const T *x = data;
+    tanh2_ip_update( &x, 1, size, tanh2_a_.data(), tanh2_b_.data(),
+                     ip_lr_, ip_mean_, ip_var_ );
+  }
+  //@}
+
+  /// slope vector for the tanh2 activation function
+  flens::DenseVector<flens::Array<double> > tanh2_a_;
+  /// bias vector for the tanh2 activation function
+  flens::DenseVector<flens::Array<double> > tanh2_b_;
+  /// learnrate, desired mean and variance of the Gaussian-IP adaptation
+  double ip_lr_, ip_mean_, ip_var_;
+  /// nr of neurons per parallel block in the Gaussian-IP update of adapt()
+  enum { ADAPT_CHUNK = 64 };
 
   /*!
    * activation function for the outputs
@@ -593,6 +865,17 @@ class ESN
   /// noise level
   double noise_;
 
+  /// random numbers of this network, independent of other networks
+  RandomStream rand_;
+
+  /// preallocated buffers for single step simulation, so that
+  /// simulateStep() and trainStep() do not allocate memory
+  DEMatrix step_in_, step_out_, step_target_;
+
+  /// callback for EM delay learning diagnostics and its user data
+  EMCallback em_callback_;
+  void *em_callback_data_;
+
 
   /// parameter map for initialization arguments
   ParameterMap init_params_;
@@ -625,11 +908,20 @@ class ESN
   //@{
   friend class InitBase<T>;
   friend class InitStd<T>;
+  friend class InitCycle<T>;
+  friend class InitCirculant<T>;
   friend class TrainBase<T>;
   friend class TrainPI<T>;
   friend class TrainLS<T>;
   friend class TrainRidgeReg<T>;
+  friend class TrainRidgeRegCV<T>;
+  friend class TrainRLS<T>;
+  friend class TrainNLMS<T>;
   friend class TrainDSPI<T>;
+  friend class TrainLasso<T>;
+  friend class StateFactorization<T>;
+  friend class ArrayESN<T>;
+  friend class ParamSearch<T>;
   friend class SimBase<T>;
   friend class SimStd<T>;
   friend class SimSquare<T>;
@@ -26,11 +26,18 @@ template <typename T>
 ESN<T>::ESN()
 {
   set_denormal_flags();
-  Rand<T>::initSeed();
+  rand_.setSeed( RandomStream::defaultSeed() );
 
   init_=0;
   train_=0;
   sim_=0;
+  em_callback_=0;
+  em_callback_data_=0;
+  topology_ = TOPOLOGY_SPARSE;
+  cycle_weight_ = jump_weight_ = 0;
+  jump_size_ = 0;
+  W_pending_ = false;
+  ip_lr_ = ip_mean_ = ip_var_ = 0;
 
   // set some standard parameters
 
@@ -59,21 +66,28 @@ ESN<T>::ESN()
 template <typename T>
 ESN<T>::ESN(const ESN<T> &src)
 {
+  init_=0;
+  train_=0;
+  sim_=0;
   operator=(src);
 }
 
 template <typename T>
 ESN<T> &ESN<T>::operator= (const ESN<T> &src)
 {
-  init_=0;
-  train_=0;
-  sim_=0;
+  if( this == &src )
+    return *this;
+
+  // the algorithms of this network are deleted in the set methods
   noise_=0;
 
   neurons_ = src.neurons_;
   inputs_ = src.inputs_;
   outputs_ = src.outputs_;
   noise_ = src.noise_;
+  rand_ = src.rand_;
+  em_callback_ = src.em_callback_;
+  em_callback_data_ = src.em_callback_data_;
 
   /// \todo check if maps operator= performs a deep copy !
   init_params_ = src.init_params_;
@@ -85,13 +99,26 @@ ESN<T> &ESN<T>::operator= (const ESN<T> &src)
 
   // copy simulation alg and its data
   net_info_[SIMULATE_ALG] = src.getSimAlgorithm();
+  if(sim_) delete sim_;
   sim_ = src.sim_->clone(this);
 
   Win_ = src.Win_;
   W_ = src.W_;
+  topology_ = src.topology_;
+  cycle_weight_ = src.cycle_weight_;
+  jump_weight_ = src.jump_weight_;
+  jump_size_ = src.jump_size_;
+  circ_spectrum_ = src.circ_spectrum_;
+  W_pending_ = src.W_pending_;
   Wback_ = src.Wback_;
   Wout_ = src.Wout_;
   x_ = src.x_;
+  tanh2_a_ = src.tanh2_a_;
+  tanh2_b_ = src.tanh2_b_;
+  ip_lr_ = src.ip_lr_;
+  ip_mean_ = src.ip_mean_;
+  ip_var_ = src.ip_var_;
+  sim_->compressReadout();
 
   ActivationFunction tmp = src.getReservoirAct();
   setReservoirAct(tmp);
@@ -110,7 +137,7 @@ ESN<T>::~ESN()
 }
 
 template <typename T>
-double ESN<T>::adapt(const DEMatrix &in)
+double ESN<T>::adapt(const DEMatrix &in, int sequences)
   throw(AUExcept)
 {
   // this allocates the data, so we really need ACT_TANH2 activation function
@@ -125,39 +152,107 @@ double ESN<T>::adapt(const DEMatrix &in)
   if( init_params_.find(IP_MEAN) == init_params_.end() )
     init_params_[IP_MEAN] = 0.;
 
+  if( sequences < 1 || in.numCols() % sequences != 0 )
+    throw AUExcept("adapt: input must consist of sequences of equal length!");
+
   // difference vectors to see learn progress
   flens::DenseVector<flens::Array<double> > a_diff = tanh2_a_,
                                             b_diff = tanh2_b_;
 
   // adaptation algorithm
 
-  DEVector y(neurons_);
-  DEMatrix sim_in(inputs_,1), sim_out(outputs_,1);
-  int steps = in.numCols();
-  T lr = init_params_[IP_LEARNRATE];
-  T mean = init_params_[IP_MEAN];
-  T var = init_params_[IP_VAR];
-  T db;
+  ip_lr_ = init_params_[IP_LEARNRATE];
+  ip_mean_ = init_params_[IP_MEAN];
+  ip_var_ = init_params_[IP_VAR];
 
-  // set linear activation function to get values before nonlinearity
-  setReservoirAct(ACT_LINEAR);
+  if( sequences == 1 && net_info_[SIMULATE_ALG] == SIM_STD )
+  {
+    // adapt slope and bias within the reservoir activation function,
+    // with SIM_STD the activation is applied to the final state, so
+    // the network state stays the value before the nonlinearity
+    DEMatrix sim_out(outputs_, in.numCols());
+    reservoirAct_ = &ESN<T>::actTanh2IP;
+    simulate(in, sim_out);
+  }
+  else if( sequences == 1 )
+  {
+    // other simulation algorithms filter or leak the state after the
+    // activation, so adapt with the final state x_ of each time step
+    DEMatrix sim_in(inputs_,1), sim_out(outputs_,1);
 
-  for(int n=1; n<=steps; ++n)
+    // set linear activation function to get values before nonlinearity
+    setReservoirAct(ACT_LINEAR);
+
+    for(int n=1; n<=in.numCols(); ++n)
+    {
+      // simulate one step
+      sim_in(_,1) = in(_,n);
+      simulate(sim_in, sim_out);
+
+      const T *x = x_.data();
+      tanh2_ip_update( &x, 1, neurons_,
+                       tanh2_a_.data(), tanh2_b_.data(),
+                       ip_lr_, ip_mean_, ip_var_ );
+    }
+  }
+  else
   {
-    // simulate one step
-    sim_in(_,1) = in(_,n);
-    simulate(sim_in, sim_out);
-    // now we have our network state x_ without activation function
+    int steps = in.numCols() / sequences;
+
+    // set linear activation function to get values before nonlinearity
+    // and simulate the sequences with independent copies of the network
+    setReservoirAct(ACT_LINEAR);
+    std::vector< ESN<T> > nets(sequences, *this);
+
+    // copies have the same random numbers, so each sequence gets
+    // its own stream for the noise
+    unsigned long long seed = rand_.next();
+    for(int k=0; k<sequences; ++k)
+      nets[k].setSeed( RandomStream::derive(seed, k) );
+    std::vector<DEMatrix> sim_in(sequences), sim_out(sequences);
+    for(int k=0; k<sequences; ++k)
+    {
+      sim_in[k].resize(inputs_,1);
+      sim_out[k].resize(outputs_,1);
+    }
 
-    // calc activation
-    y = x_;
-    act_tanh2( y.data(), y.length() );
+    // the update is split into blocks of neurons, each block gets
+    // pointers to its part of the states of all sequences
+    const int chunks = (neurons_ + ADAPT_CHUNK - 1) / ADAPT_CHUNK;
+    std::vector<const T*> x(sequences*chunks);
 
-    for(int m=1; m<=neurons_; ++m)
+    // one parallel region for all steps, the threads are synchronized
+    // by the implicit barriers of the worksharing loops
+    #pragma omp parallel
     {
-      db = -lr * ( -mean/var + (y(m)/var)*(2*var+1-pow(y(m),2)+y(m)*mean) );
-      tanh2_b_(m) += db;
-      tanh2_a_(m) += lr/tanh2_a_(m) + db*x_(m);
+      set_denormal_flags();
+
+      for(int n=1; n<=steps; ++n)
+      {
+        // simulate one step of all sequences
+        #pragma omp for schedule(static)
+        for(int k=0; k<sequences; ++k)
+        {
+          sim_in[k](_,1) = in(_,k*steps+n);
+          nets[k].simulate(sim_in[k], sim_out[k]);
+        }
+        // implicit barrier
+
+        // averaged update with all states before the nonlinearity
+        #pragma omp for schedule(static)
+        for(int c=0; c<chunks; ++c)
+        {
+          int first = c*ADAPT_CHUNK;
+          int size = std::min<int>(ADAPT_CHUNK, neurons_-first);
+          for(int k=0; k<sequences; ++k)
+            x[c*sequences+k] = nets[k].x_.data() + first;
+
+          tanh2_ip_update( &x[c*sequences], sequences, size,
+                           tanh2_a_.data()+first, tanh2_b_.data()+first,
+                           ip_lr_, ip_mean_, ip_var_ );
+        }
+        // implicit barrier, the states are read before the next step
+      }
     }
   }
 
@@ -169,7 +264,7 @@ double ESN<T>::adapt(const DEMatrix &in)
   a_diff -= tanh2_a_;
   b_diff -= tanh2_b_;
   for(int i=1; i<=neurons_; ++i)
-    progress = a_diff(i) + b_diff(i);
+    progress += a_diff(i) + b_diff(i);
   progress /= 2*neurons_;
 
   return progress;
@@ -184,10 +279,14 @@ inline void ESN<T>::train(const DEMatrix &in, const DEMatrix &out, int washout)
   if( init_params_.find(RELAXATION_STAGES) != init_params_.end() )
     rstages = (int) init_params_[RELAXATION_STAGES];
 
+  // dense readout during training, Wout_ changes
+  sim_->clearReadout();
+
   // "usual" training
   if( !rstages )
   {
     train_->train(in, out, washout);
+    sim_->compressReadout();
     return;
   }
 
@@ -249,6 +348,30 @@ inline void ESN<T>::train(const DEMatrix &in, const DEMatrix &out, int washout)
 
     rstages--;
   }
+
+  sim_->compressReadout();
+}
+
+template <typename T>
+void ESN<T>::trainOnline(const DEMatrix &in, const DEMatrix &target,
+                         DEMatrix &out)
+  throw(AUExcept)
+{
+  if( target.numCols() != in.numCols() || out.numCols() != in.numCols() )
+    throw AUExcept("ESN::trainOnline: target, output and input must have same nr of columns!");
+  if( in.numRows() != inputs_ )
+    throw AUExcept("ESN::trainOnline: wrong input row size!");
+  if( target.numRows() != outputs_ || out.numRows() != outputs_ )
+    throw AUExcept("ESN::trainOnline: wrong target or output row size!");
+
+  // check if we already have allocated data in simulation algorithm
+  if( sim_->last_out_.numRows() != outputs_ )
+    throw AUExcept("ESN::trainOnline: You need to allocate data for simulation algortihm - e.g. set an Wout matrix or init ESN !");
+
+  // Wout_ changes in each timestep
+  sim_->clearReadout();
+  train_->trainOnline(in, target, out);
+  sim_->compressReadout();
 }
 
 template <typename T>
@@ -293,7 +416,17 @@ void ESN<T>::collectStates(const DEMatrix &in, DEMatrix &X, int washout)
 }
 
 template <typename T>
-double ESN<T>::adapt(T *inmtx, int inrows, int incols)
+void ESN<T>::ridgeRegressionPath(const DEMatrix &in, const DEMatrix &out,
+                                 int washout, const DEVector &alphas,
+                                 DEMatrix &Wouts)
+  throw(AUExcept)
+{
+  TrainRidgeReg<T> ridge(this);
+  ridge.trainPath(in, out, washout, alphas, Wouts);
+}
+
+template <typename T>
+double ESN<T>::adapt(T *inmtx, int inrows, int incols, int sequences)
   throw(AUExcept)
 {
   if( inrows != inputs_ )
@@ -307,7 +440,7 @@ double ESN<T>::adapt(T *inmtx, int inrows, int incols)
     flin(i+1,j+1) = inmtx[i*incols+j];
   } }
 
-  return adapt(flin);
+  return adapt(flin, sequences);
 }
 
 template <typename T>
@@ -381,18 +514,84 @@ inline void ESN<T>::simulateStep(T *invec, int insize, T *outvec, int outsize)
   if( sim_->last_out_.numRows() != outputs_ )
     throw AUExcept("ESN::simulate: You need to allocate data for simulation algortihm - e.g. set an Wout matrix or train ESN !");
 
-  DEMatrix flin(insize,1);
-  DEMatrix flout(outsize,1);
+  // allocate buffers only once
+  if( step_in_.numRows() != insize || step_out_.numRows() != outsize )
+  {
+    step_in_.resize(insize,1);
+    step_out_.resize(outsize,1);
+  }
 
   // copy data to FLENS matrix
-  for(int i=0; i<insize; ++i)
-    flin(i+1,1) = invec[i];
+  std::copy( invec, invec+insize, step_in_.data() );
 
-  simulate(flin, flout);
+  simulate(step_in_, step_out_);
+
+  // copy data to output
+  std::copy( step_out_.data(), step_out_.data()+outsize, outvec );
+}
+
+template <typename T>
+void ESN<T>::trainOnline(T *inmtx, int inrows, int incols,
+                         T *targmtx, int targrows, int targcols,
+                         T *outmtx, int outrows, int outcols)
+  throw(AUExcept)
+{
+  DEMatrix flin(inrows,incols);
+  DEMatrix fltarg(targrows,targcols);
+  DEMatrix flout(outrows,outcols);
+
+  // copy data to FLENS matrix (column major storage)
+  for(int i=0; i<inrows; ++i) {
+  for(int j=0; j<incols; ++j) {
+    flin(i+1,j+1) = inmtx[i*incols+j];
+  } }
+  for(int i=0; i<targrows; ++i) {
+  for(int j=0; j<targcols; ++j) {
+    fltarg(i+1,j+1) = targmtx[i*targcols+j];
+  } }
+
+  trainOnline(flin, fltarg, flout);
+
+  // copy data to output
+  for(int i=0; i<outrows; ++i) {
+  for(int j=0; j<outcols; ++j) {
+    outmtx[i*outcols+j] = flout(i+1,j+1);
+  } }
+}
+
+template <typename T>
+void ESN<T>::trainStep(T *invec, int insize, T *targvec, int targsize,
+                       T *outvec, int outsize)
+  throw(AUExcept)
+{
+  if( insize != inputs_ )
+    throw AUExcept("ESN::trainStep: wrong input row size!");
+  if( targsize != outputs_ || outsize != outputs_ )
+    throw AUExcept("ESN::trainStep: wrong target or output size!");
+
+  // check if we already have allocated data in simulation algorithm
+  if( sim_->last_out_.numRows() != outputs_ )
+    throw AUExcept("ESN::trainStep: You need to allocate data for simulation algortihm - e.g. set an Wout matrix or init ESN !");
+
+  // allocate buffers only once
+  if( step_in_.numRows() != insize || step_out_.numRows() != outsize ||
+      step_target_.numRows() != targsize )
+  {
+    step_in_.resize(insize,1);
+    step_out_.resize(outsize,1);
+    step_target_.resize(targsize,1);
+  }
+
+  // copy data to FLENS matrix
+  std::copy( invec, invec+insize, step_in_.data() );
+  std::copy( targvec, targvec+targsize, step_target_.data() );
+
+  // Wout_ changes in each timestep
+  sim_->clearReadout();
+  train_->trainOnline(step_in_, step_target_, step_out_);
 
   // copy data to output
-  for(int i=0; i<outsize; ++i)
-    outvec[i] = flout(i+1,1);
+  std::copy( step_out_.data(), step_out_.data()+outsize, outvec );
 }
 
 template <typename T>
@@ -440,6 +639,86 @@ void ESN<T>::collectStates(T *inmtx, int inrows, int incols,
   } }
 }
 
+template <typename T>
+void ESN<T>::ridgeRegressionPath(T *inmtx, int inrows, int incols,
+                                 T *outmtx, int outrows, int outcols,
+                                 int washout, T *alphavec, int alphasize,
+                                 T *wmtx, int wrows, int wcols)
+  throw(AUExcept)
+{
+  DEMatrix flin(inrows,incols);
+  DEMatrix flout(outrows,outcols);
+  DEVector alphas(alphasize);
+  DEMatrix Wouts;
+
+  // copy data to FLENS matrix (column major storage)
+  for(int i=0; i<inrows; ++i) {
+  for(int j=0; j<incols; ++j) {
+    flin(i+1,j+1) = inmtx[i*incols+j];
+  } }
+  for(int i=0; i<outrows; ++i) {
+  for(int j=0; j<outcols; ++j) {
+    flout(i+1,j+1) = outmtx[i*outcols+j];
+  } }
+  for(int i=0; i<alphasize; ++i)
+    alphas(i+1) = alphavec[i];
+
+  ridgeRegressionPath(flin, flout, washout, alphas, Wouts);
+
+  if( wrows != Wouts.numRows() )
+    throw AUExcept("ESN::ridgeRegressionPath: wrong row size!");
+  if( wcols != Wouts.numCols() )
+    throw AUExcept("ESN::ridgeRegressionPath: wrong column size!");
+
+  // copy data to output
+  for(int i=0; i<wrows; ++i) {
+  for(int j=0; j<wcols; ++j) {
+    wmtx[i*wcols+j] = Wouts(i+1,j+1);
+  } }
+}
+
+template <typename T>
+void ESN<T>::trainEpisodes(T *inmtx, int inrows, int incols,
+                           T *outmtx, int outrows, int outcols,
+                           int *lenvec, int lensize, int *washvec, int washsize)
+  throw(AUExcept)
+{
+  if( incols != outcols )
+    throw AUExcept("ESN::trainEpisodes: input and output must be same column size!");
+  if( lensize != washsize )
+    throw AUExcept("ESN::trainEpisodes: need length and washout for each episode!");
+
+  std::vector<DEMatrix> ins(lensize), outs(lensize);
+  std::vector<int> washouts(washvec, washvec+washsize);
+
+  // copy data of each episode to FLENS matrices (column major storage)
+  int col = 0;
+  for(int k=0; k<lensize; ++k)
+  {
+    if( lenvec[k] < 1 || col+lenvec[k] > incols )
+      throw AUExcept("ESN::trainEpisodes: episode lengths don't match data size!");
+
+    ins[k].resize(inrows, lenvec[k]);
+    outs[k].resize(outrows, lenvec[k]);
+
+    for(int i=0; i<inrows; ++i) {
+    for(int j=0; j<lenvec[k]; ++j) {
+      ins[k](i+1,j+1) = inmtx[i*incols+col+j];
+    } }
+    for(int i=0; i<outrows; ++i) {
+    for(int j=0; j<lenvec[k]; ++j) {
+      outs[k](i+1,j+1) = outmtx[i*outcols+col+j];
+    } }
+
+    col += lenvec[k];
+  }
+
+  if( col != incols )
+    throw AUExcept("ESN::trainEpisodes: episode lengths don't match data size!");
+
+  trainEpisodes(ins, outs, washouts);
+}
+
 template <typename T>
 void ESN<T>::setBPCutoff(const DEVector &f1, const DEVector &f2)
   throw(AUExcept)
@@ -584,10 +863,38 @@ void ESN<T>::getX(T **vec, int *length)
   *length = x_.length();
 }
 
+template <typename T>
+void ESN<T>::buildW()
+{
+  if( !W_pending_ )
+    return;
+
+  // first column of the circulant matrix with an inverse FFT
+  int n = neurons_;
+  typename CDEVector<T>::Type X( circ_spectrum_.length() );
+  std::copy( circ_spectrum_.data(), circ_spectrum_.data()+X.length(),
+             X.data() );
+  FFTPlans<T>::c2r( X.data(), n );
+  const T *c = reinterpret_cast<const T*>( X.data() );
+
+  // W(i,j) = c((i-j) mod n)
+  SPMatrix W(n, n);
+  for(int i=0; i<n; ++i)
+  {
+    for(int j=0; j<n; ++j)
+      W(i+1, j+1) = c[ (i-j+n) % n ];
+  }
+  W.finalize();
+  W_ = W;
+  W_pending_ = false;
+}
+
 template <typename T>
 void ESN<T>::getW(T *wmtx, int wrows, int wcols)
   throw(AUExcept)
 {
+  buildW();
+
   if( wrows != W_.numRows() )
     throw AUExcept("ESN::getW: wrong row size!");
   if( wcols != W_.numCols() )
@@ -638,6 +945,23 @@ void ESN<T>::getReservoirDelays(T *wmtx, int wrows, int wcols)
   } }
 }
 
+template <typename T>
+void ESN<T>::getCVErrors(T *wmtx, int wrows, int wcols)
+  throw(AUExcept)
+{
+  DEMatrix Etmp = getCVErrors();
+
+  if( wrows != Etmp.numRows() )
+    throw AUExcept("ESN::getCVErrors: wrong row size!");
+  if( wcols != Etmp.numCols() )
+    throw AUExcept("ESN::getCVErrors: wrong column size!");
+
+  for(int i=0; i<wrows; ++i) {
+  for(int j=0; j<wcols; ++j) {
+    wmtx[i*wcols+j] = Etmp(i+1,j+1);
+  } }
+}
+
 template <typename T>
 void ESN<T>::setInitAlgorithm(InitAlgorithm alg)
   throw(AUExcept)
@@ -650,6 +974,30 @@ void ESN<T>::setInitAlgorithm(InitAlgorithm alg)
       net_info_[INIT_ALG] = INIT_STD;
       break;
 
+    case INIT_CYCLE:
+      if(init_) delete init_;
+      init_ = new InitCycle<T>(this, TOPOLOGY_CYCLE);
+      net_info_[INIT_ALG] = INIT_CYCLE;
+      break;
+
+    case INIT_CYCLE_JUMPS:
+      if(init_) delete init_;
+      init_ = new InitCycle<T>(this, TOPOLOGY_CYCLE_JUMPS);
+      net_info_[INIT_ALG] = INIT_CYCLE_JUMPS;
+      break;
+
+    case INIT_DELAYLINE:
+      if(init_) delete init_;
+      init_ = new InitCycle<T>(this, TOPOLOGY_DELAYLINE);
+      net_info_[INIT_ALG] = INIT_DELAYLINE;
+      break;
+
+    case INIT_CIRCULANT:
+      if(init_) delete init_;
+      init_ = new InitCirculant<T>(this);
+      net_info_[INIT_ALG] = INIT_CIRCULANT;
+      break;
+
     default:
       throw AUExcept("ESN::setInitAlgorithm: no valid Algorithm!");
   }
@@ -685,6 +1033,30 @@ void ESN<T>::setTrainAlgorithm(TrainAlgorithm alg)
       net_info_[TRAIN_ALG] = TRAIN_DS_PI;
       break;
 
+    case TRAIN_RIDGEREG_CV:
+      if(train_) delete train_;
+      train_ = new TrainRidgeRegCV<T>(this);
+      net_info_[TRAIN_ALG] = TRAIN_RIDGEREG_CV;
+      break;
+
+    case TRAIN_RLS:
+      if(train_) delete train_;
+      train_ = new TrainRLS<T>(this);
+      net_info_[TRAIN_ALG] = TRAIN_RLS;
+      break;
+
+    case TRAIN_NLMS:
+      if(train_) delete train_;
+      train_ = new TrainNLMS<T>(this);
+      net_info_[TRAIN_ALG] = TRAIN_NLMS;
+      break;
+
+    case TRAIN_LASSO:
+      if(train_) delete train_;
+      train_ = new TrainLasso<T>(this);
+      net_info_[TRAIN_ALG] = TRAIN_LASSO;
+      break;
+
     default:
       throw AUExcept("ESN::setTrainAlgorithm: no valid Algorithm!");
   }
@@ -741,6 +1113,8 @@ void ESN<T>::setSimAlgorithm(SimAlgorithm alg)
     default:
       throw AUExcept("ESN::setSimAlgorithm: no valid Algorithm!");
   }
+
+  sim_->compressReadout();
 }
 
 template <typename T>
@@ -787,6 +1161,9 @@ template <typename T>
 void ESN<T>::setInitParam(InitParameter key, T value)
 {
   init_params_[key] = value;
+
+  if( train_ )
+    train_->initParamsChanged();
 }
 
 template <typename T>
@@ -796,22 +1173,22 @@ void ESN<T>::setReservoirAct(ActivationFunction f)
   switch(f)
   {
     case ACT_LINEAR:
-      reservoirAct_= act_linear;
+      reservoirAct_= &ESN<T>::actLinear;
       net_info_[RESERVOIR_ACT] = ACT_LINEAR;
       break;
 
     case ACT_TANH:
-      reservoirAct_= act_tanh;
+      reservoirAct_= &ESN<T>::actTanh;
       net_info_[RESERVOIR_ACT] = ACT_TANH;
       break;
 
     case ACT_TANH2:
-      reservoirAct_= act_tanh2;
+      reservoirAct_= &ESN<T>::actTanh2;
       net_info_[RESERVOIR_ACT] = ACT_TANH2;
       break;
 
     case ACT_SIGMOID:
-      reservoirAct_= act_sigmoid;
+      reservoirAct_= &ESN<T>::actSigmoid;
       net_info_[RESERVOIR_ACT] = ACT_SIGMOID;
       break;
 
@@ -870,6 +1247,8 @@ void ESN<T>::setW(const DEMatrix &W) throw(AUExcept)
 
 //   W_.initWith(W, 1E-9);
   W_ = W;
+  topology_ = TOPOLOGY_SPARSE;
+  W_pending_ = false;
 }
 
 template <typename T>
@@ -893,6 +1272,7 @@ void ESN<T>::setWout(const DEMatrix &Wout) throw(AUExcept)
       throw AUExcept("ESN::setWout: wrong column size!");
 
   Wout_ = Wout;
+  sim_->compressReadout();
 }
 
 template <typename T>
@@ -948,6 +1328,8 @@ void ESN<T>::setW(T *inmtx, int inrows, int incols) throw(AUExcept)
 
 //   W_.initWith(Wtmp, 1E-9);
   W_ = Wtmp;
+  topology_ = TOPOLOGY_SPARSE;
+  W_pending_ = false;
 }
 
 template <typename T>
@@ -981,6 +1363,8 @@ void ESN<T>::setWout(T *inmtx, int inrows, int incols) throw(AUExcept)
   for(int j=0; j<incols; ++j) {
     Wout_(i+1,j+1) = inmtx[i*incols+j];
   } }
+
+  sim_->compressReadout();
 }
 
 template <typename T>
@@ -1006,6 +1390,276 @@ void ESN<T>::setLastOutput(T *last, int size)
     sim_->last_out_(i+1,1) = last[i];
 }
 
+template <typename T>
+void ESN<T>::save(const char *filename)
+  throw(AUExcept)
+{
+  ModelWriter file(filename);
+
+  int info[11] = { neurons_, inputs_, outputs_,
+                   getInitAlgorithm(), getTrainAlgorithm(),
+                   getSimAlgorithm(), getReservoirAct(), getOutputAct(),
+                   topology_, jump_size_, Wout_.numCols() };
+  file.write( MODEL_INFO, info, 11 );
+
+  double scalars[3] = { noise_, cycle_weight_, jump_weight_ };
+  file.write( MODEL_SCALARS, scalars, 3 );
+
+  std::vector<double> params;
+  typename ParameterMap::const_iterator pit;
+  for(pit=init_params_.begin(); pit!=init_params_.end(); ++pit)
+  {
+    params.push_back( pit->first );
+    params.push_back( pit->second );
+  }
+  if( !params.empty() )
+    file.write( MODEL_PARAMS, &params[0], params.size() );
+
+  // RESERVOIR: spectrum of a circulant or compressed row storage
+  if( topology_ == TOPOLOGY_CIRCULANT && circ_spectrum_.length() > 0 )
+  {
+    file.write( MODEL_CIRC_SPECTRUM,
+                reinterpret_cast<const T*>( circ_spectrum_.data() ),
+                2*circ_spectrum_.length() );
+  }
+  else
+  {
+    typedef typename SPMatrix::const_iterator It;
+    std::vector<int> ptr(neurons_+1, 0);
+    for (It it=W_.begin(); it!=W_.end(); ++it)
+      ++ptr[ it->first.first ];
+    for(int i=0; i<neurons_; ++i)
+      ptr[i+1] += ptr[i];
+
+    int nnz = ptr[neurons_];
+    std::vector<int> col(nnz);
+    std::vector<T> val(nnz);
+    std::vector<int> pos(ptr.begin(), ptr.end()-1);
+    for (It it=W_.begin(); it!=W_.end(); ++it)
+    {
+      int k = pos[ it->first.first-1 ]++;
+      col[k] = it->first.second - 1;
+      val[k] = it->second;
+    }
+
+    file.write( MODEL_W_PTR, &ptr[0], ptr.size() );
+    if( nnz > 0 )
+    {
+      file.write( MODEL_W_COL, &col[0], nnz );
+      file.write( MODEL_W_VAL, &val[0], nnz );
+    }
+  }
+
+  // DENSE WEIGHTS AND STATE
+  if( Win_.numRows() == neurons_ && Win_.numCols() == inputs_ )
+    file.write( MODEL_WIN, Win_.data(), neurons_*inputs_ );
+  if( Wback_.numRows() == neurons_ && Wback_.numCols() == outputs_ )
+    file.write( MODEL_WBACK, Wback_.data(), neurons_*outputs_ );
+  if( Wout_.numRows() == outputs_ && Wout_.numCols() > 0 )
+    file.write( MODEL_WOUT, Wout_.data(), outputs_*Wout_.numCols() );
+  if( x_.length() == neurons_ )
+    file.write( MODEL_X, x_.data(), neurons_ );
+  if( sim_->last_out_.numRows() == outputs_ )
+    file.write( MODEL_LAST_OUT, sim_->last_out_.data(), outputs_ );
+
+  // slope and bias of tanh2 (possibly adapted)
+  if( getReservoirAct() == ACT_TANH2 && tanh2_a_.length() == neurons_ )
+  {
+    std::vector<double> tanh2(2*neurons_);
+    std::copy( tanh2_a_.data(), tanh2_a_.data()+neurons_, tanh2.begin() );
+    std::copy( tanh2_b_.data(), tanh2_b_.data()+neurons_,
+               tanh2.begin()+neurons_ );
+    file.write( MODEL_TANH2, &tanh2[0], tanh2.size() );
+  }
+
+  // filter coefficients and delays
+  sim_->save(file);
+
+  file.close();
+}
+
+template <typename T>
+void ESN<T>::load(const char *filename)
+  throw(AUExcept)
+{
+  ModelReader file(filename);
+
+  // 1. check all records, so that this network is not changed
+  //    if the file is broken
+
+  const int *info = file.data<int>(MODEL_INFO, 11);
+  int neurons = info[0], inputs = info[1], outputs = info[2];
+  int woutcols = info[10];
+  if( neurons < 1 || inputs < 1 || outputs < 1 )
+    throw AUExcept("ESN::load: wrong sizes in model file!");
+  if( woutcols != 0 && woutcols != neurons+inputs &&
+      woutcols != 2*(neurons+inputs) )
+    throw AUExcept("ESN::load: wrong size of Wout in model file!");
+
+  // the string functions throw for unknown algorithms
+  getInitString(info[3]);
+  getTrainString(info[4]);
+  getSimString(info[5]);
+  getActString(info[6]);
+  getActString(info[7]);
+  if( info[7] == ACT_TANH2 )
+    throw AUExcept("ESN::load: wrong output activation function in model file!");
+  if( info[8] < TOPOLOGY_SPARSE || info[8] > TOPOLOGY_CIRCULANT )
+    throw AUExcept("ESN::load: unknown reservoir topology in model file!");
+  if( info[9] < 0 || ( info[8] == TOPOLOGY_CYCLE_JUMPS && info[9] < 1 ) )
+    throw AUExcept("ESN::load: wrong jump size in model file!");
+
+  const double *scalars = file.data<double>(MODEL_SCALARS, 3);
+  size_t nparams = file.count(MODEL_PARAMS);
+  if( nparams % 2 )
+    throw AUExcept("ESN::load: wrong parameters in model file!");
+  const double *params = nparams ? file.data<double>(MODEL_PARAMS, nparams) : 0;
+
+  // reservoir
+  const int *ptr = 0, *col = 0;
+  size_t nnz = 0;
+  if( info[8] == TOPOLOGY_CIRCULANT )
+  {
+    file.checkReal( MODEL_CIRC_SPECTRUM, 2*(neurons/2 + 1) );
+    nnz = (size_t) neurons*neurons;
+  }
+  else
+  {
+    ptr = file.data<int>(MODEL_W_PTR, neurons+1);
+    if( ptr[0] != 0 || ptr[neurons] < 0 )
+      throw AUExcept("ESN::load: wrong reservoir in model file!");
+    nnz = ptr[neurons];
+    if( nnz > 0 )
+    {
+      col = file.data<int>(MODEL_W_COL, nnz);
+      file.checkReal( MODEL_W_VAL, nnz );
+    }
+    for(int i=0; i<neurons; ++i)
+    {
+      if( ptr[i] > ptr[i+1] )
+        throw AUExcept("ESN::load: wrong reservoir in model file!");
+      for(int k=ptr[i]; k<ptr[i+1]; ++k)
+      {
+        if( col[k] < 0 || col[k] >= neurons )
+          throw AUExcept("ESN::load: wrong reservoir in model file!");
+      }
+    }
+  }
+
+  // dense weights, state and activation
+  if( file.has(MODEL_WIN) )
+    file.checkReal( MODEL_WIN, neurons*inputs );
+  if( file.has(MODEL_WBACK) )
+    file.checkReal( MODEL_WBACK, neurons*outputs );
+  if( file.has(MODEL_WOUT) )
+    file.checkReal( MODEL_WOUT, outputs*woutcols );
+  if( file.has(MODEL_X) )
+    file.checkReal( MODEL_X, neurons );
+  if( file.has(MODEL_LAST_OUT) )
+    file.checkReal( MODEL_LAST_OUT, outputs );
+  const double *tanh2 = file.has(MODEL_TANH2) ?
+                        file.data<double>(MODEL_TANH2, 2*neurons) : 0;
+
+  // filter coefficients and delays
+  SimBase<T>::check(file, neurons, inputs, outputs, nnz);
+
+  // 2. now everything is copied once from the mapping into this network
+
+  setSize(neurons);
+  setInputs(inputs);
+  setOutputs(outputs);
+  setInitAlgorithm( static_cast<InitAlgorithm>(info[3]) );
+  setTrainAlgorithm( static_cast<TrainAlgorithm>(info[4]) );
+  setSimAlgorithm( static_cast<SimAlgorithm>(info[5]) );
+  setReservoirAct( static_cast<ActivationFunction>(info[6]) );
+  setOutputAct( static_cast<ActivationFunction>(info[7]) );
+  topology_ = static_cast<ReservoirTopology>(info[8]);
+  jump_size_ = info[9];
+
+  noise_ = scalars[0];
+  cycle_weight_ = scalars[1];
+  jump_weight_ = scalars[2];
+
+  init_params_.clear();
+  for(size_t i=0; i<nparams; i+=2)
+    init_params_[ static_cast<InitParameter>(int(params[i])) ] = params[i+1];
+
+  // RESERVOIR
+  if( topology_ == TOPOLOGY_CIRCULANT )
+  {
+    int nc = neurons/2 + 1;
+    circ_spectrum_.resizeOrClear(nc);
+    file.copy( MODEL_CIRC_SPECTRUM,
+               reinterpret_cast<T*>( circ_spectrum_.data() ), 2*nc );
+    W_pending_ = true;
+
+    // reservoir delays refer to the nonzero elements of W_
+    if( file.has(MODEL_RESERVOIR_DELAYS) )
+      buildW();
+  }
+  else
+  {
+    SPMatrix W(neurons, neurons);
+    if( nnz > 0 )
+    {
+      std::vector<T> val(nnz);
+      file.copy( MODEL_W_VAL, &val[0], nnz );
+      for(int i=0; i<neurons; ++i)
+      {
+        for(int k=ptr[i]; k<ptr[i+1]; ++k)
+          W(i+1, col[k]+1) = val[k];
+      }
+    }
+    W.finalize();
+    W_ = W;
+    W_pending_ = false;
+  }
+
+  // DENSE WEIGHTS AND STATE
+  Win_.resize(neurons, inputs);
+  if( file.has(MODEL_WIN) )
+    file.copy( MODEL_WIN, Win_.data(), neurons*inputs );
+  Wback_.resize(neurons, outputs);
+  if( file.has(MODEL_WBACK) )
+    file.copy( MODEL_WBACK, Wback_.data(), neurons*outputs );
+  if( file.has(MODEL_WOUT) )
+  {
+    Wout_.resize(outputs, woutcols);
+    file.copy( MODEL_WOUT, Wout_.data(), outputs*woutcols );
+  }
+  else
+    Wout_ = DEMatrix();
+  x_.resize(neurons);
+  if( file.has(MODEL_X) )
+    file.copy( MODEL_X, x_.data(), neurons );
+
+  // slope and bias of tanh2, the default is tanh
+  if( info[6] == ACT_TANH2 )
+  {
+    tanh2_a_.resize(neurons);
+    tanh2_b_.resize(neurons);
+    if( tanh2 )
+    {
+      std::copy( tanh2, tanh2+neurons, tanh2_a_.data() );
+      std::copy( tanh2+neurons, tanh2+2*neurons, tanh2_b_.data() );
+    }
+    else
+    {
+      std::fill_n( tanh2_a_.data(), neurons, 1. );
+      std::fill_n( tanh2_b_.data(), neurons, 0. );
+    }
+  }
+
+  sim_->reallocate();
+  if( file.has(MODEL_LAST_OUT) )
+    file.copy( MODEL_LAST_OUT, sim_->last_out_.data(), outputs );
+
+  // filter coefficients and delays
+  sim_->load(file);
+  sim_->compressReadout();
+  train_->resetOnline();
+}
+
 template <typename T>
 string ESN<T>::getActString(int act)
 {
@@ -1037,6 +1691,18 @@ string ESN<T>::getInitString(int alg)
     case INIT_STD:
       return "INIT_STD";
 
+    case INIT_CYCLE:
+      return "INIT_CYCLE";
+
+    case INIT_CYCLE_JUMPS:
+      return "INIT_CYCLE_JUMPS";
+
+    case INIT_DELAYLINE:
+      return "INIT_DELAYLINE";
+
+    case INIT_CIRCULANT:
+      return "INIT_CIRCULANT";
+
     default:
       throw AUExcept("ESN::getInitString: unknown init algorithm");
   }
@@ -1090,6 +1756,18 @@ string ESN<T>::getTrainString(int alg)
     case TRAIN_DS_PI:
       return "TRAIN_DS_PI";
 
+    case TRAIN_RIDGEREG_CV:
+      return "TRAIN_RIDGEREG_CV";
+
+    case TRAIN_RLS:
+      return "TRAIN_RLS";
+
+    case TRAIN_NLMS:
+      return "TRAIN_NLMS";
+
+    case TRAIN_LASSO:
+      return "TRAIN_LASSO";
+
     default:
       throw AUExcept("ESN::getTrainString: unknown training algorithm");
   }
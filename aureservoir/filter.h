@@ -78,6 +78,11 @@ class BPFilter
   /// the result back to x
   void calc(typename DEVector<T>::Type &x);
 
+  /// @return low pass cutoff frequencies
+  const typename DEVector<T>::Type &getF1() const { return f1_; }
+  /// @return high pass cutoff frequencies
+  const typename DEVector<T>::Type &getF2() const { return f2_; }
+
  protected:
 
   /// last output of ema1 (exponential moving average filter 1)
@@ -144,6 +149,11 @@ class IIRFilter
   /// the result back to x
   void calc(typename DEVector<T>::Type &x);
 
+  /// @return normalized numerator coefficients
+  const typename DEMatrix<T>::Type &getB() const { return B_; }
+  /// @return normalized denominator coefficients
+  const typename DEMatrix<T>::Type &getA() const { return A_; }
+
  protected:
 
   /// filter numerator coefficients
@@ -204,6 +214,11 @@ class SerialIIRFilter
   /// the result back to x
   void calc(typename DEVector<T>::Type &x);
 
+  /// @return nr of serial filters
+  int getSeries() const { return filters_.size(); }
+  /// @return serial filter nr i (starting from 0)
+  const IIRFilter<T> &getFilter(int i) const { return filters_[i]; }
+
  protected:
 
    /// the single filters
@@ -21,6 +21,9 @@
 #define AURESERVOIR_INIT_H__
 
 #include "utilities.h"
+#include "linalg.h"
+#include <vector>
+#include <utility>
 
 namespace aureservoir
 {
@@ -32,7 +35,27 @@ namespace aureservoir
  */
 enum InitAlgorithm
 {
-  INIT_STD      //!< standard initialization, \sa class InitStd
+  INIT_STD,         //!< standard initialization, \sa class InitStd
+  INIT_CYCLE,       //!< simple cycle reservoir, \sa class InitCycle
+  INIT_CYCLE_JUMPS, //!< cycle reservoir with jumps, \sa class InitCycle
+  INIT_DELAYLINE,   //!< delay line reservoir, \sa class InitCycle
+  INIT_CIRCULANT    //!< orthogonal circulant reservoir, \sa class InitCirculant
+};
+
+/*!
+ * \enum ReservoirTopology
+ *
+ * topology of the reservoir weight matrix, structured topologies are
+ * simulated with specialized O(neurons) kernels instead of the
+ * general sparse matrix-vector product
+ */
+enum ReservoirTopology
+{
+  TOPOLOGY_SPARSE,      //!< general sparse matrix
+  TOPOLOGY_CYCLE,       //!< neuron i gets input from neuron i-1 (cyclic)
+  TOPOLOGY_CYCLE_JUMPS, //!< cycle plus bidirectional jumps
+  TOPOLOGY_DELAYLINE,   //!< neuron i gets input from neuron i-1 (not cyclic)
+  TOPOLOGY_CIRCULANT    //!< dense circulant matrix, product with FFTs
 };
 
 /*!
@@ -64,7 +87,26 @@ enum InitParameter
   IP_MEAN,          //!< desired mean for Gaussian-IP reservoir adaptation
   IP_VAR,           //!< desired variance for Gaussian-IP reservoir adaptation
   RELAXATION_STAGES, //!< relaxation stages in training algorithm
-  DS_FORCE_MAXDELAY  //!< force a specific maxdelay without checks
+  DS_FORCE_MAXDELAY, //!< force a specific maxdelay without checks
+  CV_FOLDS,         //!< nr of folds for TrainRidgeRegCV
+  CV_TIKHONOV_MIN,  //!< smallest TIKHONOV_FACTOR for TrainRidgeRegCV
+  CV_TIKHONOV_MAX,  //!< largest TIKHONOV_FACTOR for TrainRidgeRegCV
+  CV_TIKHONOV_STEPS, //!< nr of (logarithmic spaced) factors for TrainRidgeRegCV
+  RLS_LAMBDA,       //!< forgetting factor for TrainRLS
+  RLS_DELTA,        //!< initial inverse correlation matrix is I/RLS_DELTA
+  NLMS_MU,          //!< normalized learnrate for TrainNLMS
+  DS_EM_TOLERANCE,  //!< stop EM iterations if delays are unchanged and weights change less
+  OOC_TILE_ROWS,    //!< rows per tile for out of core storage in TrainPI and TrainLS
+  LS_MIXED_PRECISION, //!< double precision gram matrices and solve in TrainLS
+  LS_REFINEMENT_STEPS, //!< nr of iterative refinement steps for LS_MIXED_PRECISION
+  LASSO_LAMBDA,     //!< L1 regularization factor for TrainLasso
+  LASSO_ITERATIONS, //!< maximum nr of coordinate descent sweeps for TrainLasso
+  LASSO_TOLERANCE,  //!< relative weight change to stop TrainLasso iterations
+  ALPHA_TOLERANCE,  //!< relative residual to stop the spectral radius estimation
+  ALPHA_ITERATIONS, //!< maximum nr of Arnoldi restarts for the spectral radius
+  FIXED_INDEGREE,   //!< same nr of connections in each row of the reservoir weight matrix
+  JUMP_SIZE,        //!< distance between the neurons of a jump in INIT_CYCLE_JUMPS
+  JUMP_WEIGHT       //!< weight of the jumps relative to the cycle weight in INIT_CYCLE_JUMPS
 };
 
 template <typename T> class ESN;
@@ -103,6 +145,90 @@ class InitBase
   /// allocates working data for algorithms
   virtual void allocateWorkData();
 
+  /*!
+   * allocates all weight matrices and the network state and initializes
+   * the input and feedback weights with random values within [-1,1]
+   * in the given connectivity
+   */
+  void initInputWeights();
+
+  /*!
+   * sets the reservoir weight matrix from CRS arrays and initializes
+   * the reservoir delays for SIM_FILTER_DS and SIM_SQUARE if needed
+   *
+   * @param ptr row pointers (neurons+1), 0-based
+   * @param col column index (0-based) of each nonzero element
+   * @param val value of each nonzero element
+   * @param scale factor for all values
+   */
+  void setReservoir(const std::vector<int> &ptr,
+                    const std::vector<int> &col,
+                    const std::vector<double> &val, T scale=1);
+
+  /*!
+   * samples k different random indices within [0|n) in O(k log k),
+   * without touching all n possible positions (only if k > n/2, where
+   * the n-k missing indices are sampled instead), the random numbers
+   * are drawn from the stream of the network
+   *
+   * @param n nr of possible positions
+   * @param k nr of samples (at most n)
+   * @param idx the sampled indices in ascending order
+   */
+  void sampleIndices(size_t n, size_t k, std::vector<size_t> &idx);
+
+  /*!
+   * estimates the spectral radius of a sparse square matrix with a
+   * thick restarted Arnoldi iteration (Krylov-Schur).
+   * Each cycle extends the Krylov basis to dimension KRYLOV_DIM, the
+   * eigenvalue with the largest magnitude of the small projected matrix
+   * is taken as estimate and the Schur vectors of the KRYLOV_KEEP largest
+   * Ritz values are kept for the next cycle, until the Ritz residual is
+   * smaller than tolerance * radius.
+   * Keeping several Ritz vectors matters for large random reservoirs,
+   * where many eigenvalues lie close to the circle of the spectral
+   * radius and a restart with a single Ritz vector can converge to an
+   * eigenvalue which is not the largest one.
+   * Only matrix-vector products are needed, so the costs are
+   * O(nnz * iterations) instead of O(N^3) for a full eigendecomposition.
+   *
+   * @param n nr of rows and columns
+   * @param ptr row pointers (n+1) of the matrix in CRS format, 0-based
+   * @param col column index (0-based) of each nonzero element
+   * @param val value of each nonzero element
+   * @param tolerance relative residual of the largest eigenvalue
+   * @param restarts maximum nr of Arnoldi cycles
+   * @param rand random stream for the start vector
+   * @return spectral radius (magnitude of the largest eigenvalue)
+   * @throw AUExcept if the estimation did not converge within
+   *        the given nr of restarts
+   */
+  static double spectralRadius(int n, const std::vector<int> &ptr,
+                               const std::vector<int> &col,
+                               const std::vector<double> &val,
+                               double tolerance, int restarts,
+                               RandomStream &rand)
+    throw(AUExcept);
+
+  /*!
+   * estimates the spectral radius of a reservoir matrix in CRS format
+   * with the parameters ALPHA_TOLERANCE and ALPHA_ITERATIONS of the
+   * network (default 1e-6 and 300)
+   */
+  double spectralRadius(const std::vector<int> &ptr,
+                        const std::vector<int> &col,
+                        const std::vector<double> &val)
+    throw(AUExcept);
+
+  /// indices of the eigenvalues (0-based), sorted by descending magnitude
+  static void sortByMagnitude(const DEVector<double>::Type &wr,
+                              const DEVector<double>::Type &wi,
+                              std::vector< std::pair<double,int> > &order);
+
+  /// dimension of the Krylov subspace and nr of kept Ritz vectors
+  /// in spectralRadius()
+  enum { KRYLOV_DIM = 60, KRYLOV_KEEP = 30 };
+
   /// reference to the data of the network
   ESN<T> *esn_;
 };
@@ -114,8 +240,16 @@ class InitBase
  *
  * Initializes all matrices with normal distributed random values in
  * a specific connectivity.
+ * The positions of the connections are sampled directly, so the costs
+ * of the reservoir matrix scale with the nr of connections and not with
+ * neurons^2. With FIXED_INDEGREE each row (each neuron) gets the same
+ * nr of connections, which balances the work of the sparse
+ * matrix-vector product.
  * Then it scales the weight matrix with the help of the largest
  * eigenvalue to the spectral radius alpha.
+ * The largest eigenvalue is estimated iteratively on the sparse matrix
+ * (see InitBase::spectralRadius), the accuracy can be set with
+ * ALPHA_TOLERANCE (default 1e-6) and ALPHA_ITERATIONS (default 300).
  */
 template <typename T>
 class InitStd : public InitBase<T>
@@ -130,6 +264,83 @@ class InitStd : public InitBase<T>
   virtual void init() throw(AUExcept);
 };
 
+/*!
+ * \class InitCycle
+ *
+ * \brief initialization of structured cycle and delay line reservoirs
+ *
+ * Initializes the input and feedback weights like InitStd, but the
+ * reservoir has a deterministic topology as described in
+ * Rodan and Tino "Minimum Complexity Echo State Network":
+ * <ul>
+ *   <li> INIT_CYCLE: each neuron gets input from the previous one, the
+ *        first from the last one, all with the weight ALPHA
+ *        (which is also the spectral radius) </li>
+ *   <li> INIT_CYCLE_JUMPS: a cycle with additional bidirectional
+ *        connections between the neurons 1, 1+JUMP_SIZE, 1+2*JUMP_SIZE,
+ *        ..., with JUMP_WEIGHT times the cycle weight (default 1), the
+ *        matrix is scaled to the spectral radius ALPHA </li>
+ *   <li> INIT_DELAYLINE: like the cycle, but without the connection
+ *        from the last to the first neuron, all weights are ALPHA
+ *        (the spectral radius of a delay line is always 0) </li>
+ * </ul>
+ *
+ * The reservoir weight matrix is also stored in the sparse W, but the
+ * simulation algorithms use specialized kernels with O(neurons) costs,
+ * which only need the weights and the jump size.
+ * After ESN::setW the general sparse product is used again.
+ */
+template <typename T>
+class InitCycle : public InitBase<T>
+{
+  using InitBase<T>::esn_;
+
+ public:
+  InitCycle(ESN<T> *esn, ReservoirTopology topology=TOPOLOGY_CYCLE)
+    : InitBase<T>(esn) { topology_ = topology; }
+  virtual ~InitCycle() {}
+
+  /// the algorithm
+  virtual void init() throw(AUExcept);
+
+ protected:
+
+  /// TOPOLOGY_CYCLE, TOPOLOGY_CYCLE_JUMPS or TOPOLOGY_DELAYLINE
+  ReservoirTopology topology_;
+};
+
+/*!
+ * \class InitCirculant
+ *
+ * \brief initialization of a dense orthogonal circulant reservoir
+ *
+ * Initializes the input and feedback weights like InitStd, the
+ * reservoir weight matrix is a circulant matrix
+ * W(i,j) = c((i-j) mod neurons), so that each neuron is connected
+ * to all others.
+ * The eigenvalues of a circulant matrix are the FFT of its first
+ * column c, here they are generated with random phases and magnitude 1
+ * (the matrix is orthogonal) and scaled to ALPHA, so no eigenvalue
+ * calculation is needed.
+ *
+ * The simulation algorithms calculate W*x as a circular convolution
+ * with FFTW in O(neurons*log(neurons)) (plans are cached, see FFTPlans).
+ * The dense W with neurons^2 elements is only built if it is needed,
+ * e.g. in ESN::getW or for reservoir delays with SIM_FILTER_DS.
+ */
+template <typename T>
+class InitCirculant : public InitBase<T>
+{
+  using InitBase<T>::esn_;
+
+ public:
+  InitCirculant(ESN<T> *esn) : InitBase<T>(esn) {}
+  virtual ~InitCirculant() {}
+
+  /// the algorithm
+  virtual void init() throw(AUExcept);
+};
+
 } // end of namespace aureservoir
 
 #endif // AURESERVOIR_INIT_H__
@@ -18,6 +18,7 @@
  ***************************************************************************/
 
 #include <algorithm>
+#include <cmath>
 
 namespace aureservoir
 {
@@ -57,6 +58,30 @@ void InitBase<T>::checkInitParams()
       throw AUExcept("InitBase::checkInitParams: LEAKING_RATE must be >= 0 !");
   }
 
+  if( esn_->init_params_.find(ALPHA_TOLERANCE) != esn_->init_params_.end() )
+  {
+    tmp = esn_->init_params_[ALPHA_TOLERANCE];
+    if( tmp<=0 )
+      throw AUExcept("InitBase::checkInitParams: ALPHA_TOLERANCE must be > 0 !");
+  }
+
+  if( esn_->init_params_.find(ALPHA_ITERATIONS) != esn_->init_params_.end() )
+  {
+    tmp = esn_->init_params_[ALPHA_ITERATIONS];
+    if( tmp<1 )
+      throw AUExcept("InitBase::checkInitParams: ALPHA_ITERATIONS must be >= 1 !");
+  }
+
+  if( esn_->net_info_[ESN<T>::INIT_ALG] == INIT_CYCLE_JUMPS )
+  {
+    if( esn_->init_params_.find(JUMP_SIZE) == esn_->init_params_.end() )
+      throw AUExcept("InitBase::checkInitParams: No JUMP_SIZE given !");
+
+    tmp = esn_->init_params_[JUMP_SIZE];
+    if( tmp<1 )
+      throw AUExcept("InitBase::checkInitParams: JUMP_SIZE must be >= 1 !");
+  }
+
   if( esn_->net_info_[ESN<T>::TRAIN_ALG] == TRAIN_RIDGEREG )
   {
     if( esn_->init_params_.find(TIKHONOV_FACTOR) == esn_->init_params_.end() )
@@ -66,6 +91,39 @@ void InitBase<T>::checkInitParams()
     if( tmp<0 )
       throw AUExcept("InitBase::checkInitParams: TIKHONOV_FACTOR must be >= 0 !");
   }
+
+  if( esn_->net_info_[ESN<T>::TRAIN_ALG] == TRAIN_LASSO )
+  {
+    if( esn_->init_params_.find(LASSO_LAMBDA) == esn_->init_params_.end() )
+      throw AUExcept("InitBase::checkInitParams: No LASSO_LAMBDA given !");
+
+    tmp = esn_->init_params_[LASSO_LAMBDA];
+    if( tmp<0 )
+      throw AUExcept("InitBase::checkInitParams: LASSO_LAMBDA must be >= 0 !");
+  }
+
+  if( esn_->net_info_[ESN<T>::TRAIN_ALG] == TRAIN_NLMS )
+  {
+    if( esn_->init_params_.find(NLMS_MU) == esn_->init_params_.end() )
+      throw AUExcept("InitBase::checkInitParams: No NLMS_MU given !");
+
+    tmp = esn_->init_params_[NLMS_MU];
+    if( tmp<=0 || tmp>=2 )
+      throw AUExcept("InitBase::checkInitParams: NLMS_MU must be within (0|2) !");
+  }
+
+  if( esn_->net_info_[ESN<T>::TRAIN_ALG] == TRAIN_RIDGEREG_CV )
+  {
+    if( esn_->init_params_.find(CV_TIKHONOV_MIN) == esn_->init_params_.end() ||
+        esn_->init_params_.find(CV_TIKHONOV_MAX) == esn_->init_params_.end() )
+      throw AUExcept("InitBase::checkInitParams: No CV_TIKHONOV_MIN or CV_TIKHONOV_MAX given !");
+
+    tmp = esn_->init_params_[CV_TIKHONOV_MIN];
+    if( tmp<=0 )
+      throw AUExcept("InitBase::checkInitParams: CV_TIKHONOV_MIN must be > 0 !");
+    if( esn_->init_params_[CV_TIKHONOV_MAX] < tmp )
+      throw AUExcept("InitBase::checkInitParams: CV_TIKHONOV_MAX must be >= CV_TIKHONOV_MIN !");
+  }
 }
 
 template <typename T>
@@ -77,10 +135,10 @@ void InitBase<T>::allocateWorkData()
   // calc params for tanh2 activation function
   if( esn_->net_info_[ESN<T>::RESERVOIR_ACT] == ACT_TANH2 )
   {
-    tanh2_a_.resize( esn_->neurons_ );
-    tanh2_b_.resize( esn_->neurons_ );
-    std::fill_n( tanh2_a_.data(), esn_->neurons_, 1. );
-    std::fill_n( tanh2_b_.data(), esn_->neurons_, 0. );
+    esn_->tanh2_a_.resize( esn_->neurons_ );
+    esn_->tanh2_b_.resize( esn_->neurons_ );
+    std::fill_n( esn_->tanh2_a_.data(), esn_->neurons_, 1. );
+    std::fill_n( esn_->tanh2_b_.data(), esn_->neurons_, 0. );
   }
 
   // set filtered neurons to standard ESN calculation
@@ -98,17 +156,9 @@ void InitBase<T>::allocateWorkData()
   }
 }
 
-//@}
-//! @name class InitStd Implementation
-//@{
-
 template <typename T>
-void InitStd<T>::init()
-  throw(AUExcept)
+void InitBase<T>::initInputWeights()
 {
-  this->checkInitParams();
-  this->allocateWorkData();
-
   esn_->Win_.resizeOrClear(esn_->neurons_, esn_->inputs_);
   esn_->Wback_.resizeOrClear(esn_->neurons_, esn_->outputs_);
   esn_->Wout_.resizeOrClear(esn_->outputs_, esn_->neurons_+esn_->inputs_);
@@ -118,16 +168,13 @@ void InitStd<T>::init()
   // INPUT WEIGHTS
 
   // generate random weigths within [-1,1] with given connectivity
+  std::vector<size_t> idx;
+  int mtxsize = esn_->Win_.numRows() * esn_->Win_.numCols();
   T nrn = esn_->neurons_*esn_->init_params_[IN_CONNECTIVITY]
           * esn_->inputs_ - 0.5;
-  int i;
-  for (i=0; i<nrn; ++i)
-    esn_->Win_.data()[i] = Rand<T>::uniform();
-
-  // shuffle elements within the matrix
-  int mtxsize = esn_->Win_.numRows() * esn_->Win_.numCols();
-  std::random_shuffle( esn_->Win_.data(),
-                       esn_->Win_.data() + mtxsize );
+  this->sampleIndices(mtxsize, (size_t) std::max<T>(std::ceil(nrn), 0), idx);
+  for(size_t i=0; i<idx.size(); ++i)
+    esn_->Win_.data()[ idx[i] ] = esn_->rand_.uniform();
 
   // scale and shift elemets
   esn_->Win_ *= esn_->init_params_[IN_SCALE];
@@ -137,66 +184,447 @@ void InitStd<T>::init()
   // FEEDBACK WEIGHTS
 
   // generate random weigths within [-1,1] with given connectivity
+  mtxsize = esn_->Wback_.numRows() * esn_->Wback_.numCols();
   nrn = esn_->neurons_*esn_->init_params_[FB_CONNECTIVITY]
         * esn_->outputs_ - 0.5;
-  for (int i=0; i<nrn; ++i)
-    esn_->Wback_.data()[i] = Rand<T>::uniform();
-
-  // shuffle elements within the matrix
-  mtxsize = esn_->Wback_.numRows() * esn_->Wback_.numCols();
-  std::random_shuffle( esn_->Wback_.data(),
-                       esn_->Wback_.data() + mtxsize );
+  this->sampleIndices(mtxsize, (size_t) std::max<T>(std::ceil(nrn), 0), idx);
+  for(size_t i=0; i<idx.size(); ++i)
+    esn_->Wback_.data()[ idx[i] ] = esn_->rand_.uniform();
 
   // scale and shift elemets
   esn_->Wback_ *= esn_->init_params_[FB_SCALE];
   esn_->Wback_ += esn_->init_params_[FB_SHIFT];
+}
 
+template <typename T>
+void InitBase<T>::setReservoir(const std::vector<int> &ptr,
+                               const std::vector<int> &col,
+                               const std::vector<double> &val, T scale)
+{
+  int n = esn_->neurons_;
 
-  // RESERVOIR WEIGHTS
+  // store it as sparse matrix
+  typename SPMatrix<T>::Type W(n, n);
+  for(int i=0; i<n; ++i)
+  {
+    for(int p=ptr[i]; p<ptr[i+1]; ++p)
+      W(i+1, col[p]+1) = scale * val[p];
+  }
+  W.finalize();
+  esn_->W_ = W;
+  esn_->W_pending_ = false;
 
-  // temporal dense reservoir weight matrix
-  typename DEMatrix<T>::Type Wtmp(esn_->neurons_, esn_->neurons_),
-                             tmp(esn_->neurons_, esn_->neurons_);
+  // RESERVOIR DELAYS: init delays in reservoir if needed
+  if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_FILTER_DS ||
+      esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
+    esn_->sim_->initReservoirDelays();
+}
 
-  // generate random weigths within [-1,1] with given connectivity
-  nrn = esn_->neurons_*esn_->neurons_*esn_->init_params_[CONNECTIVITY] - 0.5;
-  for (int i=0; i<nrn; ++i)
-    Wtmp.data()[i] = Rand<T>::uniform();
+template <typename T>
+double InitBase<T>::spectralRadius(const std::vector<int> &ptr,
+                                   const std::vector<int> &col,
+                                   const std::vector<double> &val)
+  throw(AUExcept)
+{
+  double tolerance = 1e-6;
+  if( esn_->init_params_.find(ALPHA_TOLERANCE) != esn_->init_params_.end() )
+    tolerance = esn_->init_params_[ALPHA_TOLERANCE];
+  int restarts = 300;
+  if( esn_->init_params_.find(ALPHA_ITERATIONS) != esn_->init_params_.end() )
+    restarts = (int) esn_->init_params_[ALPHA_ITERATIONS];
+
+  return spectralRadius(esn_->neurons_, ptr, col, val, tolerance, restarts,
+                        esn_->rand_);
+}
 
-  // shuffle elements within the matrix
-  std::random_shuffle( Wtmp.data(), 
-                       Wtmp.data() + (Wtmp.numRows()*Wtmp.numCols()) );
+template <typename T>
+void InitBase<T>::sampleIndices(size_t n, size_t k, std::vector<size_t> &idx)
+{
+  k = std::min(k, n);
+
+  // for more than n/2 samples the complement is sampled
+  bool complement = ( k > n/2 );
+  size_t m = complement ? n-k : k;
+
+  // draw the missing nr of indices, remove duplicates and repeat,
+  // each round at most halves the nr of missing indices
+  std::vector<size_t> tmp;
+  std::vector<size_t> &sample = complement ? tmp : idx;
+  sample.clear();
+  sample.reserve(m);
+  while( sample.size() < m )
+  {
+    for(size_t i=sample.size(); i<m; ++i)
+      sample.push_back( esn_->rand_.index(n) );
+    std::sort( sample.begin(), sample.end() );
+    sample.erase( std::unique(sample.begin(), sample.end()), sample.end() );
+  }
 
-  // calc eigenvalues of Wtmp
-  typename DEVector<T>::Type wr(esn_->neurons_),
-                             wi(esn_->neurons_),
-                             w(esn_->neurons_);
-  tmp = Wtmp; // needs a deep copy for ev
+  if( !complement )
+    return;
 
-  flens::ev(false, false, tmp, wr, wi, tmp, tmp); // last 2 are dummy for EV
+  // all indices which are not in the complement
+  idx.clear();
+  idx.reserve(k);
+  size_t c = 0;
+  for(size_t j=0; j<n; ++j)
+  {
+    if( c < tmp.size() && tmp[c] == j )
+      ++c;
+    else
+      idx.push_back(j);
+  }
+}
 
-  // calc largest absolut eigenvalue
-  for(int i=1; i<=esn_->neurons_; ++i)
-    w(i) = sqrt( pow(wr(i),2) + pow(wi(i),2) );
-  T max_ew = *std::max_element( w.data(), w.data()+w.length() );
+template <typename T>
+double InitBase<T>::spectralRadius(int n, const std::vector<int> &ptr,
+                                   const std::vector<int> &col,
+                                   const std::vector<double> &val,
+                                   double tolerance, int restarts,
+                                   RandomStream &rand)
+  throw(AUExcept)
+{
+  int m = std::min<int>(KRYLOV_DIM, n);
+  int keep = std::min<int>(KRYLOV_KEEP, m/2);
+
+  // Krylov basis V (n x m+1) and Hessenberg matrix H (m+1 x m),
+  // after a restart the leading p columns of H hold the kept Schur form
+  typename DEMatrix<double>::Type V(n, m+1), H(m+1, m), S, Q, X;
+  typename DEVector<double>::Type wr, wi;
+  std::vector< std::pair<double,int> > order;
+  std::vector<int> select;
+  double *v = V.data();
+
+  // random start vector
+  double nrm = 0;
+  for(int r=0; r<n; ++r)
+  {
+    v[r] = rand.uniform();
+    nrm += v[r]*v[r];
+  }
+  if( nrm == 0 )
+  { v[0] = 1.; nrm = 1.; }
+  nrm = sqrt(nrm);
+  for(int r=0; r<n; ++r)
+    v[r] /= nrm;
+
+  std::fill_n( H.data(), (m+1)*m, 0. );
+  int p = 0;
+  for(int cycle=0; cycle<restarts; ++cycle)
+  {
+    int k = m;
+    bool invariant = false;
+
+    // extend the Arnoldi factorization from p to m columns,
+    // with reorthogonalization
+    for(int j=p; j<m; ++j)
+    {
+      const double *vj = v + j*n;
+      double *w = v + (j+1)*n;
+
+      for(int r=0; r<n; ++r)
+      {
+        double sum = 0;
+        for(int q=ptr[r]; q<ptr[r+1]; ++q)
+          sum += val[q] * vj[ col[q] ];
+        w[r] = sum;
+      }
+
+      double wnrm = 0;
+      for(int r=0; r<n; ++r)
+        wnrm += w[r]*w[r];
+      wnrm = sqrt(wnrm);
+
+      for(int pass=0; pass<2; ++pass)
+      {
+        for(int i=0; i<=j; ++i)
+        {
+          const double *vi = v + i*n;
+          double d = 0;
+          for(int r=0; r<n; ++r)
+            d += vi[r]*w[r];
+          for(int r=0; r<n; ++r)
+            w[r] -= d*vi[r];
+          H(i+1,j+1) += d;
+        }
+      }
+
+      double h = 0;
+      for(int r=0; r<n; ++r)
+        h += w[r]*w[r];
+      h = sqrt(h);
+      H(j+2,j+1) = h;
+
+      // found an invariant subspace, the Ritz values are exact
+      if( h <= 1e-12*wnrm || j+1 == n )
+      {
+        k = j+1;
+        invariant = true;
+        break;
+      }
+
+      for(int r=0; r<n; ++r)
+        w[r] /= h;
+    }
+    double beta = invariant ? 0. : H(k+1,k);
+
+    // real Schur form S = Q.T * H(1:k,1:k) * Q of the projected matrix
+    S.resizeOrClear(k, k);
+    S = H(_(1,k),_(1,k));
+    if( gees(S, wr, wi, Q) > 0 )
+      throw AUExcept("InitBase::spectralRadius: Schur factorization failed!");
+
+    // move the Ritz value with the largest magnitude to the leading block
+    int nsel;
+    sortByMagnitude(wr, wi, order);
+    select.assign(k, 0);
+    select[ order[0].second ] = 1;
+    trsen(select, S, Q, wr, wi, nsel);
+    double rho = sqrt( wr(1)*wr(1) + wi(1)*wi(1) );
+
+    // residual of the leading Schur vectors: |h(k+1,k)| * |Q(k,1:nsel)|
+    double res = 0;
+    for(int i=1; i<=nsel; ++i)
+      res += Q(k,i)*Q(k,i);
+    res = beta * sqrt(res);
+    if( res <= tolerance*rho )
+      return rho;
+
+    // thick restart: keep the Schur vectors of the largest Ritz values,
+    // a complex pair is always kept as a whole, so p < m
+    sortByMagnitude(wr, wi, order);
+    select.assign(k, 0);
+    for(int i=0; i<keep; ++i)
+      select[ order[i].second ] = 1;
+    trsen(select, S, Q, wr, wi, p);
+
+    // V(:,1:p) = V(:,1:k) * Q(:,1:p) and V(:,p+1) = V(:,k+1)
+    X.resizeOrClear(n, p);
+    gemm(false, n, p, k, 1., v, Q.data(), 0., X.data());
+    std::copy( v + k*n, v + (k+1)*n, v + p*n );
+    std::copy( X.data(), X.data() + n*p, v );
+
+    // H(1:p,1:p) = S(1:p,1:p) and H(p+1,1:p) = h(k+1,k) * Q(k,1:p)
+    std::fill_n( H.data(), (m+1)*m, 0. );
+    for(int j=1; j<=p; ++j)
+    {
+      for(int i=1; i<=p; ++i)
+        H(i,j) = S(i,j);
+      H(p+1,j) = beta * Q(k,j);
+    }
+  }
+
+  throw AUExcept("InitBase::spectralRadius: no convergence within "
+                 "ALPHA_ITERATIONS restarts!");
+}
+
+template <typename T>
+void InitBase<T>::sortByMagnitude(const DEVector<double>::Type &wr,
+                                  const DEVector<double>::Type &wi,
+                                  std::vector< std::pair<double,int> > &order)
+{
+  int k = wr.length();
+  order.resize(k);
+  for(int i=0; i<k; ++i)
+    order[i] = std::make_pair( -(wr(i+1)*wr(i+1) + wi(i+1)*wi(i+1)), i );
+  std::sort( order.begin(), order.end() );
+}
+
+//@}
+//! @name class InitStd Implementation
+//@{
+
+template <typename T>
+void InitStd<T>::init()
+  throw(AUExcept)
+{
+  this->checkInitParams();
+  this->allocateWorkData();
+  this->initInputWeights();
+
+
+  // RESERVOIR WEIGHTS
+
+  // sample the positions of the connections directly in CRS format
+  int n = esn_->neurons_;
+  std::vector<size_t> idx;
+  std::vector<int> ptr(n+1), col;
+  std::vector<double> val;
+  ptr[0] = 0;
+
+  if( esn_->init_params_.find(FIXED_INDEGREE) != esn_->init_params_.end() &&
+      esn_->init_params_[FIXED_INDEGREE] )
+  {
+    // same nr of connections in each row
+    T nrn = n*esn_->init_params_[CONNECTIVITY] - 0.5;
+    size_t k = (size_t) std::max<T>(std::ceil(nrn), 0);
+    col.reserve(n*k);
+    for(int i=0; i<n; ++i)
+    {
+      this->sampleIndices(n, k, idx);
+      for(size_t j=0; j<k; ++j)
+        col.push_back( idx[j] );
+      ptr[i+1] = col.size();
+    }
+  }
+  else
+  {
+    // connections anywhere in the matrix
+    double nrc = double(n)*n*esn_->init_params_[CONNECTIVITY] - 0.5;
+    this->sampleIndices((size_t) n*n, (size_t) std::max(std::ceil(nrc), 0.), idx);
+    col.resize(idx.size());
+    for(size_t i=0; i<idx.size(); ++i)
+    {
+      col[i] = idx[i] % n;
+      ++ptr[ idx[i]/n + 1 ];
+    }
+    for(int i=1; i<=n; ++i)
+      ptr[i] += ptr[i-1];
+  }
+
+  // generate random weigths within [-1,1]
+  val.resize(col.size());
+  for(size_t i=0; i<val.size(); ++i)
+    val[i] = esn_->rand_.uniform();
+
+  // estimate largest absolut eigenvalue
+  T max_ew = this->spectralRadius(ptr, col, val);
 
   // check if we have zero max_ew
   if( max_ew == 0 )
     throw AUExcept("InitStd::init: maximum eigenvalue is zero ! Try init again!");
 
   // scale matrix to spectral radius alpha
+  esn_->topology_ = TOPOLOGY_SPARSE;
+  this->setReservoir(ptr, col, val, esn_->init_params_[ALPHA] / max_ew);
+}
+
+template <typename T>
+void InitCycle<T>::init()
+  throw(AUExcept)
+{
+  this->checkInitParams();
+  this->allocateWorkData();
+  this->initInputWeights();
+
+  // RESERVOIR WEIGHTS
+
+  int n = esn_->neurons_;
   T alpha = esn_->init_params_[ALPHA];
-  Wtmp *= (alpha / max_ew);
+  std::vector<int> ptr(n+1), col;
+  std::vector<double> val;
 
-  // finally convert it to sparse matrix
-//   esn_->W_.initWith(Wtmp, 1E-9);
-  esn_->W_ = Wtmp; /// \todo check initialization with epsillon again in flens !!!
+  // connections from the previous neuron (CRS with sorted columns)
+  ptr[0] = 0;
+  for(int i=0; i<n; ++i)
+  {
+    if( i == 0 && topology_ != TOPOLOGY_DELAYLINE )
+    {
+      col.push_back(n-1);
+      val.push_back(1.);
+    }
+    if( i > 0 )
+    {
+      col.push_back(i-1);
+      val.push_back(1.);
+    }
+    ptr[i+1] = col.size();
+  }
 
+  T cycle_weight = alpha;
+  T jump_weight = 0;
+  int jump_size = 0;
+
+  if( topology_ == TOPOLOGY_CYCLE_JUMPS )
+  {
+    jump_size = (int) esn_->init_params_[JUMP_SIZE];
+    double jump = 1.;
+    if( esn_->init_params_.find(JUMP_WEIGHT) != esn_->init_params_.end() )
+      jump = esn_->init_params_[JUMP_WEIGHT];
+
+    // add bidirectional jumps between i and i+jump_size
+    std::vector<int> jptr(n+1), jcol;
+    std::vector<double> jval;
+    jptr[0] = 0;
+    for(int i=0; i<n; ++i)
+    {
+      std::vector< std::pair<int,double> > row;
+      for(int p=ptr[i]; p<ptr[i+1]; ++p)
+        row.push_back( std::make_pair(col[p], val[p]) );
+      if( i % jump_size == 0 && i >= jump_size )
+        row.push_back( std::make_pair(i-jump_size, jump) );
+      if( i % jump_size == 0 && i+jump_size < n )
+        row.push_back( std::make_pair(i+jump_size, jump) );
+
+      // sorted columns, connections to the same neuron are added
+      std::sort( row.begin(), row.end() );
+      for(size_t k=0; k<row.size(); ++k)
+      {
+        if( jptr[i] < (int) jcol.size() && jcol.back() == row[k].first )
+          jval.back() += row[k].second;
+        else
+        {
+          jcol.push_back( row[k].first );
+          jval.push_back( row[k].second );
+        }
+      }
+      jptr[i+1] = jcol.size();
+    }
+    ptr.swap(jptr);
+    col.swap(jcol);
+    val.swap(jval);
+
+    // scale to spectral radius alpha
+    T max_ew = this->spectralRadius(ptr, col, val);
+    if( max_ew == 0 )
+      throw AUExcept("InitCycle::init: maximum eigenvalue is zero !");
+    cycle_weight = alpha / max_ew;
+    jump_weight = jump * cycle_weight;
+  }
+
+  esn_->topology_ = topology_;
+  esn_->cycle_weight_ = cycle_weight;
+  esn_->jump_weight_ = jump_weight;
+  esn_->jump_size_ = jump_size;
+  this->setReservoir(ptr, col, val, cycle_weight);
+}
+
+template <typename T>
+void InitCirculant<T>::init()
+  throw(AUExcept)
+{
+  this->checkInitParams();
+  this->allocateWorkData();
+  this->initInputWeights();
+
+  // RESERVOIR WEIGHTS
+
+  // eigenvalues with random phases and magnitude alpha, the spectrum
+  // of a real signal is conjugate symmetric, so only half of it is
+  // stored and the first (and for even size the middle) value is real,
+  // the normalization 1/neurons of the inverse FFT is included
+  int n = esn_->neurons_;
+  int nc = n/2 + 1;
+  T scale = esn_->init_params_[ALPHA] / n;
+  esn_->circ_spectrum_.resizeOrClear(nc);
+  for(int k=0; k<nc; ++k)
+  {
+    if( k == 0 || 2*k == n )
+      esn_->circ_spectrum_(k+1) = ( esn_->rand_.uniform() < 0 ) ? -scale : scale;
+    else
+      esn_->circ_spectrum_(k+1) = std::polar( scale, T(M_PI)*esn_->rand_.uniform() );
+  }
+
+  esn_->topology_ = TOPOLOGY_CIRCULANT;
+  esn_->W_pending_ = true;
 
   // RESERVOIR DELAYS: init delays in reservoir if needed
   if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_FILTER_DS ||
       esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
+  {
+    esn_->buildW();
     esn_->sim_->initReservoirDelays();
+  }
 }
 
 //@}
@@ -0,0 +1,272 @@
+/***************************************************************************/
+/*!
+ *  \file   linalg.h
+ *
+ *  \brief  direct LAPACK/BLAS routines which are not available in FLENS
+ *
+ *  \author Georg Holzmann, grh _at_ mur _dot_ at
+ *  \date   Oct 2026
+ *
+ *   ::::_aureservoir_::::
+ *   C++ library for analog reservoir computing neural networks
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ ***************************************************************************/
+
+#ifndef AURESERVOIR_LINALG_H__
+#define AURESERVOIR_LINALG_H__
+
+#include "utilities.h"
+#include <limits>
+#include <cmath>
+#include <algorithm>
+#include <vector>
+
+extern "C"
+{
+#include <cblas.h>
+}
+
+namespace aureservoir
+{
+
+//! @name LAPACK routines for symmetric matrices
+/// \note all matrices must be FLENS matrices with their own storage
+///       (no views), the leading dimension is the number of rows
+//@{
+
+/*!
+ * Cholesky factorization of a symmetric positive definite matrix
+ * in double precision (LAPACK's xPOTRF).
+ * Only the lower triangle of A is referenced and overwritten with L,
+ * where A = L * L.T
+ * @param A symmetric positive definite matrix
+ * @return LAPACK info, > 0 if A is not positive definite
+ */
+int potrf(DEMatrix<double>::Type &A);
+
+/*!
+ * Cholesky factorization of a symmetric positive definite matrix
+ * in single precision (LAPACK's xPOTRF).
+ * Only the lower triangle of A is referenced and overwritten with L,
+ * where A = L * L.T
+ * @param A symmetric positive definite matrix
+ * @return LAPACK info, > 0 if A is not positive definite
+ */
+int potrf(DEMatrix<float>::Type &A);
+
+/*!
+ * solves A * X = B in double precision with the Cholesky factor of A
+ * calculated by potrf (LAPACK's xPOTRS)
+ * @param L Cholesky factor from potrf
+ * @param B right hand sides, will be overwritten with the solution X
+ * @return LAPACK info, < 0 if an argument had an illegal value
+ */
+int potrs(const DEMatrix<double>::Type &L, DEMatrix<double>::Type &B);
+
+/*!
+ * solves A * X = B in single precision with the Cholesky factor of A
+ * calculated by potrf (LAPACK's xPOTRS)
+ * @param L Cholesky factor from potrf
+ * @param B right hand sides, will be overwritten with the solution X
+ * @return LAPACK info, < 0 if an argument had an illegal value
+ */
+int potrs(const DEMatrix<float>::Type &L, DEMatrix<float>::Type &B);
+
+/*!
+ * eigenvalues and eigenvectors of a symmetric matrix in double precision
+ * (LAPACK's xSYEV)
+ * @param A symmetric matrix, will be overwritten with the orthonormal
+ *          eigenvectors (one eigenvector per column)
+ * @param w eigenvalues in ascending order, will be resized
+ * @return LAPACK info, > 0 if the algorithm did not converge
+ */
+int syev(DEMatrix<double>::Type &A, DEVector<double>::Type &w);
+
+/*!
+ * eigenvalues and eigenvectors of a symmetric matrix in single precision
+ * (LAPACK's xSYEV)
+ * @param A symmetric matrix, will be overwritten with the orthonormal
+ *          eigenvectors (one eigenvector per column)
+ * @param w eigenvalues in ascending order, will be resized
+ * @return LAPACK info, > 0 if the algorithm did not converge
+ */
+int syev(DEMatrix<float>::Type &A, DEVector<float>::Type &w);
+
+//@}
+//! @name LAPACK routines for singular value decompositions
+/// \note all matrices must be FLENS matrices with their own storage
+///       (no views), the leading dimension is the number of rows
+//@{
+
+/*!
+ * thin singular value decomposition A = U * diag(s) * VT of a general
+ * matrix in double precision (LAPACK's xGESDD)
+ * @param A general (m x n) matrix, will be destroyed
+ * @param s singular values in descending order, will be resized to
+ *          min(m,n)
+ * @param U left singular vectors, will be resized to (m x min(m,n))
+ * @param VT transposed right singular vectors, will be resized to
+ *           (min(m,n) x n)
+ * @return LAPACK info, > 0 if the algorithm did not converge
+ */
+int gesdd(DEMatrix<double>::Type &A, DEVector<double>::Type &s,
+          DEMatrix<double>::Type &U, DEMatrix<double>::Type &VT);
+
+/*!
+ * thin singular value decomposition A = U * diag(s) * VT of a general
+ * matrix in single precision (LAPACK's xGESDD)
+ * @param A general (m x n) matrix, will be destroyed
+ * @param s singular values in descending order, will be resized to
+ *          min(m,n)
+ * @param U left singular vectors, will be resized to (m x min(m,n))
+ * @param VT transposed right singular vectors, will be resized to
+ *           (min(m,n) x n)
+ * @return LAPACK info, > 0 if the algorithm did not converge
+ */
+int gesdd(DEMatrix<float>::Type &A, DEVector<float>::Type &s,
+          DEMatrix<float>::Type &U, DEMatrix<float>::Type &VT);
+
+//@}
+//! @name LAPACK routines for QR factorizations
+/// \note all matrices must be FLENS matrices with their own storage
+///       (no views), the leading dimension is the number of rows
+//@{
+
+/*!
+ * QR factorization of a general matrix in double precision
+ * (LAPACK's xGEQRF).
+ * A is overwritten with R in the upper triangle and the Householder
+ * vectors of Q below the diagonal.
+ * @param A general (m x n) matrix
+ * @param tau scalar factors of the Householder reflectors, will be resized
+ * @return LAPACK info
+ */
+int geqrf(DEMatrix<double>::Type &A, DEVector<double>::Type &tau);
+
+/*!
+ * QR factorization of a general matrix in single precision
+ * (LAPACK's xGEQRF).
+ * A is overwritten with R in the upper triangle and the Householder
+ * vectors of Q below the diagonal.
+ * @param A general (m x n) matrix
+ * @param tau scalar factors of the Householder reflectors, will be resized
+ * @return LAPACK info
+ */
+int geqrf(DEMatrix<float>::Type &A, DEVector<float>::Type &tau);
+
+/*!
+ * calculates C = Q.T * C in double precision, where Q is given by
+ * geqrf (LAPACK's xORMQR)
+ * @param A factorization from geqrf
+ * @param tau scalar factors from geqrf
+ * @param C general matrix with the same nr of rows as A
+ * @return LAPACK info
+ */
+int ormqr(const DEMatrix<double>::Type &A, const DEVector<double>::Type &tau,
+          DEMatrix<double>::Type &C);
+
+/*!
+ * calculates C = Q.T * C in single precision, where Q is given by
+ * geqrf (LAPACK's xORMQR)
+ * @param A factorization from geqrf
+ * @param tau scalar factors from geqrf
+ * @param C general matrix with the same nr of rows as A
+ * @return LAPACK info
+ */
+int ormqr(const DEMatrix<float>::Type &A, const DEVector<float>::Type &tau,
+          DEMatrix<float>::Type &C);
+
+//@}
+//! @name LAPACK routines for nonsymmetric eigenproblems
+/// \note all matrices must be FLENS matrices with their own storage
+///       (no views), the leading dimension is the number of rows
+//@{
+
+/*!
+ * real Schur factorization A = Q * T * Q.T of a general square matrix
+ * in double precision (LAPACK's xGEES), the eigenvalues are not sorted
+ * @param A general matrix, will be overwritten with the quasi upper
+ *          triangular Schur form T (1x1 and 2x2 blocks on the diagonal)
+ * @param wr real parts of the eigenvalues, will be resized
+ * @param wi imaginary parts of the eigenvalues, complex conjugate pairs
+ *           are consecutive with the positive imaginary part first,
+ *           will be resized
+ * @param Q orthogonal Schur vectors, will be resized
+ * @return LAPACK info, > 0 if the QR algorithm did not converge
+ */
+int gees(DEMatrix<double>::Type &A, DEVector<double>::Type &wr,
+         DEVector<double>::Type &wi, DEMatrix<double>::Type &Q);
+
+/*!
+ * reorders the real Schur factorization T, Q of gees in double precision,
+ * so that the selected eigenvalues are in the leading diagonal blocks
+ * of T (LAPACK's xTRSEN).
+ * The selected eigenvalues keep their relative order.
+ * @param select select[i] != 0 if the i-th eigenvalue (0-based) should
+ *               be moved to the leading blocks, for a complex pair one
+ *               selected element is enough
+ * @param T Schur form, will be reordered
+ * @param Q Schur vectors, will be updated
+ * @param wr real parts of the reordered eigenvalues
+ * @param wi imaginary parts of the reordered eigenvalues
+ * @param m will be set to the nr of selected eigenvalues (dimension of
+ *          the leading invariant subspace)
+ * @return LAPACK info
+ */
+int trsen(const std::vector<int> &select, DEMatrix<double>::Type &T,
+          DEMatrix<double>::Type &Q, DEVector<double>::Type &wr,
+          DEVector<double>::Type &wi, int &m);
+
+//@}
+//! @name BLAS routines for packed symmetric matrices, updates and products
+/// \note packed matrices store the upper triangle in column major order,
+///       element (i,j) with i<=j is at index i+j*(j+1)/2 (zero based)
+//@{
+
+/// y = alpha*A*x + beta*y, A packed symmetric (n x n), double precision
+void spmv(int n, double alpha, const double *Ap, const double *x,
+          double beta, double *y);
+/// y = alpha*A*x + beta*y, A packed symmetric (n x n), single precision
+void spmv(int n, float alpha, const float *Ap, const float *x,
+          float beta, float *y);
+
+/// A = A + alpha*x*x.T, A packed symmetric (n x n), double precision
+void spr(int n, double alpha, const double *x, double *Ap);
+/// A = A + alpha*x*x.T, A packed symmetric (n x n), single precision
+void spr(int n, float alpha, const float *x, float *Ap);
+
+/// A = A + alpha*x*y.T, A general column major (m x n), double precision
+void ger(int m, int n, double alpha, const double *x, const double *y,
+         double *A);
+/// A = A + alpha*x*y.T, A general column major (m x n), single precision
+void ger(int m, int n, float alpha, const float *x, const float *y,
+         float *A);
+
+/// C = alpha*A.T*A + beta*C, A general column major (k x n),
+/// only the lower triangle of C (n x n) is referenced, double precision
+void syrk(int n, int k, double alpha, const double *A, double beta,
+          double *C);
+
+/// C = alpha*op(A)*B + beta*C, op(A) = A.T (A is k x m) if transa,
+/// otherwise op(A) = A (A is m x k), B (k x n), C (m x n), all column major
+/// and double precision
+void gemm(bool transa, int m, int n, int k, double alpha, const double *A,
+          const double *B, double beta, double *C);
+
+/// x = alpha*x, double precision
+void scal(int n, double alpha, double *x);
+/// x = alpha*x, single precision
+void scal(int n, float alpha, float *x);
+
+//@}
+
+} // end of namespace aureservoir
+
+#include <aureservoir/linalg.hpp>
+
+#endif // AURESERVOIR_LINALG_H__
@@ -0,0 +1,364 @@
+/***************************************************************************/
+/*!
+ *  \file   linalg.hpp
+ *
+ *  \brief  direct LAPACK/BLAS routines which are not available in FLENS
+ *
+ *  \author Georg Holzmann, grh _at_ mur _dot_ at
+ *  \date   Oct 2026
+ *
+ *   ::::_aureservoir_::::
+ *   C++ library for analog reservoir computing neural networks
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ ***************************************************************************/
+
+#include <assert.h>
+
+// fortran LAPACK prototypes, LAPACK and CBLAS are already linked by FLENS
+extern "C"
+{
+  void dpotrf_(const char *uplo, const int *n, double *a, const int *lda,
+               int *info);
+  void spotrf_(const char *uplo, const int *n, float *a, const int *lda,
+               int *info);
+  void dpotrs_(const char *uplo, const int *n, const int *nrhs,
+               const double *a, const int *lda, double *b, const int *ldb,
+               int *info);
+  void spotrs_(const char *uplo, const int *n, const int *nrhs,
+               const float *a, const int *lda, float *b, const int *ldb,
+               int *info);
+  void dsyev_(const char *jobz, const char *uplo, const int *n, double *a,
+              const int *lda, double *w, double *work, const int *lwork,
+              int *info);
+  void ssyev_(const char *jobz, const char *uplo, const int *n, float *a,
+              const int *lda, float *w, float *work, const int *lwork,
+              int *info);
+  void dgesdd_(const char *jobz, const int *m, const int *n, double *a,
+               const int *lda, double *s, double *u, const int *ldu,
+               double *vt, const int *ldvt, double *work, const int *lwork,
+               int *iwork, int *info);
+  void sgesdd_(const char *jobz, const int *m, const int *n, float *a,
+               const int *lda, float *s, float *u, const int *ldu,
+               float *vt, const int *ldvt, float *work, const int *lwork,
+               int *iwork, int *info);
+  void dgeqrf_(const int *m, const int *n, double *a, const int *lda,
+               double *tau, double *work, const int *lwork, int *info);
+  void sgeqrf_(const int *m, const int *n, float *a, const int *lda,
+               float *tau, float *work, const int *lwork, int *info);
+  void dormqr_(const char *side, const char *trans, const int *m,
+               const int *n, const int *k, const double *a, const int *lda,
+               const double *tau, double *c, const int *ldc, double *work,
+               const int *lwork, int *info);
+  void sormqr_(const char *side, const char *trans, const int *m,
+               const int *n, const int *k, const float *a, const int *lda,
+               const float *tau, float *c, const int *ldc, float *work,
+               const int *lwork, int *info);
+  void dgees_(const char *jobvs, const char *sort,
+              int (*select)(const double *, const double *), const int *n,
+              double *a, const int *lda, int *sdim, double *wr, double *wi,
+              double *vs, const int *ldvs, double *work, const int *lwork,
+              int *bwork, int *info);
+  void dtrsen_(const char *job, const char *compq, const int *select,
+               const int *n, double *t, const int *ldt, double *q,
+               const int *ldq, double *wr, double *wi, int *m, double *s,
+               double *sep, double *work, const int *lwork, int *iwork,
+               const int *liwork, int *info);
+}
+
+namespace aureservoir
+{
+
+//! @name LAPACK routines for symmetric matrices
+//@{
+
+inline int potrf(DEMatrix<double>::Type &A)
+{
+  assert( A.numRows() == A.numCols() );
+
+  int n = A.numRows(), info = 0;
+  dpotrf_("L", &n, A.data(), &n, &info);
+  return info;
+}
+
+inline int potrf(DEMatrix<float>::Type &A)
+{
+  assert( A.numRows() == A.numCols() );
+
+  int n = A.numRows(), info = 0;
+  spotrf_("L", &n, A.data(), &n, &info);
+  return info;
+}
+
+inline int potrs(const DEMatrix<double>::Type &L, DEMatrix<double>::Type &B)
+{
+  assert( L.numRows() == B.numRows() );
+
+  int n = L.numRows(), nrhs = B.numCols(), info = 0;
+  dpotrs_("L", &n, &nrhs, L.data(), &n, B.data(), &n, &info);
+  return info;
+}
+
+inline int potrs(const DEMatrix<float>::Type &L, DEMatrix<float>::Type &B)
+{
+  assert( L.numRows() == B.numRows() );
+
+  int n = L.numRows(), nrhs = B.numCols(), info = 0;
+  spotrs_("L", &n, &nrhs, L.data(), &n, B.data(), &n, &info);
+  return info;
+}
+
+inline int syev(DEMatrix<double>::Type &A, DEVector<double>::Type &w)
+{
+  assert( A.numRows() == A.numCols() );
+
+  int n = A.numRows(), info = 0, lwork = -1;
+  double wsize;
+  w.resize(n);
+
+  // workspace query
+  dsyev_("V", "L", &n, A.data(), &n, w.data(), &wsize, &lwork, &info);
+  lwork = (int) wsize;
+  DEVector<double>::Type work(lwork);
+
+  dsyev_("V", "L", &n, A.data(), &n, w.data(), work.data(), &lwork, &info);
+  return info;
+}
+
+inline int syev(DEMatrix<float>::Type &A, DEVector<float>::Type &w)
+{
+  assert( A.numRows() == A.numCols() );
+
+  int n = A.numRows(), info = 0, lwork = -1;
+  float wsize;
+  w.resize(n);
+
+  // workspace query
+  ssyev_("V", "L", &n, A.data(), &n, w.data(), &wsize, &lwork, &info);
+  lwork = (int) wsize;
+  DEVector<float>::Type work(lwork);
+
+  ssyev_("V", "L", &n, A.data(), &n, w.data(), work.data(), &lwork, &info);
+  return info;
+}
+
+//@}
+//! @name LAPACK routines for singular value decompositions
+//@{
+
+inline int gesdd(DEMatrix<double>::Type &A, DEVector<double>::Type &s,
+                 DEMatrix<double>::Type &U, DEMatrix<double>::Type &VT)
+{
+  int m = A.numRows(), n = A.numCols(), k = std::min(m,n);
+  int info = 0, lwork = -1;
+  double wsize;
+  s.resize(k);
+  U.resize(m, k);
+  VT.resize(k, n);
+  std::vector<int> iwork(8*k);
+
+  // workspace query
+  dgesdd_("S", &m, &n, A.data(), &m, s.data(), U.data(), &m, VT.data(), &k,
+          &wsize, &lwork, &iwork[0], &info);
+  lwork = (int) wsize;
+  DEVector<double>::Type work(lwork);
+
+  dgesdd_("S", &m, &n, A.data(), &m, s.data(), U.data(), &m, VT.data(), &k,
+          work.data(), &lwork, &iwork[0], &info);
+  return info;
+}
+
+inline int gesdd(DEMatrix<float>::Type &A, DEVector<float>::Type &s,
+                 DEMatrix<float>::Type &U, DEMatrix<float>::Type &VT)
+{
+  int m = A.numRows(), n = A.numCols(), k = std::min(m,n);
+  int info = 0, lwork = -1;
+  float wsize;
+  s.resize(k);
+  U.resize(m, k);
+  VT.resize(k, n);
+  std::vector<int> iwork(8*k);
+
+  // workspace query
+  sgesdd_("S", &m, &n, A.data(), &m, s.data(), U.data(), &m, VT.data(), &k,
+          &wsize, &lwork, &iwork[0], &info);
+  lwork = (int) wsize;
+  DEVector<float>::Type work(lwork);
+
+  sgesdd_("S", &m, &n, A.data(), &m, s.data(), U.data(), &m, VT.data(), &k,
+          work.data(), &lwork, &iwork[0], &info);
+  return info;
+}
+
+//@}
+//! @name LAPACK routines for QR factorizations
+//@{
+
+inline int geqrf(DEMatrix<double>::Type &A, DEVector<double>::Type &tau)
+{
+  int m = A.numRows(), n = A.numCols(), info = 0, lwork = -1;
+  double wsize;
+  tau.resize( std::min(m,n) );
+
+  // workspace query
+  dgeqrf_(&m, &n, A.data(), &m, tau.data(), &wsize, &lwork, &info);
+  lwork = (int) wsize;
+  DEVector<double>::Type work(lwork);
+
+  dgeqrf_(&m, &n, A.data(), &m, tau.data(), work.data(), &lwork, &info);
+  return info;
+}
+
+inline int geqrf(DEMatrix<float>::Type &A, DEVector<float>::Type &tau)
+{
+  int m = A.numRows(), n = A.numCols(), info = 0, lwork = -1;
+  float wsize;
+  tau.resize( std::min(m,n) );
+
+  // workspace query
+  sgeqrf_(&m, &n, A.data(), &m, tau.data(), &wsize, &lwork, &info);
+  lwork = (int) wsize;
+  DEVector<float>::Type work(lwork);
+
+  sgeqrf_(&m, &n, A.data(), &m, tau.data(), work.data(), &lwork, &info);
+  return info;
+}
+
+inline int ormqr(const DEMatrix<double>::Type &A,
+                 const DEVector<double>::Type &tau,
+                 DEMatrix<double>::Type &C)
+{
+  assert( A.numRows() == C.numRows() );
+
+  int m = C.numRows(), n = C.numCols(), k = tau.length(),
+      lda = A.numRows(), info = 0, lwork = -1;
+  double wsize;
+
+  // workspace query
+  dormqr_("L", "T", &m, &n, &k, A.data(), &lda, tau.data(), C.data(), &m,
+          &wsize, &lwork, &info);
+  lwork = (int) wsize;
+  DEVector<double>::Type work(lwork);
+
+  dormqr_("L", "T", &m, &n, &k, A.data(), &lda, tau.data(), C.data(), &m,
+          work.data(), &lwork, &info);
+  return info;
+}
+
+inline int ormqr(const DEMatrix<float>::Type &A,
+                 const DEVector<float>::Type &tau,
+                 DEMatrix<float>::Type &C)
+{
+  assert( A.numRows() == C.numRows() );
+
+  int m = C.numRows(), n = C.numCols(), k = tau.length(),
+      lda = A.numRows(), info = 0, lwork = -1;
+  float wsize;
+
+  // workspace query
+  sormqr_("L", "T", &m, &n, &k, A.data(), &lda, tau.data(), C.data(), &m,
+          &wsize, &lwork, &info);
+  lwork = (int) wsize;
+  DEVector<float>::Type work(lwork);
+
+  sormqr_("L", "T", &m, &n, &k, A.data(), &lda, tau.data(), C.data(), &m,
+          work.data(), &lwork, &info);
+  return info;
+}
+
+//@}
+//! @name LAPACK routines for nonsymmetric eigenproblems
+//@{
+
+inline int gees(DEMatrix<double>::Type &A, DEVector<double>::Type &wr,
+                DEVector<double>::Type &wi, DEMatrix<double>::Type &Q)
+{
+  assert( A.numRows() == A.numCols() );
+
+  int n = A.numRows(), sdim = 0, info = 0, lwork = -1;
+  double wsize;
+  wr.resize(n);
+  wi.resize(n);
+  Q.resize(n,n);
+
+  // workspace query
+  dgees_("V", "N", 0, &n, A.data(), &n, &sdim, wr.data(), wi.data(),
+         Q.data(), &n, &wsize, &lwork, 0, &info);
+  lwork = (int) wsize;
+  DEVector<double>::Type work(lwork);
+
+  dgees_("V", "N", 0, &n, A.data(), &n, &sdim, wr.data(), wi.data(),
+         Q.data(), &n, work.data(), &lwork, 0, &info);
+  return info;
+}
+
+inline int trsen(const std::vector<int> &select, DEMatrix<double>::Type &T,
+                 DEMatrix<double>::Type &Q, DEVector<double>::Type &wr,
+                 DEVector<double>::Type &wi, int &m)
+{
+  assert( T.numRows() == T.numCols() );
+  assert( Q.numRows() == T.numRows() && Q.numCols() == T.numCols() );
+  assert( (int) select.size() == T.numRows() );
+
+  int n = T.numRows(), lwork = std::max(n,1), liwork = 1, iwork, info = 0;
+  double s, sep;
+  DEVector<double>::Type work(lwork);
+
+  dtrsen_("N", "V", &select[0], &n, T.data(), &n, Q.data(), &n, wr.data(),
+          wi.data(), &m, &s, &sep, work.data(), &lwork, &iwork, &liwork,
+          &info);
+  return info;
+}
+
+//@}
+//! @name BLAS routines for packed symmetric matrices, updates and products
+//@{
+
+inline void spmv(int n, double alpha, const double *Ap, const double *x,
+                 double beta, double *y)
+{ cblas_dspmv(CblasColMajor, CblasUpper, n, alpha, Ap, x, 1, beta, y, 1); }
+
+inline void spmv(int n, float alpha, const float *Ap, const float *x,
+                 float beta, float *y)
+{ cblas_sspmv(CblasColMajor, CblasUpper, n, alpha, Ap, x, 1, beta, y, 1); }
+
+inline void spr(int n, double alpha, const double *x, double *Ap)
+{ cblas_dspr(CblasColMajor, CblasUpper, n, alpha, x, 1, Ap); }
+
+inline void spr(int n, float alpha, const float *x, float *Ap)
+{ cblas_sspr(CblasColMajor, CblasUpper, n, alpha, x, 1, Ap); }
+
+inline void ger(int m, int n, double alpha, const double *x, const double *y,
+                double *A)
+{ cblas_dger(CblasColMajor, m, n, alpha, x, 1, y, 1, A, m); }
+
+inline void ger(int m, int n, float alpha, const float *x, const float *y,
+                float *A)
+{ cblas_sger(CblasColMajor, m, n, alpha, x, 1, y, 1, A, m); }
+
+inline void syrk(int n, int k, double alpha, const double *A, double beta,
+                 double *C)
+{ cblas_dsyrk(CblasColMajor, CblasLower, CblasTrans, n, k, alpha, A, k,
+              beta, C, n); }
+
+inline void gemm(bool transa, int m, int n, int k, double alpha,
+                 const double *A, const double *B, double beta, double *C)
+{
+  cblas_dgemm(CblasColMajor, transa ? CblasTrans : CblasNoTrans,
+              CblasNoTrans, m, n, k, alpha, A, transa ? k : m, B, k,
+              beta, C, m);
+}
+
+inline void scal(int n, double alpha, double *x)
+{ cblas_dscal(n, alpha, x, 1); }
+
+inline void scal(int n, float alpha, float *x)
+{ cblas_sscal(n, alpha, x, 1); }
+
+//@}
+
+} // end of namespace aureservoir
@@ -0,0 +1,186 @@
+/***************************************************************************/
+/*!
+ *  \file   modelfile.h
+ *
+ *  \brief  binary model files for saving and loading networks
+ *
+ *  \author Georg Holzmann, grh _at_ mur _dot_ at
+ *  \date   Oct 2026
+ *
+ *   ::::_aureservoir_::::
+ *   C++ library for analog reservoir computing neural networks
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ ***************************************************************************/
+
+#ifndef AURESERVOIR_MODELFILE_H__
+#define AURESERVOIR_MODELFILE_H__
+
+#include "auexcept.h"
+#include <fstream>
+#include <string>
+#include <map>
+#include <cstddef>
+#include <stdint.h>
+
+namespace aureservoir
+{
+
+/*!
+ * \enum ModelTag
+ *
+ * tags of the records in a model file
+ */
+enum ModelTag
+{
+  MODEL_INFO = 1,       //!< sizes and algorithms (int) \sa ESN::save
+  MODEL_SCALARS,        //!< noise and structured reservoir weights (double)
+  MODEL_PARAMS,         //!< pairs of InitParameter and value (double)
+  MODEL_W_PTR,          //!< CRS row pointers of the reservoir (int)
+  MODEL_W_COL,          //!< CRS column indices of the reservoir (int)
+  MODEL_W_VAL,          //!< CRS values of the reservoir
+  MODEL_CIRC_SPECTRUM,  //!< spectrum of a circulant reservoir (re,im pairs)
+  MODEL_WIN,            //!< input weights, column major
+  MODEL_WBACK,          //!< feedback weights, column major
+  MODEL_WOUT,           //!< output weights, column major
+  MODEL_X,              //!< reservoir state
+  MODEL_LAST_OUT,       //!< last output
+  MODEL_BP_F1,          //!< lowpass cutoff frequencies of SimBP
+  MODEL_BP_F2,          //!< highpass cutoff frequencies of SimBP
+  MODEL_IIR_SIZE,       //!< series, rows and columns of each IIR filter (int)
+  MODEL_IIR_B,          //!< numerator coefficients of all serial filters
+  MODEL_IIR_A,          //!< denominator coefficients of all serial filters
+  MODEL_DELAYS,         //!< delays of the delay&sum readout (int)
+  MODEL_RESERVOIR_DELAYS, //!< delays of the reservoir connections (int)
+  MODEL_TANH2           //!< slope and bias of tanh2 neurons (double)
+};
+
+/*!
+ * \class ModelWriter
+ *
+ * \brief writes a binary model file
+ *
+ * A model file starts with a header (magic "aures", format version and
+ * byte order mark), followed by records.
+ * Each record has a tag (\sa ModelTag), the size of one element in bytes
+ * and the nr of elements, the data is padded to a multiple of 8 bytes,
+ * so that all arrays are aligned if the file is mapped into memory.
+ * Records with unknown tags are skipped by the reader, so new records
+ * can be added without changing the format version.
+ */
+class ModelWriter
+{
+ public:
+
+  /// opens the file and writes the header
+  ModelWriter(const char *filename) throw(AUExcept);
+
+  /*!
+   * writes a record
+   * @param tag tag of the record
+   * @param data the elements
+   * @param count nr of elements
+   */
+  template <typename S>
+  void write(ModelTag tag, const S *data, size_t count) throw(AUExcept)
+  { writeRecord(tag, data, sizeof(S), count); }
+
+  /// closes the file and checks for write errors
+  void close() throw(AUExcept);
+
+ protected:
+
+  void writeRecord(ModelTag tag, const void *data, size_t size,
+                   size_t count) throw(AUExcept);
+
+  std::ofstream file_;
+  std::string filename_;
+};
+
+/*!
+ * \class ModelReader
+ *
+ * \brief reads a binary model file, which is mapped into memory
+ *
+ * The whole file is mapped read-only with mmap and only the record
+ * headers are parsed, the data of the records is used directly from
+ * the mapping (only copied once into the matrices of the network).
+ */
+class ModelReader
+{
+ public:
+
+  /// maps the file and reads the record headers
+  ModelReader(const char *filename) throw(AUExcept);
+
+  /// unmaps the file
+  ~ModelReader();
+
+  /// @return true if the file has a record with this tag
+  bool has(ModelTag tag) const
+  { return records_.find(tag) != records_.end(); }
+
+  /// @return nr of elements of a record (0 if it does not exist)
+  size_t count(ModelTag tag) const;
+
+  /*!
+   * @return pointer to the data of a record in the mapping
+   * @param tag tag of the record
+   * @param count expected nr of elements
+   */
+  template <typename S>
+  const S *data(ModelTag tag, size_t count) throw(AUExcept)
+  { return static_cast<const S*>( record(tag, sizeof(S), count) ); }
+
+  /*!
+   * copies floating point values of a record, which were saved in
+   * single or double precision
+   * @param tag tag of the record
+   * @param dest destination array
+   * @param count expected nr of elements
+   */
+  template <typename S>
+  void copy(ModelTag tag, S *dest, size_t count) throw(AUExcept);
+
+  /*!
+   * checks a record of floating point values (single or double
+   * precision) without reading it \sa copy
+   * @param tag tag of the record
+   * @param count expected nr of elements
+   */
+  void checkReal(ModelTag tag, size_t count) throw(AUExcept);
+
+ protected:
+
+  /// record in the mapping
+  struct Record
+  {
+    const char *data;
+    size_t size;
+    size_t count;
+  };
+
+  const void *record(ModelTag tag, size_t size, size_t count)
+    throw(AUExcept);
+
+  std::map<int, Record> records_;
+  std::string filename_;
+  void *map_;
+  size_t mapsize_;
+
+ private:
+
+  /// no copies of the mapping
+  ModelReader(const ModelReader &src);
+  const ModelReader &operator= (const ModelReader &src);
+};
+
+} // end of namespace aureservoir
+
+#include <aureservoir/modelfile.hpp>
+
+#endif // AURESERVOIR_MODELFILE_H__
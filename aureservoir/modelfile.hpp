@@ -0,0 +1,241 @@
+/***************************************************************************/
+/*!
+ *  \file   modelfile.hpp
+ *
+ *  \brief  binary model files for saving and loading networks
+ *
+ *  \author Georg Holzmann, grh _at_ mur _dot_ at
+ *  \date   Oct 2026
+ *
+ *   ::::_aureservoir_::::
+ *   C++ library for analog reservoir computing neural networks
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ ***************************************************************************/
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+namespace aureservoir
+{
+
+//! @name model file format
+//@{
+
+/// version of the model file format
+const uint32_t MODEL_FILE_VERSION = 1;
+
+/// header of a model file
+struct ModelFileHeader
+{
+  char magic[8];       ///< "aures" and zeros
+  uint32_t version;    ///< MODEL_FILE_VERSION
+  uint32_t byteorder;  ///< 0x01020304 in the byte order of the writer
+};
+
+/// header of a record, followed by the data padded to 8 bytes
+struct ModelRecordHeader
+{
+  uint32_t tag;        ///< \sa ModelTag
+  uint32_t size;       ///< size of one element in bytes
+  uint64_t count;      ///< nr of elements
+};
+
+//@}
+//! @name class ModelWriter Implementation
+//@{
+
+inline ModelWriter::ModelWriter(const char *filename)
+  throw(AUExcept)
+{
+  filename_ = filename;
+  file_.open(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+  if( !file_ )
+    throw AUExcept("ModelWriter: can't open file " + filename_);
+
+  ModelFileHeader header;
+  std::memset( &header, 0, sizeof(header) );
+  std::strcpy( header.magic, "aures" );
+  header.version = MODEL_FILE_VERSION;
+  header.byteorder = 0x01020304;
+  file_.write( reinterpret_cast<const char*>(&header), sizeof(header) );
+}
+
+inline void ModelWriter::writeRecord(ModelTag tag, const void *data,
+                                     size_t size, size_t count)
+  throw(AUExcept)
+{
+  ModelRecordHeader header;
+  header.tag = tag;
+  header.size = size;
+  header.count = count;
+  file_.write( reinterpret_cast<const char*>(&header), sizeof(header) );
+
+  size_t bytes = size*count;
+  file_.write( static_cast<const char*>(data), bytes );
+
+  static const char zeros[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+  if( bytes % 8 )
+    file_.write( zeros, 8 - bytes % 8 );
+
+  if( !file_ )
+    throw AUExcept("ModelWriter: can't write to file " + filename_);
+}
+
+inline void ModelWriter::close()
+  throw(AUExcept)
+{
+  file_.close();
+  if( !file_ )
+    throw AUExcept("ModelWriter: can't write to file " + filename_);
+}
+
+//@}
+//! @name class ModelReader Implementation
+//@{
+
+inline ModelReader::ModelReader(const char *filename)
+  throw(AUExcept)
+{
+  filename_ = filename;
+  map_ = 0;
+  mapsize_ = 0;
+
+  int fd = open(filename, O_RDONLY);
+  if( fd == -1 )
+  {
+    std::string str = "ModelReader: can't open file " + filename_;
+    str += ": "; str += strerror(errno);
+    throw AUExcept(str);
+  }
+
+  struct stat st;
+  if( fstat(fd, &st) == -1 || st.st_size < (off_t) sizeof(ModelFileHeader) )
+  {
+    ::close(fd);
+    throw AUExcept("ModelReader: " + filename_ + " is not a model file!");
+  }
+  mapsize_ = st.st_size;
+
+  void *data = mmap(0, mapsize_, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if( data == MAP_FAILED )
+  {
+    std::string str = "ModelReader: can't map file " + filename_;
+    str += ": "; str += strerror(errno);
+    throw AUExcept(str);
+  }
+  map_ = data;
+  madvise(map_, mapsize_, MADV_WILLNEED);
+
+  const char *pos = static_cast<const char*>(map_);
+  const char *end = pos + mapsize_;
+
+  const ModelFileHeader *header = reinterpret_cast<const ModelFileHeader*>(pos);
+  if( std::strncmp(header->magic, "aures", 8) != 0 )
+  {
+    munmap(map_, mapsize_);
+    throw AUExcept("ModelReader: " + filename_ + " is not a model file!");
+  }
+  if( header->byteorder != 0x01020304 )
+  {
+    munmap(map_, mapsize_);
+    throw AUExcept("ModelReader: " + filename_ + " was written with another byte order!");
+  }
+  if( header->version > MODEL_FILE_VERSION )
+  {
+    munmap(map_, mapsize_);
+    throw AUExcept("ModelReader: " + filename_ + " was written by a newer version!");
+  }
+  pos += sizeof(ModelFileHeader);
+
+  // index of all records
+  while( pos + sizeof(ModelRecordHeader) <= end )
+  {
+    const ModelRecordHeader *rec = reinterpret_cast<const ModelRecordHeader*>(pos);
+    pos += sizeof(ModelRecordHeader);
+
+    uint64_t bytes = (uint64_t) rec->size * rec->count;
+    uint64_t padded = (bytes + 7) / 8 * 8;
+    if( rec->size == 0 || padded > (uint64_t)(end - pos) )
+    {
+      munmap(map_, mapsize_);
+      throw AUExcept("ModelReader: " + filename_ + " is truncated!");
+    }
+
+    Record r = { pos, rec->size, (size_t) rec->count };
+    records_[rec->tag] = r;
+    pos += padded;
+  }
+}
+
+inline ModelReader::~ModelReader()
+{
+  if( map_ )
+    munmap(map_, mapsize_);
+}
+
+inline size_t ModelReader::count(ModelTag tag) const
+{
+  std::map<int, Record>::const_iterator it = records_.find(tag);
+  return ( it == records_.end() ) ? 0 : it->second.count;
+}
+
+inline const void *ModelReader::record(ModelTag tag, size_t size,
+                                       size_t count)
+  throw(AUExcept)
+{
+  std::map<int, Record>::const_iterator it = records_.find(tag);
+  if( it == records_.end() )
+    throw AUExcept("ModelReader: missing data in " + filename_);
+  if( it->second.size != size || it->second.count != count )
+    throw AUExcept("ModelReader: wrong data size in " + filename_);
+
+  return it->second.data;
+}
+
+inline void ModelReader::checkReal(ModelTag tag, size_t count)
+  throw(AUExcept)
+{
+  std::map<int, Record>::const_iterator it = records_.find(tag);
+  if( it == records_.end() )
+    throw AUExcept("ModelReader: missing data in " + filename_);
+  if( ( it->second.size != sizeof(float) &&
+        it->second.size != sizeof(double) ) || it->second.count != count )
+    throw AUExcept("ModelReader: wrong data size in " + filename_);
+}
+
+template <typename S>
+void ModelReader::copy(ModelTag tag, S *dest, size_t count)
+  throw(AUExcept)
+{
+  std::map<int, Record>::const_iterator it = records_.find(tag);
+  if( it == records_.end() )
+    throw AUExcept("ModelReader: missing data in " + filename_);
+
+  // values can be saved in single or double precision
+  if( it->second.size == sizeof(float) )
+  {
+    const float *src = data<float>(tag, count);
+    std::copy( src, src+count, dest );
+  }
+  else
+  {
+    const double *src = data<double>(tag, count);
+    std::copy( src, src+count, dest );
+  }
+}
+
+//@}
+
+} // end of namespace aureservoir
@@ -0,0 +1,765 @@
+/***************************************************************************/
+/*!
+ *  \file   search.h
+ *
+ *  \brief  parallel search of initialization and readout parameters
+ *
+ *  \author Georg Holzmann, grh _at_ mur _dot_ at
+ *  \date   Oct 2026
+ *
+ *   ::::_aureservoir_::::
+ *   C++ library for analog reservoir computing neural networks
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ ***************************************************************************/
+
+#ifndef AURESERVOIR_SEARCH_H__
+#define AURESERVOIR_SEARCH_H__
+
+#include "esn.h"
+#include "statefactorization.h"
+#include <sys/time.h>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <cstring>
+#include <stdint.h>
+
+namespace aureservoir
+{
+
+/*!
+ * \enum SearchMode
+ *
+ * how the parameter sets of a ParamSearch are chosen
+ */
+enum SearchMode
+{
+  SEARCH_GRID,          //!< all combinations of the parameter values
+  SEARCH_RANDOM,        //!< independent random samples
+  SEARCH_LATIN_HYPERCUBE //!< stratified random samples
+};
+
+/*!
+ * \class ParamSearch
+ *
+ * \brief parallel search of initialization and readout parameters
+ *
+ * Each dimension of the search is an InitParameter of the network with
+ * a list of values (setValues) or a range [min|max] (setRange).
+ * In SEARCH_GRID mode all combinations of the values are evaluated,
+ * in SEARCH_RANDOM and SEARCH_LATIN_HYPERCUBE mode the given nr of
+ * parameter sets is sampled (values of a list are chosen randomly,
+ * with the latin hypercube each dimension is split into trials strata
+ * and each stratum is used exactly once).
+ *
+ * Values of TIKHONOV_FACTOR are readout regularizations and are always
+ * used as a list, which is evaluated for each reservoir configuration.
+ * If the network has no output feedback, the states of each reservoir
+ * are collected and factorized only once and the readouts for all
+ * regularizations are solved from this factorization
+ * (\sa class StateFactorization), otherwise the network is trained
+ * with TRAIN_RIDGEREG for each regularization.
+ * Without TIKHONOV_FACTOR values the training algorithm of the network
+ * is used.
+ *
+ * The reservoir configurations are evaluated in parallel with OpenMP
+ * (dynamic scheduling, so that fast and slow configurations are
+ * balanced), the seed of configuration i is derived from the seed
+ * and i (\sa RandomStream::derive, getSeed), so that the results are
+ * reproducible and independent of the nr of threads. The readouts of
+ * one configuration are trained and tested on copies of the same
+ * network, so all regularizations see the same noise.
+ *
+ * Optionally each reservoir configuration is screened before the
+ * expensive state collection (\sa setScreening): the effective gain of
+ * the reservoir is estimated with a short power iteration, the
+ * saturation and the separation of the states are measured with a short
+ * probe input. Rejected configurations are not trained.
+ *
+ * Each trial is evaluated with the NRMSE of the simulated test signal,
+ * the results are stored in a table with one row per trial and the
+ * columns: parameter values (in the order of the dimensions),
+ * regularization, NRMSE, reservoir time (initialization and state
+ * collection in seconds, shared by all regularizations), readout time
+ * (training/solving and test simulation in seconds), effective
+ * gain, saturation and separation (these three are 0 without
+ * screening) and a rejected flag.
+ * A trial is rejected (flag 1, NRMSE infinite) if the screening fails
+ * or if the test output diverges (not finite), rejected trials are never
+ * the best trial. The flag does not depend on inf/NaN comparisons, which
+ * are not reliable with -ffast-math.
+ */
+template <typename T = float>
+class ParamSearch
+{
+ public:
+
+  /*!
+   * Constructor
+   * @param model network with all other settings, which is copied for
+   *              each trial
+   */
+  ParamSearch(const ESN<T> &model) : model_(model)
+  {
+    mode_ = SEARCH_GRID;
+    trials_ = 0;
+    seed_ = 0;
+    screen_steps_ = 0;
+    max_gain_ = max_saturation_ = min_separation_ = 0;
+  }
+
+  /// Destructor
+  ~ParamSearch() {}
+
+  /*!
+   * adds a dimension with a list of values
+   * @param key initialization parameter of this dimension
+   * @param values possible values of the parameter
+   */
+  void setValues(InitParameter key, const std::vector<T> &values)
+    throw(AUExcept)
+  {
+    if( values.empty() )
+      throw AUExcept("ParamSearch::setValues: no values!");
+
+    if( key == TIKHONOV_FACTOR )
+    {
+      regs_ = values;
+      return;
+    }
+
+    Dimension d = { key, values, 0, 0 };
+    setDimension(d);
+  }
+
+  /*!
+   * C-style interface for setValues
+   * @param key initialization parameter of this dimension
+   * @param invec possible values of the parameter
+   */
+  void setValues(InitParameter key, T *invec, int insize)
+    throw(AUExcept)
+  {
+    setValues( key, std::vector<T>(invec, invec+insize) );
+  }
+
+  /*!
+   * adds a dimension with a range of values, only possible for
+   * SEARCH_RANDOM and SEARCH_LATIN_HYPERCUBE
+   * @param key initialization parameter of this dimension
+   * @param min minimum value
+   * @param max maximum value
+   */
+  void setRange(InitParameter key, T min, T max)
+    throw(AUExcept)
+  {
+    if( key == TIKHONOV_FACTOR )
+      throw AUExcept("ParamSearch::setRange: TIKHONOV_FACTOR needs a list of values!");
+    if( max < min )
+      throw AUExcept("ParamSearch::setRange: max must be >= min!");
+
+    Dimension d = { key, std::vector<T>(), min, max };
+    setDimension(d);
+  }
+
+  /*!
+   * sets how the parameter sets are chosen
+   * @param mode the search mode
+   * @param trials nr of sampled reservoir configurations
+   *               (not used for SEARCH_GRID)
+   */
+  void setMode(SearchMode mode, int trials=0)
+    throw(AUExcept)
+  {
+    if( mode != SEARCH_GRID && trials < 1 )
+      throw AUExcept("ParamSearch::setMode: at least one trial is needed!");
+
+    mode_ = mode;
+    trials_ = trials;
+  }
+
+  /*!
+   * enables the screening of reservoir configurations, a configuration
+   * is rejected before training if one of the thresholds fails
+   *
+   * @param maxgain maximum effective gain of the reservoir, estimated with
+   *                a short power iteration of W (or (1-a)*I + a*W with
+   *                the leaking rate a for SIM_LI)
+   * @param maxsaturation maximum fraction of saturated states for the
+   *                      probe input (|x| > 0.95 for tanh, x < 0.05 or
+   *                      x > 0.95 for sigmoid neurons)
+   * @param minseparation minimum relative distance of the states driven
+   *                      by the probe input and the reversed probe input
+   * @param steps length of the probe input (the first timesteps of the
+   *              training input), 0 disables the screening
+   */
+  void setScreening(T maxgain, T maxsaturation, T minseparation,
+                    int steps=100)
+    throw(AUExcept)
+  {
+    if( steps < 0 )
+      throw AUExcept("ParamSearch::setScreening: steps must be >= 0!");
+
+    max_gain_ = maxgain;
+    max_saturation_ = maxsaturation;
+    min_separation_ = minseparation;
+    screen_steps_ = steps;
+  }
+
+  /// set the seed of the sampling and of the configurations \sa run
+  void setSeed(unsigned long long seed) { seed_ = seed; }
+
+  /*!
+   * evaluates all trials
+   *
+   * @param in matrix of training input values (inputs x timesteps)
+   * @param out matrix of desired training outputs (outputs x timesteps)
+   * @param washout washout time in samples for training and test
+   * @param testin matrix of test input values (inputs x timesteps)
+   * @param testout matrix of desired test outputs (outputs x timesteps)
+   */
+  void run(const typename ESN<T>::DEMatrix &in,
+           const typename ESN<T>::DEMatrix &out, int washout,
+           const typename ESN<T>::DEMatrix &testin,
+           const typename ESN<T>::DEMatrix &testout)
+    throw(AUExcept)
+  {
+    if( testin.numCols() != testout.numCols() ||
+        testout.numRows() != model_.getOutputs() )
+      throw AUExcept("ParamSearch::run: wrong size of test data!");
+    if( washout < 0 || washout >= testout.numCols() )
+      throw AUExcept("ParamSearch::run: washout must be smaller than the test data!");
+
+    std::vector< std::vector<T> > configs;
+    sampleConfigs(configs);
+
+    std::vector<T> regs = regs_;
+    bool ridge = !regs.empty();
+    if( !ridge )
+      regs.push_back(0);
+
+    int nreg = regs.size();
+    int ndim = dims_.size();
+    results_.resize( configs.size()*nreg );
+    std::string error;
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int c=0; c<(int)configs.size(); ++c)
+    {
+      set_denormal_flags();
+      try
+      {
+        double start = seconds();
+
+        unsigned long long seed = RandomStream::derive(seed_, c);
+
+        ESN<T> net(model_);
+        for(int d=0; d<ndim; ++d)
+          net.setInitParam(dims_[d].key, configs[c][d]);
+        net.setSeed(seed);
+        net.init();
+
+        // reject bad reservoirs before the state collection
+        T screen[3] = { 0, 0, 0 };
+        bool rejected = false;
+        if( screen_steps_ > 0 )
+        {
+          screenReservoir(net, in, seed, screen);
+          rejected = ( !isFinite(screen[0]) || !isFinite(screen[1]) ||
+                       !isFinite(screen[2]) || screen[0] > max_gain_ ||
+                       screen[1] > max_saturation_ ||
+                       screen[2] < min_separation_ );
+        }
+        if( rejected )
+        {
+          double restime = seconds() - start;
+          for(int r=0; r<nreg; ++r)
+          {
+            Result &res = results_[c*nreg+r];
+            res.params = configs[c];
+            res.reg = regs[r];
+            res.nrmse = std::numeric_limits<T>::infinity();
+            res.rejected = true;
+            res.restime = restime;
+            res.readtime = 0;
+            res.seed = seed;
+            std::copy( screen, screen+3, res.screen );
+          }
+          continue;
+        }
+
+        // collect and factorize the states once for all regularizations
+        bool shared = ridge && canFactorize(net);
+        StateFactorization<T> states(net);
+        if( shared )
+          states.factorize(in, washout);
+        double restime = seconds() - start;
+
+        for(int r=0; r<nreg; ++r)
+        {
+          start = seconds();
+
+          // each regularization starts from the same network, with the
+          // same random numbers
+          ESN<T> trial(net);
+          if( shared )
+          {
+            typename ESN<T>::DEMatrix W;
+            states.solve(out, W, regs[r]);
+            trial.setWout(W);
+          }
+          else
+          {
+            if( ridge )
+            {
+              trial.setTrainAlgorithm(TRAIN_RIDGEREG);
+              trial.setInitParam(TIKHONOV_FACTOR, regs[r]);
+            }
+            trial.train(in, out, washout);
+          }
+
+          typename ESN<T>::DEMatrix simout(testout.numRows(), testout.numCols());
+          trial.simulate(testin, simout);
+
+          Result &res = results_[c*nreg+r];
+          res.params = configs[c];
+          res.reg = regs[r];
+          res.nrmse = nrmse(simout, testout, washout);
+          res.rejected = !isFinite(res.nrmse);
+          if( res.rejected )
+            res.nrmse = std::numeric_limits<T>::infinity();
+          res.restime = restime;
+          res.readtime = seconds() - start;
+          res.seed = seed;
+          std::copy( screen, screen+3, res.screen );
+        }
+      }
+      catch(AUExcept &e)
+      {
+        #pragma omp critical (paramsearch_error)
+        {
+          if( error.empty() )
+            error = e.what();
+        }
+      }
+    }
+
+    if( !error.empty() )
+    {
+      results_.clear();
+      throw AUExcept(error);
+    }
+  }
+
+  /*!
+   * C-style interface for run
+   * (data will be copied into FLENS matrices)
+   */
+  void run(T *inmtx, int inrows, int incols,
+           T *outmtx, int outrows, int outcols, int washout,
+           T *amtx, int arows, int acols,
+           T *bmtx, int brows, int bcols)
+    throw(AUExcept)
+  {
+    typename ESN<T>::DEMatrix flin(inrows,incols), flout(outrows,outcols);
+    typename ESN<T>::DEMatrix fltin(arows,acols), fltout(brows,bcols);
+
+    // copy data to FLENS matrix (column major storage)
+    for(int i=0; i<inrows; ++i) {
+    for(int j=0; j<incols; ++j) {
+      flin(i+1,j+1) = inmtx[i*incols+j];
+    } }
+    for(int i=0; i<outrows; ++i) {
+    for(int j=0; j<outcols; ++j) {
+      flout(i+1,j+1) = outmtx[i*outcols+j];
+    } }
+    for(int i=0; i<arows; ++i) {
+    for(int j=0; j<acols; ++j) {
+      fltin(i+1,j+1) = amtx[i*acols+j];
+    } }
+    for(int i=0; i<brows; ++i) {
+    for(int j=0; j<bcols; ++j) {
+      fltout(i+1,j+1) = bmtx[i*bcols+j];
+    } }
+
+    run(flin, flout, washout, fltin, fltout);
+  }
+
+  /// @return nr of evaluated trials (rows of the result table)
+  int getNrResults() const { return results_.size(); }
+
+  /// @return nr of columns of the result table
+  int getNrColumns() const { return dims_.size() + 8; }
+
+  /*!
+   * @param trial row of the result table
+   * @return seed of the network of this trial, a network with the
+   *         parameters of the trial and this seed gives the same results
+   *         (the seed is not part of the result table, because it is not
+   *         exact as a float)
+   */
+  unsigned long long getSeed(int trial) const
+    throw(AUExcept)
+  {
+    if( trial < 0 || trial >= getNrResults() )
+      throw AUExcept("ParamSearch::getSeed: no such trial!");
+
+    return results_[trial].seed;
+  }
+
+  /*!
+   * copies the result table, one row per trial \sa class ParamSearch
+   * @param wmtx result table in row major storage
+   *             (getNrResults() x getNrColumns())
+   */
+  void getResults(T *wmtx, int wrows, int wcols)
+    throw(AUExcept)
+  {
+    if( wrows != getNrResults() || wcols != getNrColumns() )
+      throw AUExcept("ParamSearch::getResults: wrong size of result matrix!");
+
+    int ndim = dims_.size();
+    for(int i=0; i<wrows; ++i)
+    {
+      T *row = wmtx + i*wcols;
+      const Result &res = results_[i];
+      std::copy( res.params.begin(), res.params.end(), row );
+      row[ndim] = res.reg;
+      row[ndim+1] = res.nrmse;
+      row[ndim+2] = res.restime;
+      row[ndim+3] = res.readtime;
+      std::copy( res.screen, res.screen+3, row+ndim+4 );
+      row[ndim+7] = res.rejected ? 1 : 0;
+    }
+  }
+
+  /// @return index of the trial with the smallest NRMSE,
+  ///         rejected trials are skipped
+  int getBest() const
+    throw(AUExcept)
+  {
+    if( results_.empty() )
+      throw AUExcept("ParamSearch::getBest: no results, run the search first!");
+
+    int best = -1;
+    for(int i=0; i<(int)results_.size(); ++i)
+    {
+      if( results_[i].rejected )
+        continue;
+      if( best < 0 || results_[i].nrmse < results_[best].nrmse )
+        best = i;
+    }
+    if( best < 0 )
+      throw AUExcept("ParamSearch::getBest: all trials were rejected!");
+    return best;
+  }
+
+  /// prints out the result table
+  void printResults()
+  {
+    std::cout << "trial";
+    for(unsigned d=0; d<dims_.size(); ++d)
+      std::cout << "\tparam" << dims_[d].key;
+    std::cout << "\ttikhonov\tnrmse\treservoir[s]\treadout[s]\tseed"
+              << "\tgain\tsaturation\tseparation\trejected\n";
+
+    for(unsigned i=0; i<results_.size(); ++i)
+    {
+      const Result &res = results_[i];
+      std::cout << i;
+      for(unsigned d=0; d<res.params.size(); ++d)
+        std::cout << "\t" << res.params[d];
+      std::cout << "\t" << res.reg << "\t" << res.nrmse
+                << "\t" << res.restime << "\t" << res.readtime
+                << "\t" << res.seed << "\t" << res.screen[0]
+                << "\t" << res.screen[1] << "\t" << res.screen[2]
+                << "\t" << res.rejected << "\n";
+    }
+  }
+
+ protected:
+
+  /// one dimension of the search, a list of values or a range
+  struct Dimension
+  {
+    InitParameter key;
+    std::vector<T> values;
+    T min, max;
+  };
+
+  /// result of one trial
+  struct Result
+  {
+    std::vector<T> params;
+    T reg, nrmse;
+    /// screening failed or the output diverged
+    bool rejected;
+    double restime, readtime;
+    unsigned long long seed;
+    /// effective gain, saturation and separation
+    T screen[3];
+  };
+
+  /// adds or replaces a dimension
+  void setDimension(const Dimension &d)
+  {
+    for(unsigned i=0; i<dims_.size(); ++i)
+    {
+      if( dims_[i].key == d.key )
+      {
+        dims_[i] = d;
+        return;
+      }
+    }
+    dims_.push_back(d);
+  }
+
+  /// @return parameter values of all reservoir configurations
+  void sampleConfigs(std::vector< std::vector<T> > &configs)
+    throw(AUExcept)
+  {
+    int ndim = dims_.size();
+    configs.clear();
+
+    if( mode_ == SEARCH_GRID )
+    {
+      // all combinations, the last dimension changes fastest
+      int trials = 1;
+      for(int d=0; d<ndim; ++d)
+      {
+        if( dims_[d].values.empty() )
+          throw AUExcept("ParamSearch::run: SEARCH_GRID needs lists of values!");
+        trials *= dims_[d].values.size();
+      }
+
+      configs.resize(trials, std::vector<T>(ndim));
+      for(int t=0; t<trials; ++t)
+      {
+        int rest = t;
+        for(int d=ndim-1; d>=0; --d)
+        {
+          int size = dims_[d].values.size();
+          configs[t][d] = dims_[d].values[rest % size];
+          rest /= size;
+        }
+      }
+      return;
+    }
+
+    RandomStream rand(seed_);
+    configs.resize(trials_, std::vector<T>(ndim));
+    std::vector<int> perm(trials_);
+
+    for(int d=0; d<ndim; ++d)
+    {
+      // random permutation of the strata
+      for(int t=0; t<trials_; ++t)
+        perm[t] = t;
+      for(int t=trials_-1; t>0; --t)
+        std::swap( perm[t], perm[ rand.index(t+1) ] );
+
+      for(int t=0; t<trials_; ++t)
+      {
+        // position within [0|1)
+        double u = rand.uniform(0, 1);
+        if( mode_ == SEARCH_LATIN_HYPERCUBE )
+          u = (perm[t] + u) / trials_;
+
+        const Dimension &dim = dims_[d];
+        if( dim.values.empty() )
+          configs[t][d] = dim.min + u*(dim.max - dim.min);
+        else
+          configs[t][d] = dim.values[ (size_t)(u*dim.values.size()) ];
+      }
+    }
+  }
+
+  /*!
+   * calculates the screening values of a reservoir
+   * @param net initialized network, which is not changed
+   * @param in training input, the probe input are the first timesteps
+   * @param seed seed for the start vector of the power iteration
+   * @param screen effective gain, saturation and separation
+   */
+  void screenReservoir(ESN<T> &net, const typename ESN<T>::DEMatrix &in,
+                       unsigned long long seed, T screen[3])
+    throw(AUExcept)
+  {
+    int n = net.getSize();
+
+    // effective gain: geometric mean of the growth in the second half
+    // of a short power iteration, the product uses the same kernel as
+    // the simulation, so cycle and circulant reservoirs are never built
+    // as a sparse matrix
+    T leak = 1;
+    if( net.getSimAlgorithm() == SIM_LI )
+      leak = net.getInitParam(LEAKING_RATE);
+    typename ESN<T>::DEVector v(n), w(n);
+    RandomStream rand(seed);
+    rand.uniform(v);
+    double loggain = 0;
+    for(int k=1; k<=POWER_ITERATIONS; ++k)
+    {
+      double nv = norm(v);
+      if( nv == 0 )
+      {
+        loggain = -std::numeric_limits<double>::infinity();
+        break;
+      }
+      v *= T(1./nv);
+      net.sim_->reservoirProduct(v, w);
+      if( leak != 1 )
+      {
+        w *= leak;
+        w += T(1.-leak) * v;
+      }
+      if( k > POWER_ITERATIONS/2 )
+        loggain += std::log( norm(w) );
+      v = w;
+    }
+    screen[0] = std::exp( loggain / (POWER_ITERATIONS - POWER_ITERATIONS/2) );
+
+    // states for the probe input and the reversed probe input
+    int steps = std::min(screen_steps_, in.numCols());
+    typename ESN<T>::DEMatrix probe(in.numRows(), steps);
+    typename ESN<T>::DEMatrix X1(steps, n), X2(steps, n);
+    ESN<T> tmp(net);
+    probe = in(_,_(1,steps));
+    tmp.collectStates(probe, X1);
+    for(int j=1; j<=steps; ++j)
+      probe(_,j) = in(_,steps+1-j);
+    tmp.resetState();
+    tmp.collectStates(probe, X2);
+
+    // fraction of saturated states
+    const T *x1 = X1.data();
+    const T *x2 = X2.data();
+    int size = steps*n;
+    int saturated = 0;
+    ActivationFunction act = net.getReservoirAct();
+    for(int i=0; i<size; ++i)
+    {
+      if( ( act == ACT_TANH || act == ACT_TANH2 ) && std::abs(x1[i]) > 0.95 )
+        ++saturated;
+      else if( act == ACT_SIGMOID && ( x1[i] < 0.05 || x1[i] > 0.95 ) )
+        ++saturated;
+    }
+    screen[1] = T(saturated) / size;
+
+    // relative distance of the states in the second half of the probe
+    double dist = 0, mag = 0;
+    for(int j=0; j<n; ++j)
+    {
+      for(int t=steps/2; t<steps; ++t)
+      {
+        T a = x1[j*steps+t], b = x2[j*steps+t];
+        dist += (a-b)*(a-b);
+        mag += 0.5*(a*a + b*b);
+      }
+    }
+    screen[2] = (mag > 0) ? std::sqrt(dist/mag) : 0;
+  }
+
+  /// @return euclidean norm of a vector
+  static double norm(const typename ESN<T>::DEVector &v)
+  {
+    double sum = 0;
+    for(int i=0; i<v.length(); ++i)
+      sum += v.data()[i]*v.data()[i];
+    return std::sqrt(sum);
+  }
+
+  /// nr of power iterations for the effective gain in screenReservoir()
+  enum { POWER_ITERATIONS = 20 };
+
+  /// @return true if the states of the network can be factorized
+  static bool canFactorize(ESN<T> &net)
+  {
+    if( net.getSimAlgorithm() == SIM_FILTER_DS )
+      return false;
+
+    const typename ESN<T>::DEMatrix &Wback = net.getWback();
+    const T *data = Wback.data();
+    int size = Wback.numRows()*Wback.numCols();
+    for(int j=0; j<size; ++j)
+      if( data[j] != 0 )
+        return false;
+    return true;
+  }
+
+  /*!
+   * @return true if x is finite, from the bit pattern, so that it also
+   *         works with -ffast-math
+   */
+  static bool isFinite(double x)
+  {
+    uint64_t bits;
+    std::memcpy( &bits, &x, sizeof(bits) );
+    return ( bits & 0x7FF0000000000000ULL ) != 0x7FF0000000000000ULL;
+  }
+
+  /// @return NRMSE of all outputs after the washout
+  static T nrmse(const typename ESN<T>::DEMatrix &sim,
+                 const typename ESN<T>::DEMatrix &target, int washout)
+  {
+    int size = target.numRows() * (target.numCols()-washout);
+    const T *s = sim.data() + target.numRows()*washout;
+    const T *t = target.data() + target.numRows()*washout;
+
+    double mean = 0;
+    for(int i=0; i<size; ++i)
+      mean += t[i];
+    mean /= size;
+
+    double err = 0, var = 0;
+    for(int i=0; i<size; ++i)
+    {
+      err += (s[i]-t[i])*(s[i]-t[i]);
+      var += (t[i]-mean)*(t[i]-mean);
+    }
+    if( !isFinite(err) )
+      return std::numeric_limits<T>::infinity();
+    return (var > 0) ? std::sqrt(err/var) : std::sqrt(err/size);
+  }
+
+  /// @return wall clock time in seconds
+  static double seconds()
+  {
+    struct timeval tv;
+    gettimeofday(&tv, 0);
+    return tv.tv_sec + 1e-6*tv.tv_usec;
+  }
+
+  /// network with all other settings
+  ESN<T> model_;
+
+  /// dimensions of the search
+  std::vector<Dimension> dims_;
+  /// readout regularizations (TIKHONOV_FACTOR values)
+  std::vector<T> regs_;
+
+  SearchMode mode_;
+  /// nr of sampled configurations for random modes
+  int trials_;
+  /// seed of the sampling and of the first configuration
+  unsigned long long seed_;
+
+  /// result table
+  std::vector<Result> results_;
+
+  /// length of the probe input for the screening, 0 = no screening
+  int screen_steps_;
+  /// screening thresholds
+  T max_gain_, max_saturation_, min_separation_;
+};
+
+} // end of namespace aureservoir
+
+#endif // AURESERVOIR_SEARCH_H__
@@ -23,6 +23,8 @@
 #include "utilities.h"
 #include "filter.h"
 #include "delaysum.h"
+#include "linalg.h"
+#include "modelfile.h"
 #include <vector>
 
 namespace aureservoir
@@ -49,6 +51,7 @@ template <typename T> class ESN;
 template <typename T> class SimFilterDS;
 template <typename T> class SimSquare;
 template <typename T> class SimFilter2;
+template <typename T> class ParamSearch;
 
 /*!
  * \class SimBase
@@ -73,6 +76,7 @@ class SimBase
   friend class SimFilterDS<T>;
   friend class SimSquare<T>;
   friend class SimFilter2<T>;
+  friend class ParamSearch<T>;
 
  public:
 
@@ -98,6 +102,52 @@ class SimBase
   /// reallocates data buffers
   virtual void reallocate();
 
+  /*!
+   * enables the NLMS adaptation of the output weights inside the
+   * simulation loop of SimStd and SimFilter, \sa class TrainNLMS
+   * @param target pointer to the desired outputs of the next simulate()
+   *               call in column major storage (outputs x timesteps),
+   *               0 disables the adaptation
+   * @param mu normalized learnrate
+   * \sa class AdaptTargetGuard
+   */
+  void setAdaptTarget(const T *target, T mu=0.)
+  { target_ = target; mu_ = mu; }
+
+  /*!
+   * builds a compressed (CRS) copy of the output weights with only the
+   * nonzero taps, which is used instead of the dense readout if at most
+   * half of the weights are nonzero (e.g. after TrainLasso).
+   * With SimFilterDS also the delaylines of zero weights are skipped.
+   * \attention must be called each time after Wout_ was changed,
+   *            this is done in ESN::train and ESN::setWout
+   * \note not available for SimSquare
+   */
+  void compressReadout();
+
+  /// disables the compressed readout, e.g. during online training
+  virtual void clearReadout() { sparse_readout_ = false; }
+
+  //! @name model files \sa ESN::save
+  //@{
+  /// writes the filter coefficients and delays of the algorithm
+  virtual void save(ModelWriter &file) throw(AUExcept) {}
+  /// reads the filter coefficients and delays of the algorithm,
+  /// must be called after the weight matrices are loaded
+  virtual void load(ModelReader &file) throw(AUExcept) {}
+  /*!
+   * checks the filter coefficients and delays in a model file,
+   * before the network is changed
+   * @param file the model file
+   * @param neurons nr of neurons of the saved network
+   * @param inputs nr of inputs of the saved network
+   * @param outputs nr of outputs of the saved network
+   * @param nnz nr of nonzero reservoir connections of the saved network
+   */
+  static void check(ModelReader &file, int neurons, int inputs,
+                    int outputs, size_t nnz) throw(AUExcept);
+  //@}
+
   //! @name additional interface for filter neurons and delay&sum readout
   //@{
   virtual void setBPCutoffConst(T f1, T f2) throw(AUExcept);
@@ -124,8 +174,82 @@ class SimBase
 
  protected:
 
+  /*!
+   * NLMS update of the output weights with the a priori error,
+   * must be called after Wout*[x;in] is in last_out_ and before the
+   * output activation function
+   * @param in input values of this timestep (size = inputs)
+   * @param target desired output values of this timestep (size = outputs)
+   */
+  inline void adaptReadout(const T *in, const T *target);
+
+  /*!
+   * output = Wout * [x; in] with the compressed readout
+   * @param x reservoir states (size = neurons)
+   * @param in input values of this timestep (size = inputs)
+   * @param y output before the output activation function (size = outputs)
+   */
+  inline void sparseReadout(const T *x, const T *in, T *y);
+
+  /*!
+   * y = W * x (or y += W * x) with the reservoir weight matrix, for
+   * structured reservoirs (\sa class InitCycle) with a O(neurons) kernel
+   * and for circulant reservoirs (\sa class InitCirculant) with FFTs
+   * instead of the sparse matrix-vector product
+   * @param x reservoir states (size = neurons)
+   * @param y result (size = neurons), must be another vector than x
+   * @param add if true the product is added to y
+   */
+  inline void reservoirProduct(const typename ESN<T>::DEVector &x,
+                               typename ESN<T>::DEVector &y,
+                               bool add=false);
+
   /// reference to the data of the network
   ESN<T> *esn_;
+
+  /// desired outputs for readout adaptation, 0 if not used
+  const T *target_;
+  /// normalized learnrate for readout adaptation
+  T mu_;
+  /// error vector for readout adaptation
+  typename ESN<T>::DEVector e_;
+
+  /// true if the compressed readout is used
+  bool sparse_readout_;
+  /// row pointers of the compressed readout (size = outputs+1)
+  std::vector<int> rout_ptr_;
+  /// column indices of the compressed readout, index into [x; in]
+  /// starting from 0
+  std::vector<int> rout_col_;
+  /// nonzero output weights of the compressed readout
+  std::vector<T> rout_val_;
+
+  /// FFT buffer for the product with a circulant reservoir
+  typename CDEVector<T>::Type circ_buf_;
+};
+
+/*!
+ * \class AdaptTargetGuard
+ *
+ * \brief clears the adaptation target of a simulation algorithm when
+ *        it goes out of scope
+ *
+ * The target set with SimBase::setAdaptTarget points into data of the
+ * caller, the guard makes sure that it is also reset if the simulation
+ * throws an exception, so no dangling pointer is left in the algorithm.
+ */
+template <typename T>
+class AdaptTargetGuard
+{
+ public:
+  AdaptTargetGuard(SimBase<T> *sim) : sim_(sim) {}
+  ~AdaptTargetGuard() { sim_->setAdaptTarget(0); }
+
+ private:
+  AdaptTargetGuard(const AdaptTargetGuard<T> &src);
+  const AdaptTargetGuard &operator= (const AdaptTargetGuard<T> &src);
+
+  SimBase<T> *sim_;
 };
 
 /*!
@@ -138,6 +262,9 @@ class SimBase
  * Jaeger's "Tutorial on training recurrent neural networks"
  * \sa http://www.faculty.iu-bremen.de/hjaeger/pubs/ESNTutorial.pdf
  *
+ * The output weights can be adapted inside the simulation loop
+ * \sa class TrainNLMS
+ *
  * \example "slow_sine.py"
  * \example "narma10.py"
  */
@@ -147,6 +274,7 @@ class SimStd : public SimBase<T>
   using SimBase<T>::esn_;
   using SimBase<T>::last_out_;
   using SimBase<T>::t_;
+  using SimBase<T>::target_;
 
  public:
   SimStd(ESN<T> *esn) : SimBase<T>(esn) {}
@@ -272,6 +400,11 @@ class SimBP : public SimBase<T>
   virtual void simulate(const typename ESN<T>::DEMatrix &in,
                         typename ESN<T>::DEMatrix &out);
 
+  /// writes the cutoff frequencies
+  virtual void save(ModelWriter &file) throw(AUExcept);
+  /// reads the cutoff frequencies
+  virtual void load(ModelReader &file) throw(AUExcept);
+
   /// the filter object
   BPFilter<T> filter_;
 };
@@ -299,6 +432,9 @@ class SimBP : public SimBase<T>
  * The filter is always calculated _after_ the nonlinearity.
  * \sa class IIRFilter
  *
+ * The output weights can be adapted inside the simulation loop
+ * \sa class TrainNLMS
+ *
  * See "Echo State Networks with Filter Neurons and a Delay&Sum Readout"
  * (Georg Holzmann, 2008).
  * \sa http://grh.mur.at/misc/ESNsWithFilterNeuronsAndDSReadout.pdf
@@ -314,6 +450,7 @@ class SimFilter : public SimBase<T>
   using SimBase<T>::esn_;
   using SimBase<T>::last_out_;
   using SimBase<T>::t_;
+  using SimBase<T>::target_;
 
  public:
   SimFilter(ESN<T> *esn) : SimBase<T>(esn) {}
@@ -349,6 +486,11 @@ class SimFilter : public SimBase<T>
   virtual void simulate(const typename ESN<T>::DEMatrix &in,
                         typename ESN<T>::DEMatrix &out);
 
+  /// writes the filter coefficients
+  virtual void save(ModelWriter &file) throw(AUExcept);
+  /// reads the filter coefficients
+  virtual void load(ModelReader &file) throw(AUExcept);
+
   /// the filter object
   SerialIIRFilter<T> filter_;
 };
@@ -481,8 +623,26 @@ class SimFilterDS : public SimFilter<T>
   virtual void simulate(const typename ESN<T>::DEMatrix &in,
                         typename ESN<T>::DEMatrix &out);
 
+  /// writes the filter coefficients, readout and reservoir delays
+  virtual void save(ModelWriter &file) throw(AUExcept);
+  /// reads the filter coefficients, readout and reservoir delays,
+  /// the delay lines start with zeros
+  virtual void load(ModelReader &file) throw(AUExcept);
+
+  /// disables the compressed readout, the skipped delaylines of zero
+  /// weights are cleared, so that they do not replay stale samples
+  virtual void clearReadout();
+
  protected:
 
+  /*!
+   * delay&sum readout with the compressed readout weights, delaylines
+   * of zero weights are skipped \sa SimBase::compressReadout
+   * @param in input matrix
+   * @param n current timestep (column of in)
+   */
+  void sparseDelayReadout(const typename ESN<T>::DEMatrix &in, int n);
+
   /// sparse (matrix+delays)*vector multiplication
   void mvdel(const typename ESN<T>::SPMatrix &AA,
              const typename ESN<T>::DEVector &xx,
@@ -29,6 +29,9 @@ template <typename T>
 SimBase<T>::SimBase(ESN<T> *esn)
 {
   esn_=esn;
+  target_=0;
+  mu_=0.;
+  sparse_readout_=false;
   reallocate();
 }
 
@@ -37,6 +40,169 @@ void SimBase<T>::reallocate()
 {
   last_out_.resize(esn_->outputs_, 1);
   t_.resize(esn_->neurons_);
+  e_.resize(esn_->outputs_);
+}
+
+template <typename T>
+inline void SimBase<T>::adaptReadout(const T *in, const T *target)
+{
+  int neurons = esn_->neurons_;
+  int inputs = esn_->inputs_;
+  int outputs = esn_->outputs_;
+  const T *x = esn_->x_.data();
+
+  // squared norm of [x; in]
+  T norm = std::numeric_limits<T>::epsilon();
+  for(int i=0; i<neurons; ++i)
+    norm += x[i]*x[i];
+  for(int i=0; i<inputs; ++i)
+    norm += in[i]*in[i];
+
+  // a priori error before the output activation function
+  std::copy( target, target+outputs, e_.data() );
+  esn_->outputInvAct_( e_.data(), outputs );
+  for(int i=1; i<=outputs; ++i)
+    e_(i) = (mu_/norm) * ( e_(i) - last_out_(i,1) );
+
+  // Wout = Wout + mu/norm * e * [x; in].T
+  ger( outputs, neurons, (T) 1., e_.data(), x, esn_->Wout_.data() );
+  ger( outputs, inputs, (T) 1., e_.data(), in,
+       esn_->Wout_.data() + outputs*neurons );
+}
+
+template <typename T>
+void SimBase<T>::compressReadout()
+{
+  clearReadout();
+
+  int outputs = esn_->outputs_;
+  int size = esn_->neurons_+esn_->inputs_;
+  if( esn_->Wout_.numRows() != outputs || esn_->Wout_.numCols() != size ||
+      esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
+    return;
+
+  // count nonzero weights
+  const T *w = esn_->Wout_.data();
+  int nnz = 0;
+  for(int k=0; k<outputs*size; ++k)
+    if( w[k] != 0 ) ++nnz;
+
+  // the dense BLAS readout is faster otherwise
+  if( 2*nnz > outputs*size )
+    return;
+
+  // compressed row storage of the nonzero weights
+  rout_ptr_.resize(outputs+1);
+  rout_col_.resize(nnz);
+  rout_val_.resize(nnz);
+  int k = 0;
+  for(int i=0; i<outputs; ++i)
+  {
+    rout_ptr_[i] = k;
+    for(int j=0; j<size; ++j)
+    {
+      // Wout_ is column major
+      if( w[i+j*outputs] == 0 ) continue;
+      rout_col_[k] = j;
+      rout_val_[k] = w[i+j*outputs];
+      ++k;
+    }
+  }
+  rout_ptr_[outputs] = k;
+
+  sparse_readout_ = true;
+}
+
+template <typename T>
+inline void SimBase<T>::sparseReadout(const T *x, const T *in, T *y)
+{
+  int neurons = esn_->neurons_;
+
+  for(int i=0; i<esn_->outputs_; ++i)
+  {
+    T sum = 0;
+    for(int k=rout_ptr_[i]; k<rout_ptr_[i+1]; ++k)
+    {
+      int j = rout_col_[k];
+      sum += rout_val_[k] * ( (j < neurons) ? x[j] : in[j-neurons] );
+    }
+    y[i] = sum;
+  }
+}
+
+template <typename T>
+inline void SimBase<T>::reservoirProduct(const typename ESN<T>::DEVector &x,
+                                         typename ESN<T>::DEVector &y,
+                                         bool add)
+{
+  if( esn_->topology_ == TOPOLOGY_SPARSE )
+  {
+    if( add )
+      y += esn_->W_*x;
+    else
+      y = esn_->W_*x;
+    return;
+  }
+
+  int n = esn_->neurons_;
+  const T *xd = x.data();
+  T *yd = y.data();
+
+  // circular convolution with the first column of W
+  if( esn_->topology_ == TOPOLOGY_CIRCULANT )
+  {
+    int nc = esn_->circ_spectrum_.length();
+    if( circ_buf_.length() != nc )
+      circ_buf_.resize(nc);
+
+    std::complex<T> *X = circ_buf_.data();
+    const std::complex<T> *C = esn_->circ_spectrum_.data();
+    T *xr = reinterpret_cast<T*>(X);
+
+    std::copy( xd, xd+n, xr );
+    FFTPlans<T>::r2c( X, n );
+    for(int k=0; k<nc; ++k)
+      X[k] *= C[k];
+    FFTPlans<T>::c2r( X, n );
+
+    if( add )
+    {
+      for(int i=0; i<n; ++i)
+        yd[i] += xr[i];
+    }
+    else
+      std::copy( xr, xr+n, yd );
+    return;
+  }
+
+  T r = esn_->cycle_weight_;
+
+  // connections from the previous neuron
+  T first = ( esn_->topology_ == TOPOLOGY_DELAYLINE ) ? 0 : r*xd[n-1];
+  if( add )
+  {
+    yd[0] += first;
+    for(int i=1; i<n; ++i)
+      yd[i] += r*xd[i-1];
+  }
+  else
+  {
+    yd[0] = first;
+    for(int i=1; i<n; ++i)
+      yd[i] = r*xd[i-1];
+  }
+
+  // bidirectional jumps
+  if( esn_->topology_ == TOPOLOGY_CYCLE_JUMPS )
+  {
+    int l = esn_->jump_size_;
+    T rj = esn_->jump_weight_;
+    for(int i=0; i+l<n; i+=l)
+    {
+      yd[i] += rj*xd[i+l];
+      yd[i+l] += rj*xd[i];
+    }
+  }
 }
 
 template <typename T>
@@ -130,6 +296,48 @@ typename DEVector<T>::Type &SimBase<T>::getDelayBuffer(int output, int nr)
   throw AUExcept( str );
 }
 
+template <typename T>
+void SimBase<T>::check(ModelReader &file, int neurons, int inputs,
+                       int outputs, size_t nnz)
+  throw(AUExcept)
+{
+  if( file.has(MODEL_BP_F1) || file.has(MODEL_BP_F2) )
+  {
+    file.checkReal( MODEL_BP_F1, neurons );
+    file.checkReal( MODEL_BP_F2, neurons );
+  }
+
+  if( file.has(MODEL_IIR_SIZE) )
+  {
+    const int *size = file.data<int>(MODEL_IIR_SIZE, 3);
+    if( size[0] < 1 || size[1] != neurons || size[2] < 1 )
+      throw AUExcept("SimBase::check: wrong filter size in model file!");
+    file.checkReal( MODEL_IIR_B, (size_t) size[0]*size[1]*size[2] );
+    file.checkReal( MODEL_IIR_A, (size_t) size[0]*size[1]*size[2] );
+  }
+
+  if( file.has(MODEL_DELAYS) )
+  {
+    size_t count = outputs*(neurons+inputs);
+    const int *delays = file.data<int>(MODEL_DELAYS, count);
+    for(size_t i=0; i<count; ++i)
+    {
+      if( delays[i] < 0 )
+        throw AUExcept("SimBase::check: negative delay in model file!");
+    }
+  }
+
+  if( file.has(MODEL_RESERVOIR_DELAYS) )
+  {
+    const int *delays = file.data<int>(MODEL_RESERVOIR_DELAYS, nnz);
+    for(size_t i=0; i<nnz; ++i)
+    {
+      if( delays[i] < 0 )
+        throw AUExcept("SimBase::check: negative delay in model file!");
+    }
+  }
+}
+
 //@}
 //! @name class SimStd Implementation
 //@{
@@ -161,14 +369,22 @@ void SimStd<T>::simulate(const typename ESN<T>::DEMatrix &in,
   // First run with output from last simulation
 
   t_ = esn_->x_; // temp object needed for BLAS
-  esn_->x_ = esn_->Win_*in(_,1) + esn_->W_*t_ + esn_->Wback_*last_out_(_,1);
+  this->reservoirProduct(t_, esn_->x_);
+  esn_->x_ += esn_->Win_*in(_,1) + esn_->Wback_*last_out_(_,1);
   // add noise
-  Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+  esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
   esn_->x_ += t_;
-  esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+  esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
   // output = Wout * [x; in]
-  last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,1);
+  if( this->sparse_readout_ )
+    this->sparseReadout( esn_->x_.data(), &in(1,1), last_out_.data() );
+  else
+    last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,1);
+
+  // online readout adaptation with the a priori error
+  if( target_ )
+    this->adaptReadout( &in(1,1), target_ );
 
   // output activation
   esn_->outputAct_( last_out_.data(),
@@ -181,14 +397,22 @@ void SimStd<T>::simulate(const typename ESN<T>::DEMatrix &in,
   for(int n=2; n<=steps; ++n)
   {
     t_ = esn_->x_; // temp object needed for BLAS
-    esn_->x_ = esn_->Win_*in(_,n) + esn_->W_*t_ + esn_->Wback_*out(_,n-1);
+    this->reservoirProduct(t_, esn_->x_);
+    esn_->x_ += esn_->Win_*in(_,n) + esn_->Wback_*out(_,n-1);
     // add noise
-    Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+    esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
     esn_->x_ += t_;
-    esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+    esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
     // output = Wout * [x; in]
-    last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,n);
+    if( this->sparse_readout_ )
+      this->sparseReadout( esn_->x_.data(), &in(1,n), last_out_.data() );
+    else
+      last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,n);
+
+    // online readout adaptation with the a priori error
+    if( target_ )
+      this->adaptReadout( &in(1,n), target_+(n-1)*esn_->outputs_ );
 
     // output activation
     esn_->outputAct_( last_out_.data(),
@@ -223,16 +447,20 @@ void SimLI<T>::simulate(const typename ESN<T>::DEMatrix &in,
   t_ = esn_->x_; // temp object needed for BLAS
 
   // add noise
-  Rand<T>::uniform(esn_->x_, -1.*esn_->noise_, esn_->noise_);
+  esn_->rand_.uniform(esn_->x_, -1.*esn_->noise_, esn_->noise_);
   // state update
-  esn_->x_ += esn_->Win_*in(_,1) + esn_->W_*t_ + esn_->Wback_*last_out_(_,1);
-  esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+  this->reservoirProduct(t_, esn_->x_, true);
+  esn_->x_ += esn_->Win_*in(_,1) + esn_->Wback_*last_out_(_,1);
+  esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
   // at leakage
   esn_->x_ += (1. - esn_->init_params_[LEAKING_RATE]) * t_;
 
   // output = Wout * [x; in]
-  last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,1);
+  if( this->sparse_readout_ )
+    this->sparseReadout( esn_->x_.data(), &in(1,1), last_out_.data() );
+  else
+    last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,1);
 
   // output activation
   esn_->outputAct_( last_out_.data(),
@@ -246,16 +474,20 @@ void SimLI<T>::simulate(const typename ESN<T>::DEMatrix &in,
     t_ = esn_->x_; // temp object needed for BLAS
 
     // add noise
-    Rand<T>::uniform(esn_->x_, -1.*esn_->noise_, esn_->noise_);
+    esn_->rand_.uniform(esn_->x_, -1.*esn_->noise_, esn_->noise_);
     // state update
-    esn_->x_ += esn_->Win_*in(_,n) + esn_->W_*t_ + esn_->Wback_*out(_,n-1);
-    esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+    this->reservoirProduct(t_, esn_->x_, true);
+    esn_->x_ += esn_->Win_*in(_,n) + esn_->Wback_*out(_,n-1);
+    esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
     // at leakage
     esn_->x_ += (1. - esn_->init_params_[LEAKING_RATE]) * t_;
 
     // output = Wout * [x; in]
-    last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,n);
+    if( this->sparse_readout_ )
+      this->sparseReadout( esn_->x_.data(), &in(1,n), last_out_.data() );
+    else
+      last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,n);
 
     // output activation
     esn_->outputAct_( last_out_.data(),
@@ -292,6 +524,28 @@ void SimBP<T>::setBPCutoff(const typename ESN<T>::DEVector &f1,
   filter_.setBPCutoff(f1,f2);
 }
 
+template <typename T>
+void SimBP<T>::save(ModelWriter &file) throw(AUExcept)
+{
+  if( filter_.getF1().length() != esn_->neurons_ )
+    return;
+
+  file.write( MODEL_BP_F1, filter_.getF1().data(), esn_->neurons_ );
+  file.write( MODEL_BP_F2, filter_.getF2().data(), esn_->neurons_ );
+}
+
+template <typename T>
+void SimBP<T>::load(ModelReader &file) throw(AUExcept)
+{
+  if( !file.has(MODEL_BP_F1) )
+    return;
+
+  typename ESN<T>::DEVector f1(esn_->neurons_), f2(esn_->neurons_);
+  file.copy( MODEL_BP_F1, f1.data(), esn_->neurons_ );
+  file.copy( MODEL_BP_F2, f2.data(), esn_->neurons_ );
+  setBPCutoff(f1, f2);
+}
+
 template <typename T>
 void SimBP<T>::simulate(const typename ESN<T>::DEMatrix &in,
                         typename ESN<T>::DEMatrix &out)
@@ -312,17 +566,21 @@ void SimBP<T>::simulate(const typename ESN<T>::DEMatrix &in,
 
   // calc neuron activation
   t_ = esn_->x_;
-  esn_->x_ = esn_->Win_*in(_,1) + esn_->W_*t_ + esn_->Wback_*last_out_(_,1);
+  this->reservoirProduct(t_, esn_->x_);
+  esn_->x_ += esn_->Win_*in(_,1) + esn_->Wback_*last_out_(_,1);
   // add noise
-  Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+  esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
   esn_->x_ += t_;
-  esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+  esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
   // Bandpass Filtering
   filter_.calc(esn_->x_);
 
   // output = Wout * [x; in]
-  last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,1);
+  if( this->sparse_readout_ )
+    this->sparseReadout( esn_->x_.data(), &in(1,1), last_out_.data() );
+  else
+    last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,1);
 
   // output activation
   esn_->outputAct_( last_out_.data(),
@@ -335,17 +593,21 @@ void SimBP<T>::simulate(const typename ESN<T>::DEMatrix &in,
   for(int n=2; n<=steps; ++n)
   {
     t_ = esn_->x_; // temp object needed for BLAS
-    esn_->x_ = esn_->Win_*in(_,n) + esn_->W_*t_ + esn_->Wback_*out(_,n-1);
+    this->reservoirProduct(t_, esn_->x_);
+    esn_->x_ += esn_->Win_*in(_,n) + esn_->Wback_*out(_,n-1);
     // add noise
-    Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+    esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
     esn_->x_ += t_;
-    esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+    esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
     // Bandpass Filtering
     filter_.calc(esn_->x_);
 
     // output = Wout * [x; in]
-    last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,n);
+    if( this->sparse_readout_ )
+      this->sparseReadout( esn_->x_.data(), &in(1,n), last_out_.data() );
+    else
+      last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,n);
 
     // output activation
     esn_->outputAct_( last_out_.data(),
@@ -372,6 +634,51 @@ void SimFilter<T>::setIIRCoeff(const typename DEMatrix<T>::Type &B,
   filter_.setIIRCoeff(B,A,series);
 }
 
+template <typename T>
+void SimFilter<T>::save(ModelWriter &file) throw(AUExcept)
+{
+  int series = filter_.getSeries();
+  if( series == 0 )
+    return;
+
+  // the serial filters have the same size, their column major
+  // coefficients are stored one after another
+  int rows = filter_.getFilter(0).getB().numRows();
+  int cols = filter_.getFilter(0).getB().numCols();
+  int size[3] = { series, rows, cols };
+  std::vector<T> B(series*rows*cols), A(series*rows*cols);
+  for(int i=0; i<series; ++i)
+  {
+    const IIRFilter<T> &filter = filter_.getFilter(i);
+    std::copy( filter.getB().data(), filter.getB().data()+rows*cols,
+               B.begin()+i*rows*cols );
+    std::copy( filter.getA().data(), filter.getA().data()+rows*cols,
+               A.begin()+i*rows*cols );
+  }
+
+  file.write( MODEL_IIR_SIZE, size, 3 );
+  file.write( MODEL_IIR_B, &B[0], B.size() );
+  file.write( MODEL_IIR_A, &A[0], A.size() );
+}
+
+template <typename T>
+void SimFilter<T>::load(ModelReader &file) throw(AUExcept)
+{
+  if( !file.has(MODEL_IIR_SIZE) )
+    return;
+
+  const int *size = file.data<int>(MODEL_IIR_SIZE, 3);
+  int series = size[0], rows = size[1], cols = size[2];
+  if( series < 1 || rows != esn_->neurons_ || cols < 1 )
+    throw AUExcept("SimFilter::load: wrong filter size in model file!");
+  typename DEMatrix<T>::Type B(rows, series*cols), A(rows, series*cols);
+  file.copy( MODEL_IIR_B, B.data(), rows*series*cols );
+  file.copy( MODEL_IIR_A, A.data(), rows*series*cols );
+
+  filter_ = SerialIIRFilter<T>();
+  setIIRCoeff(B, A, series);
+}
+
 template <typename T>
 void SimFilter<T>::simulate(const typename ESN<T>::DEMatrix &in,
                             typename ESN<T>::DEMatrix &out)
@@ -392,17 +699,25 @@ void SimFilter<T>::simulate(const typename ESN<T>::DEMatrix &in,
 
   // calc neuron activation
   t_ = esn_->x_;
-  esn_->x_ = esn_->Win_*in(_,1) + esn_->W_*t_ + esn_->Wback_*last_out_(_,1);
+  this->reservoirProduct(t_, esn_->x_);
+  esn_->x_ += esn_->Win_*in(_,1) + esn_->Wback_*last_out_(_,1);
   // add noise
-  Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+  esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
   esn_->x_ += t_;
-  esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+  esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
   // IIR Filtering
   filter_.calc(esn_->x_);
 
   // output = Wout * [x; in]
-  last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,1);
+  if( this->sparse_readout_ )
+    this->sparseReadout( esn_->x_.data(), &in(1,1), last_out_.data() );
+  else
+    last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,1);
+
+  // online readout adaptation with the a priori error
+  if( target_ )
+    this->adaptReadout( &in(1,1), target_ );
 
   // output activation
   esn_->outputAct_( last_out_.data(),
@@ -415,17 +730,25 @@ void SimFilter<T>::simulate(const typename ESN<T>::DEMatrix &in,
   for(int n=2; n<=steps; ++n)
   {
     t_ = esn_->x_; // temp object needed for BLAS
-    esn_->x_ = esn_->Win_*in(_,n) + esn_->W_*t_ + esn_->Wback_*out(_,n-1);
+    this->reservoirProduct(t_, esn_->x_);
+    esn_->x_ += esn_->Win_*in(_,n) + esn_->Wback_*out(_,n-1);
     // add noise
-    Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+    esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
     esn_->x_ += t_;
-    esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+    esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
     // IIR Filtering
     filter_.calc(esn_->x_);
 
     // output = Wout * [x; in]
-    last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,n);
+    if( this->sparse_readout_ )
+      this->sparseReadout( esn_->x_.data(), &in(1,n), last_out_.data() );
+    else
+      last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,n);
+
+    // online readout adaptation with the a priori error
+    if( target_ )
+      this->adaptReadout( &in(1,n), target_+(n-1)*esn_->outputs_ );
 
     // output activation
     esn_->outputAct_( last_out_.data(),
@@ -457,18 +780,22 @@ void SimFilter2<T>::simulate(const typename ESN<T>::DEMatrix &in,
   // First run with output from last simulation
 
   t_ = esn_->x_; // temp object needed for BLAS
-  esn_->x_ = esn_->Win_*in(_,1) + esn_->W_*t_ + esn_->Wback_*last_out_(_,1);
+  this->reservoirProduct(t_, esn_->x_);
+  esn_->x_ += esn_->Win_*in(_,1) + esn_->Wback_*last_out_(_,1);
 
   // IIR Filtering
   filter_.calc(esn_->x_);
 
   // add noise
-  Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+  esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
   esn_->x_ += t_;
-  esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+  esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
   // output = Wout * [x; in]
-  last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,1);
+  if( this->sparse_readout_ )
+    this->sparseReadout( esn_->x_.data(), &in(1,1), last_out_.data() );
+  else
+    last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,1);
 
   // output activation
   esn_->outputAct_( last_out_.data(),
@@ -481,18 +808,22 @@ void SimFilter2<T>::simulate(const typename ESN<T>::DEMatrix &in,
   for(int n=2; n<=steps; ++n)
   {
     t_ = esn_->x_; // temp object needed for BLAS
-    esn_->x_ = esn_->Win_*in(_,n) + esn_->W_*t_ + esn_->Wback_*out(_,n-1);
+    this->reservoirProduct(t_, esn_->x_);
+    esn_->x_ += esn_->Win_*in(_,n) + esn_->Wback_*out(_,n-1);
 
     // IIR Filtering
     filter_.calc(esn_->x_);
 
     // add noise
-    Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+    esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
     esn_->x_ += t_;
-    esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+    esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
     // output = Wout * [x; in]
-    last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,n);
+    if( this->sparse_readout_ )
+      this->sparseReadout( esn_->x_.data(), &in(1,n), last_out_.data() );
+    else
+      last_out_(_,1) = Wout1*esn_->x_ + Wout2*in(_,n);
 
     // output activation
     esn_->outputAct_( last_out_.data(),
@@ -554,7 +885,7 @@ void SimFilterDS<T>::initReservoirDelays()
   typedef typename SPMatrix<T>::Type::const_iterator It;
   for (It it=esn_->W_.begin(); it!=esn_->W_.end(); ++it)
   {
-    delay = std::rand() % maxdelay;
+    delay = esn_->rand_.index(maxdelay);
     typename DEVector<T>::Type buffer(delay);
     std::fill_n( buffer.data(), delay, 0 );
     DelayLine<T> delline;
@@ -600,6 +931,68 @@ typename DEMatrix<T>::Type SimFilterDS<T>::getReservoirDelays() throw(AUExcept)
   return del;
 }
 
+template <typename T>
+void SimFilterDS<T>::save(ModelWriter &file) throw(AUExcept)
+{
+  SimFilter<T>::save(file);
+
+  std::vector<int> delays( dellines_.size() );
+  for(unsigned i=0; i<dellines_.size(); ++i)
+    delays[i] = dellines_[i].delay_;
+  if( !delays.empty() )
+    file.write( MODEL_DELAYS, &delays[0], delays.size() );
+
+  // reservoir delays in the order of the nonzero elements of W_
+  if( use_reservoir_delays_ && !Wdel_.empty() )
+  {
+    delays.resize( Wdel_.size() );
+    for(unsigned i=0; i<Wdel_.size(); ++i)
+      delays[i] = Wdel_[i].delay_;
+    file.write( MODEL_RESERVOIR_DELAYS, &delays[0], delays.size() );
+  }
+}
+
+template <typename T>
+void SimFilterDS<T>::load(ModelReader &file) throw(AUExcept)
+{
+  // check the delays before anything is changed
+  size_t nnz = 0;
+  typedef typename SPMatrix<T>::Type::const_iterator It;
+  for (It it=esn_->W_.begin(); it!=esn_->W_.end(); ++it)
+    ++nnz;
+  int n = esn_->neurons_, ins = esn_->inputs_, outs = esn_->outputs_;
+  SimBase<T>::check(file, n, ins, outs, nnz);
+
+  SimFilter<T>::load(file);
+
+  if( file.has(MODEL_DELAYS) )
+  {
+    const int *delays = file.data<int>(MODEL_DELAYS, dellines_.size());
+    for(unsigned i=0; i<dellines_.size(); ++i)
+    {
+      typename DEVector<T>::Type buffer(delays[i]);
+      std::fill_n( buffer.data(), delays[i], 0 );
+      dellines_[i].initBuffer(buffer);
+    }
+  }
+
+  Wdel_.clear();
+  use_reservoir_delays_ = false;
+  if( !file.has(MODEL_RESERVOIR_DELAYS) )
+    return;
+
+  const int *delays = file.data<int>(MODEL_RESERVOIR_DELAYS, nnz);
+  for(size_t i=0; i<nnz; ++i)
+  {
+    typename DEVector<T>::Type buffer(delays[i]);
+    std::fill_n( buffer.data(), delays[i], 0 );
+    DelayLine<T> delline;
+    delline.initBuffer(buffer);
+    Wdel_.push_back( delline );
+  }
+  use_reservoir_delays_ = true;
+}
+
 template <typename T>
 typename DEVector<T>::Type &SimFilterDS<T>::getDelayBuffer(int output, int nr)
     throw(AUExcept)
@@ -647,6 +1040,58 @@ void SimFilterDS<T>::mvdel(const typename ESN<T>::SPMatrix &AA,
   }
 }
 
+template <typename T>
+void SimFilterDS<T>::sparseDelayReadout(const typename ESN<T>::DEMatrix &in,
+                                        int n)
+{
+  int neurons = esn_->neurons_;
+  int size = esn_->neurons_+esn_->inputs_;
+
+  // only delaylines of nonzero weights are used
+  for(int i=0; i<esn_->outputs_; ++i)
+  {
+    T sum = 0;
+    for(int k=this->rout_ptr_[i]; k<this->rout_ptr_[i+1]; ++k)
+    {
+      int j = this->rout_col_[k];
+      T val = (j < neurons) ? esn_->x_(j+1) : in(j-neurons+1,n);
+      sum += this->rout_val_[k] * dellines_[i*size+j].tic(val);
+    }
+    last_out_(i+1,1) = sum;
+  }
+}
+
+template <typename T>
+void SimFilterDS<T>::clearReadout()
+{
+  if( !this->sparse_readout_ )
+    return;
+  this->sparse_readout_ = false;
+
+  int size = esn_->neurons_+esn_->inputs_;
+  if( (int) dellines_.size() != esn_->outputs_*size )
+    return;
+
+  // the delaylines of zero weights were not ticked by
+  // sparseDelayReadout, the column indices of each row are sorted
+  for(int i=0; i<esn_->outputs_; ++i)
+  {
+    int k = this->rout_ptr_[i];
+    for(int j=0; j<size; ++j)
+    {
+      if( k < this->rout_ptr_[i+1] && this->rout_col_[k] == j )
+      {
+        ++k;
+        continue;
+      }
+
+      DelayLine<T> &line = dellines_[i*size+j];
+      std::fill_n( line.buffer_.data(), line.delay_, 0 );
+      line.readpt_ = 1;
+    }
+  }
+}
+
 template <typename T>
 void SimFilterDS<T>::simulate(const typename ESN<T>::DEMatrix &in,
                               typename ESN<T>::DEMatrix &out)
@@ -671,32 +1116,37 @@ void SimFilterDS<T>::simulate(const typename ESN<T>::DEMatrix &in,
   if( use_reservoir_delays_ )
     mvdel(esn_->W_, t_, esn_->x_);
   else
-    esn_->x_ = esn_->W_*t_;
+    this->reservoirProduct(t_, esn_->x_);
   esn_->x_ += esn_->Win_*in(_,1) + esn_->Wback_*last_out_(_,1);
 
   // add noise
-  Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+  esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
   esn_->x_ += t_;
-  esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+  esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
   // IIR Filtering
   filter_.calc(esn_->x_);
 
   // delay states and inputs for all individual outputs
-  for(int i=1; i<=esn_->outputs_; ++i)
+  if( this->sparse_readout_ )
+    sparseDelayReadout(in, 1);
+  else
   {
-    int offset = (i-1)*(esn_->neurons_+esn_->inputs_);
+    for(int i=1; i<=esn_->outputs_; ++i)
+    {
+      int offset = (i-1)*(esn_->neurons_+esn_->inputs_);
     
-    // delay x_ vector and store into t_
-    for(int j=1; j<=esn_->neurons_; ++j)
-      t_(j) =  dellines_[offset+j-1].tic( esn_->x_(j) );
+      // delay x_ vector and store into t_
+      for(int j=1; j<=esn_->neurons_; ++j)
+        t_(j) =  dellines_[offset+j-1].tic( esn_->x_(j) );
 
-    // store correct delayed input vector in intmp_
-    for(int j=1; j<=esn_->inputs_; ++j)
-      intmp_(j,1) = dellines_[offset+esn_->neurons_+j-1].tic( in(j,1) );
+      // store correct delayed input vector in intmp_
+      for(int j=1; j<=esn_->inputs_; ++j)
+        intmp_(j,1) = dellines_[offset+esn_->neurons_+j-1].tic( in(j,1) );
 
-    // calc  Wout * [x; in] for current output with delayed values
-    last_out_(i,1) = Wout1(i,_)*t_ + Wout2(i,_)*intmp_(_,1);
+      // calc  Wout * [x; in] for current output with delayed values
+      last_out_(i,1) = Wout1(i,_)*t_ + Wout2(i,_)*intmp_(_,1);
+    }
   }
 
   // output activation
@@ -713,32 +1163,37 @@ void SimFilterDS<T>::simulate(const typename ESN<T>::DEMatrix &in,
     if( use_reservoir_delays_ )
       mvdel(esn_->W_, t_, esn_->x_);
     else
-      esn_->x_ = esn_->W_*t_;
+      this->reservoirProduct(t_, esn_->x_);
     esn_->x_ += esn_->Win_*in(_,n) + esn_->Wback_*out(_,n-1);
 
     // add noise
-    Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+    esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
     esn_->x_ += t_;
-    esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+    esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
     // IIR Filtering
     filter_.calc(esn_->x_);
 
     // delay states and inputs for all individual outputs
-    for(int i=1; i<=esn_->outputs_; ++i)
+    if( this->sparse_readout_ )
+      sparseDelayReadout(in, n);
+    else
     {
-      int offset = (i-1)*(esn_->neurons_+esn_->inputs_);
+      for(int i=1; i<=esn_->outputs_; ++i)
+      {
+        int offset = (i-1)*(esn_->neurons_+esn_->inputs_);
       
-      // delay x_ vector and store into t_
-      for(int j=1; j<=esn_->neurons_; ++j)
-        t_(j) =  dellines_[offset+j-1].tic( esn_->x_(j) );
+        // delay x_ vector and store into t_
+        for(int j=1; j<=esn_->neurons_; ++j)
+          t_(j) =  dellines_[offset+j-1].tic( esn_->x_(j) );
 
-      // store correct delayed input vector in intmp_
-      for(int j=1; j<=esn_->inputs_; ++j)
-        intmp_(j,1) = dellines_[offset+esn_->neurons_+j-1 ].tic( in(j,n) );
+        // store correct delayed input vector in intmp_
+        for(int j=1; j<=esn_->inputs_; ++j)
+          intmp_(j,1) = dellines_[offset+esn_->neurons_+j-1 ].tic( in(j,n) );
 
-      // calc  Wout * [x; in] for current output with delayed values
-      last_out_(i,1) = Wout1(i,_)*t_ + Wout2(i,_)*intmp_(_,1);
+        // calc  Wout * [x; in] for current output with delayed values
+        last_out_(i,1) = Wout1(i,_)*t_ + Wout2(i,_)*intmp_(_,1);
+      }
     }
 
     // output activation
@@ -793,13 +1248,13 @@ void SimSquare<T>::simulate(const typename ESN<T>::DEMatrix &in,
   if( use_reservoir_delays_ )
     mvdel(esn_->W_, t_, esn_->x_);
   else
-    esn_->x_ = esn_->W_*t_;
+    this->reservoirProduct(t_, esn_->x_);
   esn_->x_ += esn_->Win_*in(_,1) + esn_->Wback_*last_out_(_,1);
 
   // add noise
-  Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+  esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
   esn_->x_ += t_;
-  esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+  esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
   // IIR Filtering
   filter_.calc(esn_->x_);
@@ -843,13 +1298,13 @@ void SimSquare<T>::simulate(const typename ESN<T>::DEMatrix &in,
     if( use_reservoir_delays_ )
       mvdel(esn_->W_, t_, esn_->x_);
     else
-      esn_->x_ = esn_->W_*t_;
+      this->reservoirProduct(t_, esn_->x_);
     esn_->x_ += esn_->Win_*in(_,n) + esn_->Wback_*out(_,n-1);
 
     // add noise
-    Rand<T>::uniform(t_, -1.*esn_->noise_, esn_->noise_);
+    esn_->rand_.uniform(t_, -1.*esn_->noise_, esn_->noise_);
     esn_->x_ += t_;
-    esn_->reservoirAct_( esn_->x_.data(), esn_->x_.length() );
+    esn_->reservoirAct( esn_->x_.data(), esn_->x_.length() );
 
     // IIR Filtering
     filter_.calc(esn_->x_);
@@ -0,0 +1,288 @@
+/***************************************************************************/
+/*!
+ *  \file   statefactorization.h
+ *
+ *  \brief  collected and factorized network states for training many targets
+ *
+ *  \author Georg Holzmann, grh _at_ mur _dot_ at
+ *  \date   Oct 2026
+ *
+ *   ::::_aureservoir_::::
+ *   C++ library for analog reservoir computing neural networks
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ ***************************************************************************/
+
+#ifndef AURESERVOIR_STATE_FACTORIZATION_H__
+#define AURESERVOIR_STATE_FACTORIZATION_H__
+
+#include "esn.h"
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace aureservoir
+{
+
+/*!
+ * \class StateFactorization
+ *
+ * \brief collected and factorized network states for training many targets
+ *
+ * If many different target signals should be trained with the same
+ * network and input (e.g. for multi-task evaluation), the network has
+ * to be simulated and the states have to be factorized only once.
+ *
+ * factorize() teacher forces the network, collects the states and inputs
+ * in M and calculates the singular value decomposition
+ * M = U * diag(s) * V.T (the gram matrix M.T*M is never formed, so the
+ * condition number is not squared).
+ * Afterwards the output weights of each new target o can be calculated
+ * with solve() as V * diag(s/(s^2+alpha^2)) * U.T*o, which needs
+ * O((neurons+inputs)*timesteps) for U.T*o and O((neurons+inputs)^2)
+ * for the solution, without any further simulation.
+ *
+ * With a regularization factor of 0 singular values below the machine
+ * precision (relative to the largest one) are treated as zero, like in
+ * the pseudo inverse of TRAIN_PI, otherwise the weights are the same as
+ * with TRAIN_RIDGEREG with this TIKHONOV_FACTOR.
+ *
+ * \note only networks without output feedback are possible, because
+ *       otherwise the states depend on the target signal
+ * \note SIM_FILTER_DS is not supported, because delays are trained
+ *       for each output
+ * \attention the network must exist as long as this object is used
+ */
+template <typename T = float>
+class StateFactorization
+{
+ public:
+
+  /*!
+   * Constructor
+   * @param esn network which is used to collect the states and whose
+   *            output weights are set in train()
+   */
+  StateFactorization(ESN<T> &esn)
+  { esn_ = &esn; washout_ = 0; steps_ = 0; cols_ = 0; }
+
+  /// Destructor
+  ~StateFactorization() {}
+
+  /*!
+   * teacher forces the network, collects the states and factorizes them,
+   * the internal state of the network is changed like in ESN::train
+   *
+   * @param in matrix of input values (inputs x timesteps)
+   * @param washout washout time in samples, used to get rid of the
+   *                transient dynamics of the network starting state
+   */
+  void factorize(const typename ESN<T>::DEMatrix &in, int washout)
+    throw(AUExcept)
+  {
+    if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_FILTER_DS )
+      throw AUExcept("StateFactorization::factorize: SIM_FILTER_DS is not supported!");
+
+    // the states must not depend on the target signal
+    const T *wback = esn_->Wback_.data();
+    int wbacksize = esn_->Wback_.numRows()*esn_->Wback_.numCols();
+    for(int i=0; i<wbacksize; ++i)
+      if( wback[i] != 0 )
+        throw AUExcept("StateFactorization::factorize: only possible without output feedback!");
+
+    typename ESN<T>::DEMatrix out(esn_->outputs_, in.numCols());
+    std::fill_n( out.data(), esn_->outputs_*in.numCols(), 0 );
+
+    // collect states with the training algorithm of the network
+    TrainBase<T> *train = esn_->train_;
+    train->checkParams(in, out, washout);
+    train->collectStates(in, out, washout);
+    if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
+      train->squareStates();
+    int n = train->M.numCols();
+
+    // singular value decomposition M = U * diag(s) * V.T,
+    // the collected states are overwritten
+    steps_ = 0;
+    if( gesdd(train->M, s_, U_, VT_) != 0 )
+    {
+      train->clearData();
+      U_.resize(1,1);
+      VT_.resize(1,1);
+      throw AUExcept("StateFactorization::factorize: singular value decomposition did not converge!");
+    }
+    train->clearData();
+    cols_ = n;
+
+    washout_ = washout;
+    steps_ = in.numCols();
+  }
+
+  /*!
+   * C-style interface for factorize
+   * (data will be copied into a FLENS matrix)
+   *
+   * @param inmtx input matrix in row major storage (inputs x timesteps)
+   * @param washout washout time in samples
+   */
+  void factorize(T *inmtx, int inrows, int incols, int washout)
+    throw(AUExcept)
+  {
+    typename ESN<T>::DEMatrix flin(inrows,incols);
+
+    // copy data to FLENS matrix (column major storage)
+    for(int i=0; i<inrows; ++i) {
+    for(int j=0; j<incols; ++j) {
+      flin(i+1,j+1) = inmtx[i*incols+j];
+    } }
+
+    factorize(flin, washout);
+  }
+
+  /*!
+   * calculates output weights for new target signals from the factorized
+   * states, the network is not changed
+   *
+   * @param out matrix of desired output values (targets x timesteps),
+   *            the nr of targets can be different from the nr of outputs
+   *            of the network
+   * @param Wout output weights, size = (targets x neurons+inputs)
+   * @param alpha regularization factor (like TIKHONOV_FACTOR)
+   */
+  void solve(const typename ESN<T>::DEMatrix &out,
+             typename ESN<T>::DEMatrix &Wout, T alpha=0)
+    throw(AUExcept)
+  {
+    if( steps_ == 0 )
+      throw AUExcept("StateFactorization::solve: you need to factorize the states first!");
+    if( out.numCols() != steps_ )
+      throw AUExcept("StateFactorization::solve: output must have the same timesteps as the factorized input!");
+
+    int rows = U_.numRows();
+    int p = s_.length();
+    int k = out.numRows();
+
+    // desired outputs after the washout, undo output activation function
+    typename ESN<T>::DEMatrix O(rows, k);
+    O = flens::transpose( out( _,_(washout_+1,steps_) ) );
+    esn_->outputInvAct_( O.data(), rows*k );
+
+    // project targets: C = U.T * O
+    typename ESN<T>::DEMatrix C(p, k), B(cols_, k);
+    C = flens::transpose(U_)*O;
+
+    // diag(s/(s^2+alpha^2)) * C, singular values are in descending order
+    T a = alpha*alpha;
+    T tol = std::numeric_limits<T>::epsilon() * ( p>0 ? s_(1) : 0 );
+    for(int i=1; i<=p; ++i)
+    {
+      T d;
+      if( a > 0 )
+        d = s_(i) / (s_(i)*s_(i)+a);
+      else
+        d = ( s_(i) > tol ) ? 1./s_(i) : 0.;
+      for(int j=1; j<=k; ++j)
+        C(i,j) *= d;
+    }
+
+    // Wout = (V * ans).T
+    B = flens::transpose(VT_)*C;
+    Wout = flens::transpose(B);
+  }
+
+  /*!
+   * C-style interface for solve
+   *
+   * @param outmtx desired outputs in row major storage (targets x timesteps)
+   * @param wmtx output weights in row major storage
+   *             (targets x neurons+inputs)
+   * @param alpha regularization factor (like TIKHONOV_FACTOR)
+   */
+  void solve(T *outmtx, int outrows, int outcols,
+             T *wmtx, int wrows, int wcols, T alpha=0)
+    throw(AUExcept)
+  {
+    if( wrows != outrows || wcols != cols_ )
+      throw AUExcept("StateFactorization::solve: wrong size of output weight matrix!");
+
+    typename ESN<T>::DEMatrix flout(outrows,outcols), W;
+
+    // copy data to FLENS matrix (column major storage)
+    for(int i=0; i<outrows; ++i) {
+    for(int j=0; j<outcols; ++j) {
+      flout(i+1,j+1) = outmtx[i*outcols+j];
+    } }
+
+    solve(flout, W, alpha);
+
+    for(int i=0; i<wrows; ++i) {
+    for(int j=0; j<wcols; ++j) {
+      wmtx[i*wcols+j] = W(i+1,j+1);
+    } }
+  }
+
+  /*!
+   * calculates the output weights of the network for a new target signal
+   * from the factorized states \sa solve
+   *
+   * @param out matrix of desired output values (outputs x timesteps)
+   * @param alpha regularization factor (like TIKHONOV_FACTOR)
+   */
+  void train(const typename ESN<T>::DEMatrix &out, T alpha=0)
+    throw(AUExcept)
+  {
+    if( out.numRows() != esn_->outputs_ )
+      throw AUExcept("StateFactorization::train: wrong output row size!");
+
+    typename ESN<T>::DEMatrix W;
+    solve(out, W, alpha);
+    esn_->setWout(W);
+  }
+
+  /*!
+   * C-style interface for train
+   *
+   * @param outmtx desired outputs in row major storage (outputs x timesteps)
+   * @param alpha regularization factor (like TIKHONOV_FACTOR)
+   */
+  void train(T *outmtx, int outrows, int outcols, T alpha=0)
+    throw(AUExcept)
+  {
+    typename ESN<T>::DEMatrix flout(outrows,outcols);
+
+    // copy data to FLENS matrix (column major storage)
+    for(int i=0; i<outrows; ++i) {
+    for(int j=0; j<outcols; ++j) {
+      flout(i+1,j+1) = outmtx[i*outcols+j];
+    } }
+
+    train(flout, alpha);
+  }
+
+ protected:
+
+  /// network which is used for state collection and training
+  ESN<T> *esn_;
+
+  /// left singular vectors of the collected states M (after the washout)
+  typename ESN<T>::DEMatrix U_;
+  /// transposed right singular vectors of M
+  typename ESN<T>::DEMatrix VT_;
+  /// singular values of M in descending order
+  typename ESN<T>::DEVector s_;
+  /// nr of columns of M (neurons+inputs, doubled with SIM_SQUARE)
+  int cols_;
+
+  /// washout of the factorized input
+  int washout_;
+  /// nr of timesteps of the factorized input, 0 if not factorized
+  int steps_;
+};
+
+} // end of namespace aureservoir
+
+#endif // AURESERVOIR_STATE_FACTORIZATION_H__
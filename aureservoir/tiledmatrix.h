@@ -0,0 +1,147 @@
+/***************************************************************************/
+/*!
+ *  \file   tiledmatrix.h
+ *
+ *  \brief  memory mapped matrix storage and out-of-core solvers
+ *
+ *  \author Georg Holzmann, grh _at_ mur _dot_ at
+ *  \date   Oct 2026
+ *
+ *   ::::_aureservoir_::::
+ *   C++ library for analog reservoir computing neural networks
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ ***************************************************************************/
+
+#ifndef AURESERVOIR_TILEDMATRIX_H__
+#define AURESERVOIR_TILEDMATRIX_H__
+
+#include "utilities.h"
+#include "linalg.h"
+#include <cstddef>
+
+namespace aureservoir
+{
+
+/*!
+ * \class TiledMatrix
+ *
+ * \brief dense matrix in a memory mapped scratch file
+ *
+ * The matrix is split into tiles of tilerows rows (the last tile may
+ * be shorter), each tile stores its rows in column major order with
+ * the tile rows as leading dimension.
+ * Tiles start at offsets aligned to the page size, so the data of
+ * each tile is page aligned for BLAS/LAPACK and paging a tile in or out
+ * does not touch its neighbours.
+ *
+ * The scratch file is created in $TMPDIR (default /tmp) and removed
+ * immediately, so it disappears when the matrix is freed or the
+ * program terminates.
+ * Memory is only needed for the tiles which are currently in use,
+ * the rest is paged out by the operating system.
+ *
+ * \note only the data of whole tiles should be used with BLAS/LAPACK,
+ *       element access with operator() is slow
+ */
+template <typename T>
+class TiledMatrix
+{
+ public:
+
+  /// Constructor, creates an empty matrix
+  TiledMatrix();
+
+  /// Destructor, unmaps and removes the scratch file
+  ~TiledMatrix() { clear(); }
+
+  /*!
+   * allocates a new scratch file for the matrix, the data is
+   * initialized with zeros
+   *
+   * @param rows nr of rows
+   * @param cols nr of columns
+   * @param tilerows nr of rows per tile
+   */
+  void resize(int rows, int cols, int tilerows) throw(AUExcept);
+
+  /// frees the matrix and removes the scratch file
+  void clear();
+
+  /// @return nr of rows
+  int numRows() const { return rows_; }
+  /// @return nr of columns
+  int numCols() const { return cols_; }
+  /// @return nr of tiles
+  int numTiles() const { return tiles_; }
+
+  /// @return nr of rows of tile t (t = 1 .. numTiles())
+  int tileRows(int t) const
+  { return (t < tiles_) ? tilerows_ : rows_ - (tiles_-1)*tilerows_; }
+
+  /// @return column major data of tile t (t = 1 .. numTiles())
+  T *tile(int t)
+  { return reinterpret_cast<T*>(data_ + (t-1)*tilestride_); }
+
+  /// @return column major data of tile t (t = 1 .. numTiles())
+  const T *tile(int t) const
+  { return reinterpret_cast<const T*>(data_ + (t-1)*tilestride_); }
+
+  /// element access, indices start with 1 like in FLENS
+  T &operator()(int i, int j)
+  {
+    int t = (i-1) / tilerows_;
+    return tile(t+1)[ (i-1-t*tilerows_) + (j-1)*tileRows(t+1) ];
+  }
+
+ private:
+
+  /// no copies of the scratch file
+  TiledMatrix(const TiledMatrix<T> &src);
+  const TiledMatrix &operator= (const TiledMatrix<T> &src);
+
+  int rows_, cols_, tilerows_, tiles_;
+
+  /// offset in bytes between the start of two tiles
+  size_t tilestride_;
+  /// size of the memory mapping in bytes
+  size_t mapsize_;
+  /// start of the memory mapping
+  char *data_;
+};
+
+//! @name out-of-core solvers
+//@{
+
+/*!
+ * tall skinny QR reduction of a tiled least squares problem A * X = B
+ * (TSQR).
+ * The tiles are processed one after another, the triangular factor
+ * of the rows seen so far is stacked on top of the next tile and
+ * factorized again with LAPACK's xGEQRF, the right hand sides are
+ * transformed with xORMQR.
+ * Afterwards R * X = C is a small problem with the same (minimum norm)
+ * least squares solution as the original one, because
+ * pinv(Q*R) = pinv(R) * Q.T for Q with orthonormal columns.
+ *
+ * @param A system matrix (rows x n), rows >= n
+ * @param B right hand sides (rows x k), same tiling as A
+ * @param R upper triangular factor of A (n x n)
+ * @param C transformed right hand sides Q.T * B (n x k)
+ */
+template <typename T>
+void tsqr(const TiledMatrix<T> &A, const TiledMatrix<T> &B,
+          typename DEMatrix<T>::Type &R, typename DEMatrix<T>::Type &C)
+  throw(AUExcept);
+
+//@}
+
+} // end of namespace aureservoir
+
+#include <aureservoir/tiledmatrix.hpp>
+
+#endif // AURESERVOIR_TILEDMATRIX_H__
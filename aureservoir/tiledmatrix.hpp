@@ -0,0 +1,172 @@
+/***************************************************************************/
+/*!
+ *  \file   tiledmatrix.hpp
+ *
+ *  \brief  memory mapped matrix storage and out-of-core solvers
+ *
+ *  \author Georg Holzmann, grh _at_ mur _dot_ at
+ *  \date   Oct 2026
+ *
+ *   ::::_aureservoir_::::
+ *   C++ library for analog reservoir computing neural networks
+ *
+ *   This library is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU Lesser General Public
+ *   License as published by the Free Software Foundation; either
+ *   version 2.1 of the License, or (at your option) any later version.
+ *
+ ***************************************************************************/
+
+#include <sys/types.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+
+namespace aureservoir
+{
+
+//! @name class TiledMatrix Implementation
+//@{
+
+template <typename T>
+TiledMatrix<T>::TiledMatrix()
+{
+  rows_ = cols_ = tilerows_ = tiles_ = 0;
+  tilestride_ = mapsize_ = 0;
+  data_ = 0;
+}
+
+template <typename T>
+void TiledMatrix<T>::resize(int rows, int cols, int tilerows)
+  throw(AUExcept)
+{
+  if( rows < 1 || cols < 1 || tilerows < 1 )
+    throw AUExcept("TiledMatrix::resize: rows, cols and tilerows must be >= 1 !");
+
+  clear();
+
+  tilerows = std::min(tilerows, rows);
+  int tiles = (rows + tilerows - 1) / tilerows;
+
+  // align tiles to pages
+  size_t align = sysconf(_SC_PAGESIZE);
+  size_t tilesize = (size_t) tilerows * cols * sizeof(T);
+  size_t stride = ( (tilesize + align - 1) / align ) * align;
+  size_t mapsize = stride * tiles;
+
+  // create and remove the scratch file, it exists until it is unmapped
+  const char *dir = getenv("TMPDIR");
+  std::string path = (dir && *dir) ? dir : "/tmp";
+  path += "/aureservoirXXXXXX";
+  std::vector<char> name(path.begin(), path.end());
+  name.push_back(0);
+
+  int fd = mkstemp( &name[0] );
+  if( fd == -1 )
+  {
+    std::string str = "TiledMatrix::resize: can't create scratch file ";
+    str += path; str += ": "; str += strerror(errno);
+    throw AUExcept(str);
+  }
+  unlink( &name[0] );
+
+  if( ftruncate(fd, mapsize) == -1 )
+  {
+    std::string str = "TiledMatrix::resize: can't resize scratch file: ";
+    str += strerror(errno);
+    close(fd);
+    throw AUExcept(str);
+  }
+
+  void *data = mmap(0, mapsize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if( data == MAP_FAILED )
+  {
+    std::string str = "TiledMatrix::resize: can't map scratch file: ";
+    str += strerror(errno);
+    throw AUExcept(str);
+  }
+
+  rows_ = rows;
+  cols_ = cols;
+  tilerows_ = tilerows;
+  tiles_ = tiles;
+  tilestride_ = stride;
+  mapsize_ = mapsize;
+  data_ = static_cast<char*>(data);
+}
+
+template <typename T>
+void TiledMatrix<T>::clear()
+{
+  if( data_ )
+    munmap(data_, mapsize_);
+
+  rows_ = cols_ = tilerows_ = tiles_ = 0;
+  tilestride_ = mapsize_ = 0;
+  data_ = 0;
+}
+
+//@}
+//! @name out-of-core solvers
+//@{
+
+template <typename T>
+void tsqr(const TiledMatrix<T> &A, const TiledMatrix<T> &B,
+          typename DEMatrix<T>::Type &R, typename DEMatrix<T>::Type &C)
+  throw(AUExcept)
+{
+  if( A.numRows() != B.numRows() || A.numTiles() != B.numTiles() )
+    throw AUExcept("tsqr: A and B must have the same tiling !");
+  if( A.numRows() < A.numCols() )
+    throw AUExcept("tsqr: A must have at least as many rows as columns !");
+
+  int n = A.numCols(), k = B.numCols();
+
+  R.resizeOrClear(n, n);
+  C.resizeOrClear(n, k);
+
+  // stacked [R; tile] and [C; tile]
+  typename DEMatrix<T>::Type S, SC;
+  typename DEVector<T>::Type tau;
+
+  for(int t=1; t<=A.numTiles(); ++t)
+  {
+    int r = A.tileRows(t);
+    if( S.numRows() != n+r )
+    {
+      S.resize(n+r, n);
+      SC.resize(n+r, k);
+    }
+
+    const T *At = A.tile(t);
+    for(int j=0; j<n; ++j)
+    {
+      std::copy( R.data()+j*n, R.data()+(j+1)*n, S.data()+j*(n+r) );
+      std::copy( At+j*r, At+(j+1)*r, S.data()+j*(n+r)+n );
+    }
+    const T *Bt = B.tile(t);
+    for(int j=0; j<k; ++j)
+    {
+      std::copy( C.data()+j*n, C.data()+(j+1)*n, SC.data()+j*(n+r) );
+      std::copy( Bt+j*r, Bt+(j+1)*r, SC.data()+j*(n+r)+n );
+    }
+
+    if( geqrf(S, tau) != 0 || ormqr(S, tau, SC) != 0 )
+      throw AUExcept("tsqr: QR factorization failed !");
+
+    // new triangular factor and right hand sides
+    for(int j=1; j<=n; ++j) {
+    for(int i=1; i<=n; ++i) {
+      R(i,j) = (i<=j) ? S(i,j) : 0;
+    } }
+    C = SC(_(1,n),_);
+  }
+}
+
+//@}
+
+} // end of namespace aureservoir
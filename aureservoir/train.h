@@ -22,6 +22,9 @@
 
 #include "utilities.h"
 #include "delaysum.h"
+#include "linalg.h"
+#include "tiledmatrix.h"
+#include <vector>
 
 namespace aureservoir
 {
@@ -36,7 +39,11 @@ enum TrainAlgorithm
   TRAIN_PI,        //!< offline, pseudo inverse based \sa class TrainPI
   TRAIN_LS,        //!< offline least square algorithm, \sa class TrainLS
   TRAIN_RIDGEREG,  //!< with ridge regression, \sa class TrainRidgeReg
-  TRAIN_DS_PI      //!< trains a delay&sum readout with PI \sa class TrainDSPI
+  TRAIN_DS_PI,     //!< trains a delay&sum readout with PI \sa class TrainDSPI
+  TRAIN_RIDGEREG_CV, //!< cross-validated ridge regression \sa class TrainRidgeRegCV
+  TRAIN_RLS,       //!< online recursive least squares \sa class TrainRLS
+  TRAIN_NLMS,      //!< online normalized least mean squares \sa class TrainNLMS
+  TRAIN_LASSO      //!< offline L1 regularized, sparse readout \sa class TrainLasso
 };
 
 template <typename T> class ESN;
@@ -83,27 +90,156 @@ class TrainBase
                    int washout) throw(AUExcept);
 
 
-  /// collect network states with simulation algorithm
+  /*!
+   * collect network states with simulation algorithm
+   *
+   * @param in matrix of input values (inputs x timesteps)
+   * @param out matrix of desired output values (outputs x timesteps)
+   * @param washout washout time in samples
+   * @param tilerows if > 0, the states are stored out of core in Mt and
+   *                 Ot with tilerows rows per tile instead of M and O
+   */
   void collectStates(const typename ESN<T>::DEMatrix &in,
                      const typename ESN<T>::DEMatrix &out,
-                     int washout);
+                     int washout, int tilerows=0);
+
+  /*!
+   * collects the states of several independent episodes into M and O,
+   * each episode starts from a reset network state and has its own
+   * washout. The episodes are simulated in parallel (with OpenMP), every
+   * episode uses its own copy of the network (with the filter and delay
+   * line memory of the network itself), so the state of the network
+   * itself is not changed.
+   *
+   * @param ins input matrices of all episodes (inputs x timesteps)
+   * @param outs desired outputs of all episodes (outputs x timesteps)
+   * @param washouts washout of each episode
+   * @param tilerows if > 0, the states are stored out of core in Mt and
+   *                 Ot with tilerows rows per tile instead of M and O
+   */
+  void collectEpisodes(const std::vector<typename ESN<T>::DEMatrix> &ins,
+                       const std::vector<typename ESN<T>::DEMatrix> &outs,
+                       const std::vector<int> &washouts,
+                       int tilerows=0) throw(AUExcept);
+
+  /*!
+   * offline weight computation from the collected states M and desired
+   * outputs O (only for offline algorithms), M and O are freed afterwards
+   */
+  virtual void computeWeights() throw(AUExcept);
+
+  /*!
+   * training with several independent episodes, the states of all
+   * episodes are collected (collectEpisodes) and the weights are
+   * calculated with one solve (computeWeights)
+   *
+   * @param ins input matrices of all episodes (inputs x timesteps)
+   * @param outs desired outputs of all episodes (outputs x timesteps)
+   * @param washouts washout of each episode
+   */
+  virtual void trainEpisodes(const std::vector<typename ESN<T>::DEMatrix> &ins,
+                             const std::vector<typename ESN<T>::DEMatrix> &outs,
+                             const std::vector<int> &washouts) throw(AUExcept);
+
+  /// @return true if the training algorithm can store M and O out of core
+  virtual bool supportsOutOfCore() { return false; }
+
+  /*!
+   * @return nr of rows per tile (OOC_TILE_ROWS) if the training algorithm
+   *         stores M and O out of core, 0 if they are stored in memory
+   */
+  int tileRows();
 
   /// squares states for SIM_SQUARE
   void squareStates();
 
+  /*!
+   * calculates the gram matrices of the collected data
+   * @param G will be M.T * M, size = (M.numCols() x M.numCols())
+   * @param B will be M.T * O, size = (M.numCols() x outputs)
+   */
+  void gramMatrices(typename ESN<T>::DEMatrix &G,
+                    typename ESN<T>::DEMatrix &B);
+
+  /*!
+   * online training, simulates the network and adapts the output weights
+   * after each timestep to the desired output, the network output is
+   * used as feedback \sa ESN::trainOnline
+   *
+   * @param in matrix of input values (inputs x timesteps)
+   * @param target matrix of desired output values (outputs x timesteps)
+   * @param out matrix for output values (outputs x timesteps)
+   */
+  virtual void trainOnline(const typename ESN<T>::DEMatrix &in,
+                           const typename ESN<T>::DEMatrix &target,
+                           typename ESN<T>::DEMatrix &out) throw(AUExcept);
+
+  /*!
+   * online training step, adapts the output weights to the desired
+   * output of the current timestep (only for online algorithms)
+   * \attention the network must already be simulated for this timestep
+   *
+   * @param in input values of the current timestep (size = inputs)
+   * @param target desired output values of the current timestep
+   *               (size = outputs)
+   */
+  virtual void trainStep(const T *in, const T *target) throw(AUExcept);
+
+  /*!
+   * discards the adapted state of online algorithms, called after the
+   * network was initialized or loaded, so that the next trainStep()
+   * starts from the initial state again
+   */
+  virtual void resetOnline() {}
+
+  /// called by ESN::setInitParam, online algorithms which cache
+  /// initialization parameters read them again before the next step
+  virtual void initParamsChanged() {}
+
+  /// @return table of validation errors from cross-validated training
+  /// \sa class TrainRidgeRegCV
+  virtual typename ESN<T>::DEMatrix getCVErrors() throw(AUExcept);
+
   /// frees allocated data for M and O
   void clearData()
-  { M.resize(1,1); O.resize(1,1); }
+  { M.resize(1,1); O.resize(1,1); Mt.clear(); Ot.clear(); }
 
   /// matrix for network states and inputs over all timesteps
   typename ESN<T>::DEMatrix M;
   /// matrix for outputs over all timesteps
   typename ESN<T>::DEMatrix O;
+
+  /// out of core storage of M in a memory mapped file
+  TiledMatrix<T> Mt;
+  /// out of core storage of O in a memory mapped file
+  TiledMatrix<T> Ot;
   
  protected:
+
+  /*!
+   * allocates M and O, or Mt and Ot if tilerows > 0
+   * @param rows nr of timesteps
+   * @param cols nr of states and inputs
+   * @param tilerows nr of rows per tile for out of core storage
+   */
+  void allocateData(int rows, int cols, int tilerows) throw(AUExcept);
+
+  /*!
+   * collects the states of one episode with network net into
+   * the rows row+1 .. row+timesteps-washout of M and O
+   */
+  void collectEpisode(ESN<T> &net,
+                      const typename ESN<T>::DEMatrix &in,
+                      const typename ESN<T>::DEMatrix &out,
+                      int washout, int row);
  
   /// reference to the data of the network
   ESN<T> *esn_;
+
+  /// input of one step in trainOnline, allocated only once
+  typename ESN<T>::DEMatrix step_in_;
+  /// output of one step in trainOnline, allocated only once
+  typename ESN<T>::DEMatrix step_out_;
 };
 
 /*!
@@ -126,6 +262,13 @@ class TrainBase
  * more expansive, but TrainLeastSquare can have stability problems.
  * \sa class TrainLeastSquare
  *
+ * If the init parameter OOC_TILE_ROWS is set, the states and outputs
+ * are stored out of core in a memory mapped scratch file with tiles of
+ * OOC_TILE_ROWS rows. They are then reduced tile by tile with a tall
+ * skinny QR factorization (tsqr), so that only the small triangular
+ * factor has to be solved with xGELSS. Like that also very long
+ * training sequences can be used, which don't fit into memory.
+ *
  * For a more mathematical description:
  * \sa http://en.wikipedia.org/wiki/Linear_least_squares
  * \sa http://www.netlib.org/lapack/lug/node27.html
@@ -138,6 +281,8 @@ class TrainPI : public TrainBase<T>
   using TrainBase<T>::esn_;
   using TrainBase<T>::M;
   using TrainBase<T>::O;
+  using TrainBase<T>::Mt;
+  using TrainBase<T>::Ot;
 
  public:
   TrainPI(ESN<T> *esn) : TrainBase<T>(esn) {}
@@ -147,6 +292,12 @@ class TrainPI : public TrainBase<T>
   virtual void train(const typename ESN<T>::DEMatrix &in,
                      const typename ESN<T>::DEMatrix &out,
                      int washout) throw(AUExcept);
+
+  /// weight computation from the collected states
+  virtual void computeWeights() throw(AUExcept);
+
+  /// M and O can be stored out of core with OOC_TILE_ROWS
+  virtual bool supportsOutOfCore() { return true; }
 };
 
 /*!
@@ -165,6 +316,19 @@ class TrainPI : public TrainBase<T>
  *
  * The differences to the TrainPI algorithm is explained here:
  * \sa class TrainPI
+ *
+ * With the init parameter OOC_TILE_ROWS the states are stored out of
+ * core, as described in class TrainPI.
+ *
+ * If LS_MIXED_PRECISION is set to 1, the states are still simulated and
+ * collected in the precision of the network, but the gram matrices
+ * M.T*M and M.T*O are accumulated and solved (Cholesky) in double
+ * precision. Afterwards LS_REFINEMENT_STEPS (default 2) steps of
+ * iterative refinement with double precision residuals are performed.
+ * Like that a single precision network gets double precision output
+ * weights and avoids the precision problems of xGELS with floats.
+ * \note the collected states must have full rank, otherwise use
+ *       TrainPI or TrainRidgeReg
  */
 template <typename T>
 class TrainLS : public TrainBase<T>
@@ -172,6 +336,8 @@ class TrainLS : public TrainBase<T>
   using TrainBase<T>::esn_;
   using TrainBase<T>::M;
   using TrainBase<T>::O;
+  using TrainBase<T>::Mt;
+  using TrainBase<T>::Ot;
 
  public:
   TrainLS(ESN<T> *esn) : TrainBase<T>(esn) {}
@@ -181,6 +347,35 @@ class TrainLS : public TrainBase<T>
   virtual void train(const typename ESN<T>::DEMatrix &in,
                      const typename ESN<T>::DEMatrix &out,
                      int washout) throw(AUExcept);
+
+  /// weight computation from the collected states
+  virtual void computeWeights() throw(AUExcept);
+
+  /// M and O can be stored out of core with OOC_TILE_ROWS
+  virtual bool supportsOutOfCore() { return true; }
+ protected:
+
+  /// nr of rows of M which are converted to double precision at once
+  enum { BLOCKROWS = 1024 };
+
+  /*!
+   * double precision solve of the normal equations with iterative
+   * refinement, the output activation must already be undone
+   * @param refinements nr of iterative refinement steps
+   */
+  void solveMixedPrecision(int refinements) throw(AUExcept);
+
+  /// @return nr of row blocks of the collected data
+  int numRowBlocks();
+
+  /*!
+   * copies a row block of the collected data to double precision
+   * @param b nr of the row block (1 .. numRowBlocks())
+   * @param Mb will be resized to (rows x M.numCols())
+   * @param Ob will be resized to (rows x outputs)
+   */
+  void copyRowBlock(int b, DEMatrix<double>::Type &Mb,
+                    DEMatrix<double>::Type &Ob);
 };
 
 /*!
@@ -221,6 +416,282 @@ class TrainRidgeReg : public TrainBase<T>
   virtual void train(const typename ESN<T>::DEMatrix &in,
                      const typename ESN<T>::DEMatrix &out,
                      int washout) throw(AUExcept);
+
+  /// weight computation from the collected states
+  virtual void computeWeights() throw(AUExcept);
+
+  /*!
+   * calculates the output weights for a whole vector of regularization
+   * factors (a regularization path), the network is teacher forced only
+   * once and all readouts are computed from one eigendecomposition
+   * of the gram matrix M.T*M
+   *
+   * @param in matrix of input values (inputs x timesteps)
+   * @param out matrix of desired output values (outputs x timesteps)
+   *            for teacher forcing
+   * @param washout washout time in samples
+   * @param alphas vector of regularization factors (like TIKHONOV_FACTOR)
+   * @param Wouts output weights for all factors, rows (k-1)*outputs+1
+   *              to k*outputs are the weights for alphas(k),
+   *              size = (alphas.length()*outputs x neurons+inputs)
+   */
+  void trainPath(const typename ESN<T>::DEMatrix &in,
+                 const typename ESN<T>::DEMatrix &out,
+                 int washout,
+                 const typename ESN<T>::DEVector &alphas,
+                 typename ESN<T>::DEMatrix &Wouts) throw(AUExcept);
+
+ protected:
+
+  /*!
+   * solves (G + alpha*I) * X = B with a Cholesky factorization and
+   * stores X.T in Wout, falls back to the eigendecomposition if the
+   * regularized gram matrix is not positive definite
+   * \attention G and B will be overwritten
+   */
+  void ridgeSolve(typename ESN<T>::DEMatrix &G,
+                  typename ESN<T>::DEMatrix &B, T alpha) throw(AUExcept);
+
+  /*!
+   * calculates the ridge regression weights from an eigendecomposition
+   * G = V * diag(lambda) * V.T of the gram matrix
+   * @param V eigenvectors of G
+   * @param lambda eigenvalues of G
+   * @param C projected targets V.T * M.T * O
+   * @param alpha squared regularization factor
+   * @param W output weights, size = (outputs x neurons+inputs)
+   */
+  void eigenSolve(const typename ESN<T>::DEMatrix &V,
+                  const typename ESN<T>::DEVector &lambda,
+                  const typename ESN<T>::DEMatrix &C, T alpha,
+                  typename ESN<T>::DEMatrix &W);
+};
+
+/*!
+ * \class TrainRidgeRegCV
+ *
+ * \brief ridge regression with K-fold cross-validation of TIKHONOV_FACTOR
+ *
+ * Collects the network states only once and chooses the regularization
+ * factor with the smallest mean validation error from a logarithmic
+ * spaced grid between CV_TIKHONOV_MIN and CV_TIKHONOV_MAX
+ * (CV_TIKHONOV_STEPS values, default 10).
+ * The data is split into CV_FOLDS (default 5) contiguous blocks in time.
+ *
+ * For each fold k only the gram blocks Gk = Mk.T*Mk and Bk = Mk.T*Ok are
+ * stored. The training system of a fold is (G-Gk, B-Bk), which is
+ * eigendecomposed once and then solved for all factors, and the
+ * validation error |Ok - Mk*X|^2 = |Ok|^2 - 2*sum(X.*Bk) + sum(X.*(Gk*X))
+ * is calculated without the states of the fold.
+ *
+ * Afterwards TIKHONOV_FACTOR is set to the best value and the output
+ * weights are trained with all data as in TrainRidgeReg.
+ * The validation errors (mean squared errors, before the output
+ * activation function) can be queried with ESN::getCVErrors().
+ * \sa class TrainRidgeReg
+ */
+template <typename T>
+class TrainRidgeRegCV : public TrainRidgeReg<T>
+{
+  using TrainBase<T>::esn_;
+  using TrainBase<T>::M;
+  using TrainBase<T>::O;
+
+ public:
+  TrainRidgeRegCV(ESN<T> *esn) : TrainRidgeReg<T>(esn) {}
+  virtual ~TrainRidgeRegCV() {}
+
+  /// training algorithm
+  virtual void train(const typename ESN<T>::DEMatrix &in,
+                     const typename ESN<T>::DEMatrix &out,
+                     int washout) throw(AUExcept);
+
+  /// weight computation from the collected states
+  virtual void computeWeights() throw(AUExcept);
+
+  /*!
+   * @return table of validation errors from the last training,
+   *         size = (CV_TIKHONOV_STEPS x CV_FOLDS+1), first column is
+   *         the regularization factor, the other columns are the mean
+   *         squared errors of each fold
+   */
+  virtual typename ESN<T>::DEMatrix getCVErrors() throw(AUExcept);
+
+ protected:
+
+  /// validation errors of the last training
+  typename ESN<T>::DEMatrix cv_errors_;
+};
+
+/*!
+ * \class TrainRLS
+ *
+ * \brief online training with the recursive least squares algorithm
+ *
+ * Updates the output weights after each simulation step, so an ESN can
+ * be adapted continuously to a stream of targets (see ESN::trainOnline
+ * and ESN::trainStep). In combination with output feedback this is
+ * FORCE learning as in "Generating coherent patterns of activity from
+ * chaotic neural networks" by Sussillo and Abbott.
+ *
+ * RLS_LAMBDA is the forgetting factor within (0|1] (default 1) and the
+ * inverse correlation matrix P is initialized with I/RLS_DELTA
+ * (default RLS_DELTA = 1). With RLS_LAMBDA = 1 and zero initial weights
+ * this converges to ridge regression with TIKHONOV_FACTOR^2 = RLS_DELTA.
+ * Both parameters are read only after they were changed with
+ * ESN::setInitParam, a new RLS_LAMBDA is used from the next step on,
+ * a new RLS_DELTA reinitializes P.
+ * P is also reinitialized by train(), ESN::init() and ESN::load() and
+ * if the size of the network changes.
+ *
+ * P is symmetric and only its upper triangle is stored in packed format
+ * as P = s*Q, so that one timestep is a packed matrix-vector product and
+ * a packed rank-1 update of Q (BLAS xSPMV and xSPR) and a rank-1 update of
+ * the output weights (xGER), the forgetting factor only changes s.
+ *
+ * With train() the algorithm runs offline over the teacher forced
+ * sequence, starting with zero output weights.
+ * \note delay&sum readouts (SIM_FILTER_DS, SIM_SQUARE) are not supported
+ */
+template <typename T>
+class TrainRLS : public TrainBase<T>
+{
+  using TrainBase<T>::esn_;
+
+ public:
+  TrainRLS(ESN<T> *esn)
+    : TrainBase<T>(esn), reset_(true), read_params_(true) {}
+  virtual ~TrainRLS() {}
+
+  /// offline training algorithm
+  virtual void train(const typename ESN<T>::DEMatrix &in,
+                     const typename ESN<T>::DEMatrix &out,
+                     int washout) throw(AUExcept);
+
+  /// online training step
+  virtual void trainStep(const T *in, const T *target) throw(AUExcept);
+
+  /// reinitializes the inverse correlation matrix in the next step
+  virtual void resetOnline() { reset_ = true; }
+
+  /// reads RLS_LAMBDA and RLS_DELTA again in the next step
+  virtual void initParamsChanged() { read_params_ = true; }
+
+ protected:
+
+  /// reads and checks RLS_LAMBDA and RLS_DELTA
+  void readParams(T &lambda, T &delta) throw(AUExcept);
+
+  /// (re)initializes the inverse correlation matrix and work data
+  void reset() throw(AUExcept);
+
+  /// packed upper triangle of Q, where P = s*Q
+  typename ESN<T>::DEVector Q_;
+  /// scaling of the inverse correlation matrix
+  T s_;
+  /// forgetting factor
+  T lambda_;
+  /// initialization of the inverse correlation matrix, P = I/delta
+  T delta_;
+  /// reinitialize P in the next step
+  bool reset_;
+  /// read RLS_LAMBDA and RLS_DELTA in the next step
+  bool read_params_;
+
+  /// extended state vector (neurons+inputs)
+  typename ESN<T>::DEVector z_;
+  /// Q*z and gain vector
+  typename ESN<T>::DEVector u_;
+  /// a priori error
+  typename ESN<T>::DEVector e_;
+};
+
+/*!
+ * \class TrainNLMS
+ *
+ * \brief online training with the normalized least mean squares algorithm
+ *
+ * Adapts the output weights after each timestep with
+ * Wout = Wout + NLMS_MU / |z|^2 * e * z.T, where z = [x; in] and e is the
+ * a priori error before the output activation function.
+ * NLMS_MU should be within (0|2) for stability.
+ *
+ * One update costs O((neurons+inputs)*outputs) and is calculated inside
+ * the simulation loop of SimStd and SimFilter, right after the readout
+ * (see SimBase::setAdaptTarget), no memory is allocated there, so it can
+ * be used in realtime with ESN::trainStep.
+ * The network output (before the weight update) is used as feedback.
+ *
+ * With train() the algorithm runs once over the teacher forced sequence,
+ * starting with the current output weights, so it can be called
+ * repeatedly for more epochs.
+ * \note only SIM_STD and SIM_FILTER are supported
+ */
+template <typename T>
+class TrainNLMS : public TrainBase<T>
+{
+  using TrainBase<T>::esn_;
+
+ public:
+  TrainNLMS(ESN<T> *esn) : TrainBase<T>(esn) {}
+  virtual ~TrainNLMS() {}
+
+  /// offline training algorithm
+  virtual void train(const typename ESN<T>::DEMatrix &in,
+                     const typename ESN<T>::DEMatrix &out,
+                     int washout) throw(AUExcept);
+
+  /// online training, fused with the simulation algorithm
+  virtual void trainOnline(const typename ESN<T>::DEMatrix &in,
+                           const typename ESN<T>::DEMatrix &target,
+                           typename ESN<T>::DEMatrix &out) throw(AUExcept);
+
+ protected:
+
+  /// checks simulation algorithm and returns the learnrate
+  T learnrate() throw(AUExcept);
+};
+
+/*!
+ * \class TrainLasso
+ *
+ * \brief offline training of a sparse readout with L1 regularization
+ *
+ * Minimizes 1/(2N) * |M*w - o|^2 + LASSO_LAMBDA * |w|_1 for each output
+ * (LASSO), so that many output weights become exactly zero.
+ * The solution is calculated with cyclic coordinate descent on the
+ * gram matrices M.T*M and M.T*O, which are computed only once, the
+ * outputs are calculated in parallel (with OpenMP).
+ * The iterations stop after LASSO_ITERATIONS sweeps (default 1000) or
+ * if the largest weight change of a sweep is below LASSO_TOLERANCE
+ * (default 1e-6) times the largest weight.
+ *
+ * If at most half of the output weights are nonzero, the simulation
+ * algorithms only use the nonzero taps in a compressed readout and
+ * SimFilterDS skips the delaylines of zero weights.
+ * \sa SimBase::compressReadout
+ *
+ * \sa "Regularization Paths for Generalized Linear Models via Coordinate
+ *      Descent" by Jerome Friedman, Trevor Hastie and Rob Tibshirani
+ */
+template <typename T>
+class TrainLasso : public TrainBase<T>
+{
+  using TrainBase<T>::esn_;
+  using TrainBase<T>::M;
+  using TrainBase<T>::O;
+
+ public:
+  TrainLasso(ESN<T> *esn) : TrainBase<T>(esn) {}
+  virtual ~TrainLasso() {}
+
+  /// training algorithm
+  virtual void train(const typename ESN<T>::DEMatrix &in,
+                     const typename ESN<T>::DEMatrix &out,
+                     int washout) throw(AUExcept);
+
+  /// weight computation from the collected states
+  virtual void computeWeights() throw(AUExcept);
 };
 
 /*!
@@ -237,6 +708,26 @@ class TrainRidgeReg : public TrainBase<T>
  * (Georg Holzmann, 2008).
  * \sa http://grh.mur.at/misc/ESNsWithFilterNeuronsAndDSReadout.pdf
  *
+ * All outputs are independent after the states are collected, therefore
+ * delays and weights of the outputs are calculated in parallel if the
+ * library is compiled with OpenMP (scons openmp=1).
+ *
+ * Delayed neuron signals are offset views into the collected states M.
+ * For the final least squares solve the delayed rows are gathered in
+ * blocks of BLOCKROWS rows and reduced with a QR factorization, so the
+ * peak memory is M plus (BLOCKROWS+2*L)*L values per thread, with
+ * L = neurons+inputs (doubled with SIM_SQUARE).
+ *
+ * The EM delay learning (DS_EM_ITERATIONS > 0) stops before the maximum
+ * number of iterations if no delay changed and the sum of absolute weight
+ * changes is <= DS_EM_TOLERANCE (default 0). Diagnostics of each
+ * iteration can be received with ESN::setEMCallback.
+ * With GCC the spectrum of the residual is updated together with the
+ * residual itself. The spectra of all undelayed neuron signals are
+ * calculated once and shared by all threads (L*(fftsize/2+1) complex
+ * values), the spectrum of a delayed neuron signal is calculated when
+ * it is needed, so each thread only needs a few spectra of one signal.
+ *
  * \example "singleneuron_sinosc.py"
  */
 template <typename T>
@@ -268,6 +759,23 @@ class TrainDSPI : public TrainBase<T>
                        int washout, int steps, int maxdelay,  int filter,
 		       int emiters) throw(AUExcept);
 
+  /// nr of delayed rows which are gathered at once in solveDelayed
+  enum { BLOCKROWS = 1024 };
+
+  /*!
+   * least squares solve of the output weights of one output with the
+   * delayed columns of M, the delayed rows are gathered in blocks of
+   * BLOCKROWS rows and reduced with a TSQR like in tsqr(), so the
+   * scratch memory does not depend on the nr of timesteps
+   * @param n output (1 .. outputs)
+   * @param delays delays of all columns of M for this output
+   * @param On desired output without output activation (rows x 1)
+   * @param washout washout time in samples
+   * @param square add the squared delayed columns for SIM_SQUARE
+   */
+  void solveDelayed(int n, const int *delays,
+                    const typename DEMatrix<T>::Type &On,
+                    int washout, bool square) throw(AUExcept);
 };
 
 } // end of namespace aureservoir
@@ -63,132 +63,1045 @@ void TrainBase<T>::checkParams(const typename ESN<T>::DEMatrix &in,
 template <typename T>
 void TrainBase<T>::collectStates(const typename ESN<T>::DEMatrix &in,
                                  const typename ESN<T>::DEMatrix &out,
-                                 int washout)
+                                 int washout, int tilerows)
 {
   int steps = in.numCols();
 
-  // collects output of all timesteps in O
-  O.resize(steps-washout, esn_->outputs_);
+  // collects reservoir activations and inputs of all timesteps in M
+  // (for squared algorithm we need a bigger matrix)
+  // and output of all timesteps in O
+  if( esn_->net_info_[ESN<T>::SIMULATE_ALG] != SIM_SQUARE )
+    allocateData(steps-washout, esn_->neurons_+esn_->inputs_, tilerows);
+  else
+    allocateData(steps-washout, 2*(esn_->neurons_+esn_->inputs_), tilerows);
+
+  collectEpisode(*esn_, in, out, washout, 0);
+}
+
+template <typename T>
+void TrainBase<T>::allocateData(int rows, int cols, int tilerows)
+  throw(AUExcept)
+{
+  if( tilerows > 0 )
+  {
+    M.resize(1,1);
+    O.resize(1,1);
+    Mt.resize(rows, cols, tilerows);
+    Ot.resize(rows, esn_->outputs_, tilerows);
+  }
+  else
+  {
+    Mt.clear();
+    Ot.clear();
+    M.resize(rows, cols);
+    O.resize(rows, esn_->outputs_);
+  }
+}
+
+template <typename T>
+void TrainBase<T>::collectEpisode(ESN<T> &net,
+                                  const typename ESN<T>::DEMatrix &in,
+                                  const typename ESN<T>::DEMatrix &out,
+                                  int washout, int row)
+{
+  int steps = in.numCols();
+
+  typename ESN<T>::DEMatrix sim_in(net.inputs_ ,1),
+                            sim_out(net.outputs_ ,1);
+  for(int n=1; n<=steps; ++n)
+  {
+    sim_in(_,1) = in(_,n);
+    net.simulate(sim_in, sim_out);
+
+    // for teacherforcing with feedback in single step simulation
+    // we need to set the correct last output
+    net.sim_->last_out_(_,1) = out(_,n);
+
+//     std::cout << net.x_ << std::endl;
+
+    // store internal states, inputs and outputs after washout
+    if( n > washout && Mt.numRows() > 0 )
+    {
+      // out of core storage
+      int i = row+n-washout;
+      for(int j=1; j<=net.neurons_; ++j)
+        Mt(i,j) = net.x_(j);
+      for(int j=1; j<=net.inputs_; ++j)
+        Mt(i,net.neurons_+j) = sim_in(j,1);
+      for(int j=1; j<=net.outputs_; ++j)
+        Ot(i,j) = out(j,n);
+    }
+    else if( n > washout )
+    {
+      M(row+n-washout,_(1,net.neurons_)) = net.x_;
+      M(row+n-washout,_(net.neurons_+1,net.neurons_+net.inputs_)) =
+      sim_in(_,1);
+
+      // collect desired outputs
+      for(int i=1; i<=net.outputs_; ++i)
+        O(row+n-washout,i) = out(i,n);
+    }
+  }
+}
+
+template <typename T>
+void TrainBase<T>::collectEpisodes(
+                     const std::vector<typename ESN<T>::DEMatrix> &ins,
+                     const std::vector<typename ESN<T>::DEMatrix> &outs,
+                     const std::vector<int> &washouts,
+                     int tilerows)
+  throw(AUExcept)
+{
+  int episodes = ins.size();
+
+  // check data size
+  if( episodes < 1 )
+    throw AUExcept("TrainBase::trainEpisodes: you need at least one episode!");
+  if( (int) outs.size() != episodes || (int) washouts.size() != episodes )
+    throw AUExcept("TrainBase::trainEpisodes: need inputs, outputs and washout for each episode!");
+
+  // row offsets of all episodes in M and O
+  std::vector<int> rows(episodes+1, 0);
+  for(int k=0; k<episodes; ++k)
+  {
+    if( ins[k].numCols() != outs[k].numCols() )
+      throw AUExcept("TrainBase::trainEpisodes: input and output must be same column size!");
+    if( ins[k].numRows() != esn_->inputs_ )
+      throw AUExcept("TrainBase::trainEpisodes: wrong input row size!");
+    if( outs[k].numRows() != esn_->outputs_ )
+      throw AUExcept("TrainBase::trainEpisodes: wrong output row size!");
+    if( washouts[k] < 0 || washouts[k] >= ins[k].numCols() )
+      throw AUExcept("TrainBase::trainEpisodes: washout must be shorter than the episode!");
+
+    rows[k+1] = rows[k] + ins[k].numCols() - washouts[k];
+  }
+
+  // check if we have enough training data
+  int cols = esn_->neurons_+esn_->inputs_;
+  if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
+    cols *= 2;
+  if( rows[episodes] < cols )
+    throw AUExcept("TrainBase::trainEpisodes: too few training data!");
+
+  // check if we have an Wout matrix
+  if( esn_->Wout_.numRows() == 0 || esn_->Wout_.numCols() == 0 )
+    throw AUExcept("TrainBase::trainEpisodes: you need to have a Wout matrix, so init the net or set Wout manually!");
+
+  esn_->sim_->reallocate();
+
+  allocateData(rows[episodes], cols, tilerows);
+
+  // copies of the network have the same random numbers, so each episode
+  // gets its own stream for the noise (independent of the thread)
+  unsigned long long seed = esn_->rand_.next();
+
+  // the episodes write into disjoint rows of M and O, each episode
+  // gets a fresh copy of the network, so that also the filter and
+  // delay line memory of the simulation algorithm does not depend on
+  // the episodes a thread simulated before
+  #pragma omp parallel for schedule(dynamic)
+  for(int k=0; k<episodes; ++k)
+  {
+    ESN<T> net(*esn_);
+    net.setSeed( RandomStream::derive(seed, k) );
+    net.sim_->reallocate();
+    net.resetState();
+    collectEpisode(net, ins[k], outs[k], washouts[k], rows[k]);
+  }
+}
+
+template <typename T>
+void TrainBase<T>::computeWeights()
+  throw(AUExcept)
+{
+  std::string str = "TrainBase::computeWeights: ";
+  str += "this is only available with offline training algorithms, ";
+  str += "e.g. TRAIN_PI or TRAIN_RIDGEREG !";
+
+  throw AUExcept( str );
+}
+
+template <typename T>
+void TrainBase<T>::trainEpisodes(
+                     const std::vector<typename ESN<T>::DEMatrix> &ins,
+                     const std::vector<typename ESN<T>::DEMatrix> &outs,
+                     const std::vector<int> &washouts)
+  throw(AUExcept)
+{
+  // 1. teacher forcing, collect states of all episodes
+  collectEpisodes(ins, outs, washouts, tileRows());
+
+  // 2. offline weight computation
+  try
+  {
+    computeWeights();
+  }
+  catch(AUExcept &e)
+  {
+    clearData();
+    throw;
+  }
+}
+
+template <typename T>
+void TrainBase<T>::squareStates()
+{
+  // add additional squared states and inputs
+  /// \todo vectorize that
+  int Msize = esn_->neurons_+esn_->inputs_;
+
+  if( Mt.numRows() > 0 )
+  {
+    // out of core storage, square each tile
+    for(int t=1; t<=Mt.numTiles(); ++t)
+    {
+      T *tile = Mt.tile(t);
+      int rows = Mt.tileRows(t);
+      for(int j=0; j<Msize; ++j) {
+      for(int i=0; i<rows; ++i) {
+        tile[(j+Msize)*rows+i] = pow( tile[j*rows+i], 2 );
+      } }
+    }
+    return;
+  }
+
+  int Mrows = M.numRows();
+  for(int i=1; i<=Mrows; ++i) {
+  for(int j=1; j<=Msize; ++j) {
+    M(i,j+Msize) = pow( M(i,j), 2 );
+  } }
+}
+
+template <typename T>
+void TrainBase<T>::gramMatrices(typename ESN<T>::DEMatrix &G,
+                                typename ESN<T>::DEMatrix &B)
+{
+  G.resizeOrClear(M.numCols(), M.numCols());
+  B.resizeOrClear(M.numCols(), O.numCols());
+
+  // M.T * M and M.T * O
+  G = flens::transpose(M)*M;
+  B = flens::transpose(M)*O;
+}
+
+template <typename T>
+int TrainBase<T>::tileRows()
+{
+  if( !supportsOutOfCore() ||
+      esn_->init_params_.find(OOC_TILE_ROWS) == esn_->init_params_.end() )
+    return 0;
+
+  return (int) esn_->init_params_[OOC_TILE_ROWS];
+}
+
+template <typename T>
+void TrainBase<T>::trainOnline(const typename ESN<T>::DEMatrix &in,
+                               const typename ESN<T>::DEMatrix &target,
+                               typename ESN<T>::DEMatrix &out)
+  throw(AUExcept)
+{
+  int steps = in.numCols();
+
+  // allocate buffers only once
+  if( step_in_.numRows() != esn_->inputs_ ||
+      step_out_.numRows() != esn_->outputs_ )
+  {
+    step_in_.resize(esn_->inputs_,1);
+    step_out_.resize(esn_->outputs_,1);
+  }
+
+  for(int n=1; n<=steps; ++n)
+  {
+    step_in_(_,1) = in(_,n);
+    esn_->simulate(step_in_, step_out_);
+    trainStep( step_in_.data(), &target(1,n) );
+    out(_,n) = step_out_(_,1);
+  }
+}
+
+template <typename T>
+void TrainBase<T>::trainStep(const T *in, const T *target)
+  throw(AUExcept)
+{
+  std::string str = "TrainBase::trainStep: ";
+  str += "this is only available with online training algorithms, ";
+  str += "e.g. TRAIN_RLS !";
+
+  throw AUExcept( str );
+}
+
+template <typename T>
+typename ESN<T>::DEMatrix TrainBase<T>::getCVErrors()
+  throw(AUExcept)
+{
+  std::string str = "TrainBase::getCVErrors: ";
+  str += "this is only available with cross-validated training, ";
+  str += "e.g. TRAIN_RIDGEREG_CV !";
+
+  throw AUExcept( str );
+}
+
+//@}
+//! @name class TrainPI Implementation
+//@{
+
+template <typename T>
+void TrainPI<T>::train(const typename ESN<T>::DEMatrix &in,
+                       const typename ESN<T>::DEMatrix &out,
+                       int washout)
+  throw(AUExcept)
+{
+  this->checkParams(in,out,washout);
+
+  // 1. teacher forcing, collect states
+  this->collectStates(in,out,washout,this->tileRows());
+
+  // 2. offline weight computation
+  computeWeights();
+}
+
+template <typename T>
+void TrainPI<T>::computeWeights()
+  throw(AUExcept)
+{
+  // add additional squared states when using SIM_SQUARE
+  if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
+    this->squareStates();
+
+  if( Mt.numRows() > 0 )
+  {
+    // undo output activation function
+    for(int t=1; t<=Ot.numTiles(); ++t)
+      esn_->outputInvAct_( Ot.tile(t), Ot.tileRows(t)*Ot.numCols() );
+
+    // reduce the out of core data to M = Q*R, C = Q.T*O
+    typename ESN<T>::DEMatrix R, C;
+    tsqr(Mt, Ot, R, C);
+
+    // calc weights with pseudo inv: Wout_ = (R^-1) * C
+    flens::lss( R, C );
+    esn_->Wout_ = flens::transpose( C );
+
+    this->clearData();
+    return;
+  }
+
+  // undo output activation function
+  esn_->outputInvAct_( O.data(), O.numRows()*O.numCols() );
+
+  // calc weights with pseudo inv: Wout_ = (M^-1) * O
+  flens::lss( M, O );
+  esn_->Wout_ = flens::transpose( O(_( 1, M.numCols() ),_) );
+
+  this->clearData();
+}
+
+//@}
+//! @name class TrainLS Implementation
+//@{
+
+template <typename T>
+void TrainLS<T>::train(const typename ESN<T>::DEMatrix &in,
+                       const typename ESN<T>::DEMatrix &out,
+                       int washout)
+  throw(AUExcept)
+{
+  this->checkParams(in,out,washout);
+
+  // 1. teacher forcing, collect states
+  this->collectStates(in,out,washout,this->tileRows());
+
+  // 2. offline weight computation
+  computeWeights();
+}
+
+template <typename T>
+void TrainLS<T>::computeWeights()
+  throw(AUExcept)
+{
+  // add additional squared states when using SIM_SQUARE
+  if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
+    this->squareStates();
+
+  // undo output activation function
+  if( Mt.numRows() > 0 )
+  {
+    for(int t=1; t<=Ot.numTiles(); ++t)
+      esn_->outputInvAct_( Ot.tile(t), Ot.tileRows(t)*Ot.numCols() );
+  }
+  else
+    esn_->outputInvAct_( O.data(), O.numRows()*O.numCols() );
+
+  // double precision solve
+  if( esn_->init_params_.find(LS_MIXED_PRECISION) != esn_->init_params_.end()
+      && esn_->init_params_[LS_MIXED_PRECISION] != 0 )
+  {
+    int refinements = 2;
+    if( esn_->init_params_.find(LS_REFINEMENT_STEPS) !=
+        esn_->init_params_.end() )
+      refinements = (int) esn_->init_params_[LS_REFINEMENT_STEPS];
+
+    try
+    {
+      solveMixedPrecision(refinements);
+    }
+    catch(AUExcept &e)
+    {
+      this->clearData();
+      throw;
+    }
+
+    this->clearData();
+    return;
+  }
+
+  if( Mt.numRows() > 0 )
+  {
+    // reduce the out of core data to M = Q*R, C = Q.T*O
+    typename ESN<T>::DEMatrix R, C;
+    tsqr(Mt, Ot, R, C);
+
+    // calc weights with least square solver: Wout_ = (R^-1) * C
+    flens::ls( flens::NoTrans, R, C );
+    esn_->Wout_ = flens::transpose( C );
+
+    this->clearData();
+    return;
+  }
+
+  // calc weights with least square solver: Wout_ = (M^-1) * O
+  flens::ls( flens::NoTrans, M, O );
+  esn_->Wout_ = flens::transpose( O(_( 1, M.numCols() ),_) );
+
+  this->clearData();
+}
+
+template <typename T>
+int TrainLS<T>::numRowBlocks()
+{
+  if( Mt.numRows() > 0 )
+    return Mt.numTiles();
+
+  return (M.numRows() + BLOCKROWS - 1) / BLOCKROWS;
+}
+
+template <typename T>
+void TrainLS<T>::copyRowBlock(int b, DEMatrix<double>::Type &Mb,
+                              DEMatrix<double>::Type &Ob)
+{
+  const T *m, *o;
+  int rows, ldm, ldo;
+
+  if( Mt.numRows() > 0 )
+  {
+    // one tile of the out of core storage
+    m = Mt.tile(b);
+    o = Ot.tile(b);
+    rows = ldm = ldo = Mt.tileRows(b);
+  }
+  else
+  {
+    // BLOCKROWS rows of M and O
+    int first = (b-1)*BLOCKROWS;
+    rows = std::min((int) BLOCKROWS, M.numRows()-first);
+    m = M.data() + first;
+    o = O.data() + first;
+    ldm = M.numRows();
+    ldo = O.numRows();
+  }
+
+  int cols = Mt.numRows() > 0 ? Mt.numCols() : M.numCols();
+  if( Mb.numRows() != rows )
+  {
+    Mb.resize(rows, cols);
+    Ob.resize(rows, esn_->outputs_);
+  }
+
+  for(int j=0; j<cols; ++j)
+    std::copy( m+j*ldm, m+j*ldm+rows, Mb.data()+j*rows );
+  for(int j=0; j<esn_->outputs_; ++j)
+    std::copy( o+j*ldo, o+j*ldo+rows, Ob.data()+j*rows );
+}
+
+template <typename T>
+void TrainLS<T>::solveMixedPrecision(int refinements)
+  throw(AUExcept)
+{
+  int n = Mt.numRows() > 0 ? Mt.numCols() : M.numCols();
+  int k = esn_->outputs_;
+  int blocks = numRowBlocks();
+
+  DEMatrix<double>::Type G(n,n), B(n,k), W(n,k), Mb, Ob;
+  std::fill_n( G.data(), n*n, 0. );
+  std::fill_n( B.data(), n*k, 0. );
+
+  // gram matrices M.T*M and M.T*O in double precision
+  for(int b=1; b<=blocks; ++b)
+  {
+    copyRowBlock(b, Mb, Ob);
+    int rows = Mb.numRows();
+    syrk(n, rows, 1., Mb.data(), 1., G.data());
+    gemm(true, n, k, rows, 1., Mb.data(), Ob.data(), 1., B.data());
+  }
+
+  // Cholesky solve: W = (M.T*M)^-1 * M.T*O
+  if( potrf(G) != 0 )
+    throw AUExcept("TrainLS::train: collected states are rank deficient, use TRAIN_PI or TRAIN_RIDGEREG !");
+  W = B;
+  if( potrs(G, W) != 0 )
+    throw AUExcept("TrainLS::train: Cholesky solve failed!");
+
+  // iterative refinement: W += (M.T*M)^-1 * M.T*(O - M*W)
+  for(int s=0; s<refinements; ++s)
+  {
+    std::fill_n( B.data(), n*k, 0. );
+    for(int b=1; b<=blocks; ++b)
+    {
+      copyRowBlock(b, Mb, Ob);
+      int rows = Mb.numRows();
+      gemm(false, rows, k, n, -1., Mb.data(), W.data(), 1., Ob.data());
+      gemm(true, n, k, rows, 1., Mb.data(), Ob.data(), 1., B.data());
+    }
+    if( potrs(G, B) != 0 )
+      throw AUExcept("TrainLS::train: Cholesky solve failed!");
+
+    for(int j=1; j<=k; ++j) {
+    for(int i=1; i<=n; ++i) {
+      W(i,j) += B(i,j);
+    } }
+  }
+
+  esn_->Wout_.resizeOrClear(k, n);
+  for(int i=1; i<=k; ++i) {
+  for(int j=1; j<=n; ++j) {
+    esn_->Wout_(i,j) = (T) W(j,i);
+  } }
+}
+
+//@}
+//! @name class TrainRidgeReg Implementation
+//@{
+
+template <typename T>
+void TrainRidgeReg<T>::train(const typename ESN<T>::DEMatrix &in,
+                       const typename ESN<T>::DEMatrix &out,
+                       int washout)
+  throw(AUExcept)
+{
+  this->checkParams(in,out,washout);
+
+  // 1. teacher forcing, collect states
+  this->collectStates(in,out,washout);
+
+  // 2. offline weight computation
+  computeWeights();
+}
+
+template <typename T>
+void TrainRidgeReg<T>::computeWeights()
+  throw(AUExcept)
+{
+  // add additional squared states when using SIM_SQUARE
+  if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
+    this->squareStates();
+
+  // undo output activation function
+  esn_->outputInvAct_( O.data(), O.numRows()*O.numCols() );
+
+
+  // calc weights with ridge regression (.T = transpose):
+  // Wout = ( (M.T*M + alpha^2*I)^-1 * M.T*O ).T
+  // the regularized gram matrix is factorized and solved against M.T*O,
+  // so neither the inverse nor the (N+I) x T product is formed
+
+  // get regularization factor and square it
+  T alpha = pow(esn_->init_params_[TIKHONOV_FACTOR],2);
+
+  typename ESN<T>::DEMatrix G, B;
+  this->gramMatrices(G, B);
+  this->clearData();
+
+  ridgeSolve(G, B, alpha);
+}
+
+template <typename T>
+void TrainRidgeReg<T>::trainPath(const typename ESN<T>::DEMatrix &in,
+                                 const typename ESN<T>::DEMatrix &out,
+                                 int washout,
+                                 const typename ESN<T>::DEVector &alphas,
+                                 typename ESN<T>::DEMatrix &Wouts)
+  throw(AUExcept)
+{
+  if( alphas.length() < 1 )
+    throw AUExcept("TrainRidgeReg::trainPath: you need at least one regularization factor!");
+
+  this->checkParams(in,out,washout);
+
+  // 1. teacher forcing, collect states
+  this->collectStates(in,out,washout);
+
+  // add additional squared states when using SIM_SQUARE
+  if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
+    this->squareStates();
+
+
+  // 2. offline weight computation for all regularization factors
+
+  // undo output activation function
+  esn_->outputInvAct_( O.data(), O.numRows()*O.numCols() );
+
+  typename ESN<T>::DEMatrix G, B;
+  this->gramMatrices(G, B);
+  this->clearData();
+
+  // eigendecomposition M.T*M = V * diag(lambda) * V.T, V overwrites G
+  typename ESN<T>::DEVector lambda;
+  if( syev(G, lambda) != 0 )
+    throw AUExcept("TrainRidgeReg::trainPath: eigendecomposition did not converge!");
+
+  // project targets: V.T * M.T*O
+  typename ESN<T>::DEMatrix C(B.numRows(), B.numCols());
+  C = flens::transpose(G)*B;
+
+  int outs = esn_->outputs_;
+  int cols = G.numCols();
+  Wouts.resizeOrClear(alphas.length()*outs, cols);
+
+  typename ESN<T>::DEMatrix W;
+  for(int k=1; k<=alphas.length(); ++k)
+  {
+    eigenSolve(G, lambda, C, pow(alphas(k),2), W);
+
+    for(int i=1; i<=outs; ++i) {
+    for(int j=1; j<=cols; ++j) {
+      Wouts((k-1)*outs+i, j) = W(i,j);
+    } }
+  }
+}
+
+template <typename T>
+void TrainRidgeReg<T>::ridgeSolve(typename ESN<T>::DEMatrix &G,
+                                  typename ESN<T>::DEMatrix &B, T alpha)
+  throw(AUExcept)
+{
+  // G + alpha*I, alpha is already the squared TIKHONOV_FACTOR
+  typename ESN<T>::DEMatrix L = G;
+  for(int i=1; i<=L.numRows(); ++i)
+    L(i,i) += alpha;
+
+  // Cholesky factorization and forward/backward substitution
+  if( potrf(L) == 0 )
+  {
+    if( potrs(L, B) != 0 )
+      throw AUExcept("TrainRidgeReg::train: Cholesky solve failed!");
+    esn_->Wout_ = flens::transpose(B);
+    return;
+  }
+
+  // not positive definite (e.g. TIKHONOV_FACTOR=0 and linear dependent
+  // states): use the eigendecomposition and ignore the null space
+  typename ESN<T>::DEVector lambda;
+  if( syev(G, lambda) != 0 )
+    throw AUExcept("TrainRidgeReg::train: eigendecomposition did not converge!");
+
+  typename ESN<T>::DEMatrix C(B.numRows(), B.numCols());
+  C = flens::transpose(G)*B;
+  eigenSolve(G, lambda, C, alpha, esn_->Wout_);
+}
+
+template <typename T>
+void TrainRidgeReg<T>::eigenSolve(const typename ESN<T>::DEMatrix &V,
+                                  const typename ESN<T>::DEVector &lambda,
+                                  const typename ESN<T>::DEMatrix &C,
+                                  T alpha, typename ESN<T>::DEMatrix &W)
+{
+  int n = C.numRows();
+  int outs = C.numCols();
+
+  // eigenvalues are in ascending order, so the last one is the largest
+  T tol = n * std::numeric_limits<T>::epsilon() * std::abs( lambda(n) );
+
+  // diag(1/(lambda+alpha)) * C
+  typename ESN<T>::DEMatrix S(n, outs);
+  for(int k=1; k<=n; ++k)
+  {
+    T d = ( lambda(k)+alpha > tol ) ? 1./(lambda(k)+alpha) : 0.;
+    for(int j=1; j<=outs; ++j)
+      S(k,j) = d * C(k,j);
+  }
+
+  // V * ans and transpose
+  typename ESN<T>::DEMatrix X(n, outs);
+  X = V*S;
+  W = flens::transpose(X);
+}
+
+//@}
+//! @name class TrainRidgeRegCV Implementation
+//@{
+
+template <typename T>
+void TrainRidgeRegCV<T>::train(const typename ESN<T>::DEMatrix &in,
+                               const typename ESN<T>::DEMatrix &out,
+                               int washout)
+  throw(AUExcept)
+{
+  this->checkParams(in,out,washout);
+
+  // 1. teacher forcing, collect states
+  this->collectStates(in,out,washout);
+
+  // 2. offline weight computation
+  computeWeights();
+}
+
+template <typename T>
+void TrainRidgeRegCV<T>::computeWeights()
+  throw(AUExcept)
+{
+  // get cross-validation parameters
+  int folds = 5;
+  if( esn_->init_params_.find(CV_FOLDS) != esn_->init_params_.end() )
+    folds = (int) esn_->init_params_[CV_FOLDS];
+  int steps = 10;
+  if( esn_->init_params_.find(CV_TIKHONOV_STEPS) != esn_->init_params_.end() )
+    steps = (int) esn_->init_params_[CV_TIKHONOV_STEPS];
+  T amin = esn_->init_params_[CV_TIKHONOV_MIN];
+  T amax = esn_->init_params_[CV_TIKHONOV_MAX];
+
+  if( folds < 2 )
+    throw AUExcept("TrainRidgeRegCV::train: CV_FOLDS must be >= 2 !");
+  if( steps < 1 )
+    throw AUExcept("TrainRidgeRegCV::train: CV_TIKHONOV_STEPS must be >= 1 !");
+  if( M.numRows() < folds )
+    throw AUExcept("TrainRidgeRegCV::train: too few training data for CV_FOLDS!");
+
+  // logarithmic spaced regularization factors
+  typename ESN<T>::DEVector alphas(steps);
+  for(int a=1; a<=steps; ++a)
+    alphas(a) = (steps==1) ? amin :
+                amin * pow( amax/amin, (T)(a-1)/(steps-1) );
+
+  // add additional squared states when using SIM_SQUARE
+  if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
+    this->squareStates();
+
+  // undo output activation function
+  esn_->outputInvAct_( O.data(), O.numRows()*O.numCols() );
+
+
+  // 2. gram blocks of all folds (contiguous blocks in time)
+
+  int rows = M.numRows();
+  int cols = M.numCols();
+  int outs = O.numCols();
+  std::vector<typename ESN<T>::DEMatrix> Gk(folds), Bk(folds);
+  std::vector<T> Onorm(folds);
+  std::vector<int> Orows(folds);
+
+  typename ESN<T>::DEMatrix G(cols,cols), B(cols,outs);
+  std::fill_n( G.data(), cols*cols, 0 );
+  std::fill_n( B.data(), cols*outs, 0 );
 
-  // collects reservoir activations and inputs of all timesteps in M
-  // (for squared algorithm we need a bigger matrix)
-  if( esn_->net_info_[ESN<T>::SIMULATE_ALG] != SIM_SQUARE )
-    M.resize(steps-washout, esn_->neurons_+esn_->inputs_);
-  else
-    M.resize(steps-washout, 2*(esn_->neurons_+esn_->inputs_));
+  for(int k=0; k<folds; ++k)
+  {
+    int r1 = k*rows/folds + 1;
+    int r2 = (k+1)*rows/folds;
+    typename ESN<T>::DEMatrix::View Mk = M( _(r1,r2), _ );
+    typename ESN<T>::DEMatrix::View Ok = O( _(r1,r2), _ );
+
+    Gk[k].resize(cols,cols);
+    Bk[k].resize(cols,outs);
+    Gk[k] = flens::transpose(Mk)*Mk;
+    Bk[k] = flens::transpose(Mk)*Ok;
+
+    // sum of all blocks is the gram matrix of the whole data
+    for(int i=0; i<cols*cols; ++i)
+      G.data()[i] += Gk[k].data()[i];
+    for(int i=0; i<cols*outs; ++i)
+      B.data()[i] += Bk[k].data()[i];
+
+    // squared norm of the fold targets
+    Onorm[k] = 0.;
+    for(int i=r1; i<=r2; ++i) {
+    for(int j=1; j<=outs; ++j) {
+      Onorm[k] += O(i,j)*O(i,j);
+    } }
+    Orows[k] = r2-r1+1;
+  }
 
+  this->clearData();
 
-  typename ESN<T>::DEMatrix sim_in(esn_->inputs_ ,1),
-                            sim_out(esn_->outputs_ ,1);
-  for(int n=1; n<=steps; ++n)
+
+  // 3. validation errors of all (fold, factor) pairs
+
+  cv_errors_.resizeOrClear(steps, folds+1);
+  for(int a=1; a<=steps; ++a)
+    cv_errors_(a,1) = alphas(a);
+
+  typename ESN<T>::DEMatrix V(cols,cols), Bt(cols,outs), C(cols,outs),
+                            GX(cols,outs), W;
+  typename ESN<T>::DEVector lambda;
+
+  for(int k=0; k<folds; ++k)
   {
-    sim_in(_,1) = in(_,n);
-    esn_->simulate(sim_in, sim_out);
+    // training system without fold k by block subtraction
+    for(int i=0; i<cols*cols; ++i)
+      V.data()[i] = G.data()[i] - Gk[k].data()[i];
+    for(int i=0; i<cols*outs; ++i)
+      Bt.data()[i] = B.data()[i] - Bk[k].data()[i];
+
+    // one eigendecomposition for all factors
+    if( syev(V, lambda) != 0 )
+      throw AUExcept("TrainRidgeRegCV::train: eigendecomposition did not converge!");
+    C = flens::transpose(V)*Bt;
+
+    for(int a=1; a<=steps; ++a)
+    {
+      this->eigenSolve(V, lambda, C, pow(alphas(a),2), W);
 
-    // for teacherforcing with feedback in single step simulation
-    // we need to set the correct last output
-    esn_->sim_->last_out_(_,1) = out(_,n);
+      // |Ok - Mk*X|^2 = |Ok|^2 - 2*sum(X.*Bk) + sum(X.*(Gk*X)), X = W.T
+      GX = Gk[k]*flens::transpose(W);
+      T err = Onorm[k];
+      for(int i=1; i<=cols; ++i) {
+      for(int j=1; j<=outs; ++j) {
+        err += W(j,i) * ( GX(i,j) - 2*Bk[k](i,j) );
+      } }
 
-//     std::cout << esn_->x_ << std::endl;
+      cv_errors_(a,k+2) = err / (Orows[k]*outs);
+    }
+  }
 
-    // store internal states, inputs and outputs after washout
-    if( n > washout )
+
+  // 4. train with the best factor and all data
+
+  int best = 1;
+  T besterr = 0.;
+  for(int a=1; a<=steps; ++a)
+  {
+    T err = 0.;
+    for(int k=0; k<folds; ++k)
+      err += cv_errors_(a,k+2);
+
+    if( a==1 || err < besterr )
     {
-      M(n-washout,_(1,esn_->neurons_)) = esn_->x_;
-      M(n-washout,_(esn_->neurons_+1,esn_->neurons_+esn_->inputs_)) =
-      sim_in(_,1);
+      best = a;
+      besterr = err;
     }
   }
 
-  // collect desired outputs
-  O = flens::transpose( out( _,_(washout+1,steps) ) );
+  esn_->init_params_[TIKHONOV_FACTOR] = alphas(best);
+  this->ridgeSolve(G, B, pow(alphas(best),2));
 }
 
 template <typename T>
-void TrainBase<T>::squareStates()
+typename ESN<T>::DEMatrix TrainRidgeRegCV<T>::getCVErrors()
+  throw(AUExcept)
 {
-  // add additional squared states and inputs
-  /// \todo vectorize that
-  int Msize = esn_->neurons_+esn_->inputs_;
-  int Mrows = M.numRows();
-  for(int i=1; i<=Mrows; ++i) {
-  for(int j=1; j<=Msize; ++j) {
-    M(i,j+Msize) = pow( M(i,j), 2 );
-  } }
+  if( cv_errors_.numRows() == 0 )
+    throw AUExcept("TrainRidgeRegCV::getCVErrors: you need to train the ESN first!");
+
+  return cv_errors_;
 }
 
 //@}
-//! @name class TrainPI Implementation
+//! @name class TrainRLS Implementation
 //@{
 
 template <typename T>
-void TrainPI<T>::train(const typename ESN<T>::DEMatrix &in,
-                       const typename ESN<T>::DEMatrix &out,
-                       int washout)
+void TrainRLS<T>::train(const typename ESN<T>::DEMatrix &in,
+                        const typename ESN<T>::DEMatrix &out,
+                        int washout)
   throw(AUExcept)
 {
   this->checkParams(in,out,washout);
 
-  // 1. teacher forcing, collect states
-  this->collectStates(in,out,washout);
+  // start with zero output weights
+  std::fill_n( esn_->Wout_.data(),
+               esn_->Wout_.numRows()*esn_->Wout_.numCols(), 0 );
+  reset();
 
-  // add additional squared states when using SIM_SQUARE
-  if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
-    this->squareStates();
+  // teacher forcing and weight update after the washout
+  int steps = in.numCols();
+  typename ESN<T>::DEMatrix sim_in(esn_->inputs_ ,1),
+                            sim_out(esn_->outputs_ ,1);
+  for(int n=1; n<=steps; ++n)
+  {
+    sim_in(_,1) = in(_,n);
+    esn_->simulate(sim_in, sim_out);
 
+    if( n > washout )
+      trainStep( sim_in.data(), &out(1,n) );
 
-  // 2. offline weight computation
+    // for teacherforcing with feedback in single step simulation
+    // we need to set the correct last output
+    esn_->sim_->last_out_(_,1) = out(_,n);
+  }
+}
 
-  // undo output activation function
-  esn_->outputInvAct_( O.data(), O.numRows()*O.numCols() );
+template <typename T>
+void TrainRLS<T>::readParams(T &lambda, T &delta)
+  throw(AUExcept)
+{
+  lambda = 1.;
+  if( esn_->init_params_.find(RLS_LAMBDA) != esn_->init_params_.end() )
+    lambda = esn_->init_params_[RLS_LAMBDA];
+  delta = 1.;
+  if( esn_->init_params_.find(RLS_DELTA) != esn_->init_params_.end() )
+    delta = esn_->init_params_[RLS_DELTA];
+
+  if( lambda <= 0 || lambda > 1 )
+    throw AUExcept("TrainRLS: RLS_LAMBDA must be within (0|1] !");
+  if( delta <= 0 )
+    throw AUExcept("TrainRLS: RLS_DELTA must be > 0 !");
+}
 
-  // calc weights with pseudo inv: Wout_ = (M^-1) * O
-  flens::lss( M, O );
-  esn_->Wout_ = flens::transpose( O(_( 1, M.numCols() ),_) );
+template <typename T>
+void TrainRLS<T>::reset()
+  throw(AUExcept)
+{
+  int simalg = esn_->net_info_[ESN<T>::SIMULATE_ALG];
+  if( simalg == SIM_FILTER_DS || simalg == SIM_SQUARE )
+    throw AUExcept("TrainRLS: delay&sum readouts are not supported!");
+
+  readParams(lambda_, delta_);
+  read_params_ = false;
+
+  int L = esn_->neurons_+esn_->inputs_;
+
+  // P = I/delta
+  Q_.resizeOrClear( L*(L+1)/2 );
+  std::fill_n( Q_.data(), Q_.length(), 0 );
+  for(int j=0; j<L; ++j)
+    Q_.data()[j+j*(j+1)/2] = 1./delta_;
+  s_ = 1.;
+  reset_ = false;
+
+  z_.resizeOrClear(L);
+  u_.resizeOrClear(L);
+  e_.resizeOrClear(esn_->outputs_);
+}
 
-  this->clearData();
+template <typename T>
+void TrainRLS<T>::trainStep(const T *in, const T *target)
+  throw(AUExcept)
+{
+  int L = esn_->neurons_+esn_->inputs_;
+  int outs = esn_->outputs_;
+
+  // the parameters are only read again after they were changed
+  if( read_params_ && !reset_ )
+  {
+    T lambda, delta;
+    readParams(lambda, delta);
+    reset_ = ( delta != delta_ );
+    lambda_ = lambda;
+    read_params_ = false;
+  }
+  if( reset_ || z_.length() != L || e_.length() != outs )
+    reset();
+
+  // extended state z = [x; in]
+  std::copy( esn_->x_.data(), esn_->x_.data()+esn_->neurons_, z_.data() );
+  std::copy( in, in+esn_->inputs_, z_.data()+esn_->neurons_ );
+
+  // a priori error before the output activation function
+  std::copy( target, target+outs, e_.data() );
+  esn_->outputInvAct_( e_.data(), outs );
+  for(int i=1; i<=outs; ++i) {
+  for(int j=1; j<=L; ++j) {
+    e_(i) -= esn_->Wout_(i,j) * z_(j);
+  } }
+
+  // u = Q*z, P*z = s*u
+  spmv( L, (T) 1., Q_.data(), z_.data(), (T) 0., u_.data() );
+  T zu = 0.;
+  for(int j=1; j<=L; ++j)
+    zu += z_(j) * u_(j);
+  T denom = lambda_ + s_*zu;
+
+  // Wout = Wout + e*k.T, with gain k = s*u/denom
+  ger( outs, L, s_/denom, e_.data(), u_.data(), esn_->Wout_.data() );
+
+  // P = (P - P*z*z.T*P/denom) / lambda
+  //   = s/lambda * (Q - s*u*u.T/denom)
+  spr( L, -s_/denom, u_.data(), Q_.data() );
+  s_ /= lambda_;
+
+  // keep the scaling in a sane range
+  if( s_ > 1e4 || s_ < 1e-4 )
+  {
+    scal( Q_.length(), s_, Q_.data() );
+    s_ = 1.;
+  }
 }
 
 //@}
-//! @name class TrainLS Implementation
+//! @name class TrainNLMS Implementation
 //@{
 
 template <typename T>
-void TrainLS<T>::train(const typename ESN<T>::DEMatrix &in,
-                       const typename ESN<T>::DEMatrix &out,
-                       int washout)
+void TrainNLMS<T>::train(const typename ESN<T>::DEMatrix &in,
+                         const typename ESN<T>::DEMatrix &out,
+                         int washout)
   throw(AUExcept)
 {
   this->checkParams(in,out,washout);
+  T mu = learnrate();
 
-  // 1. teacher forcing, collect states
-  this->collectStates(in,out,washout);
+  // teacher forcing and weight update after the washout
+  int steps = in.numCols();
+  typename ESN<T>::DEMatrix sim_in(esn_->inputs_ ,1),
+                            sim_out(esn_->outputs_ ,1);
+  AdaptTargetGuard<T> guard(esn_->sim_);
+  for(int n=1; n<=steps; ++n)
+  {
+    if( n > washout )
+      esn_->sim_->setAdaptTarget( &out(1,n), mu );
 
-  // add additional squared states when using SIM_SQUARE
-  if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
-    this->squareStates();
+    sim_in(_,1) = in(_,n);
+    esn_->simulate(sim_in, sim_out);
 
+    // for teacherforcing with feedback in single step simulation
+    // we need to set the correct last output
+    esn_->sim_->last_out_(_,1) = out(_,n);
+  }
+}
 
-  // 2. offline weight computation
+template <typename T>
+void TrainNLMS<T>::trainOnline(const typename ESN<T>::DEMatrix &in,
+                               const typename ESN<T>::DEMatrix &target,
+                               typename ESN<T>::DEMatrix &out)
+  throw(AUExcept)
+{
+  T mu = learnrate();
+  AdaptTargetGuard<T> guard(esn_->sim_);
+  esn_->sim_->setAdaptTarget( target.data(), mu );
+  esn_->simulate(in, out);
+}
 
-  // undo output activation function
-  esn_->outputInvAct_( O.data(), O.numRows()*O.numCols() );
+template <typename T>
+T TrainNLMS<T>::learnrate()
+  throw(AUExcept)
+{
+  int simalg = esn_->net_info_[ESN<T>::SIMULATE_ALG];
+  if( simalg != SIM_STD && simalg != SIM_FILTER )
+    throw AUExcept("TrainNLMS: only SIM_STD and SIM_FILTER are supported!");
 
-  // calc weights with least square solver: Wout_ = (M^-1) * O
-  flens::ls( flens::NoTrans, M, O );
-  esn_->Wout_ = flens::transpose( O(_( 1, M.numCols() ),_) );
+  if( esn_->init_params_.find(NLMS_MU) == esn_->init_params_.end() )
+    throw AUExcept("TrainNLMS: No NLMS_MU given !");
 
-  this->clearData();
+  return esn_->init_params_[NLMS_MU];
 }
 
 //@}
-//! @name class TrainRidgeReg Implementation
+//! @name class TrainLasso Implementation
 //@{
 
 template <typename T>
-void TrainRidgeReg<T>::train(const typename ESN<T>::DEMatrix &in,
-                       const typename ESN<T>::DEMatrix &out,
-                       int washout)
+void TrainLasso<T>::train(const typename ESN<T>::DEMatrix &in,
+                          const typename ESN<T>::DEMatrix &out,
+                          int washout)
   throw(AUExcept)
 {
   this->checkParams(in,out,washout);
@@ -196,50 +1109,93 @@ void TrainRidgeReg<T>::train(const typename ESN<T>::DEMatrix &in,
   // 1. teacher forcing, collect states
   this->collectStates(in,out,washout);
 
+  // 2. offline weight computation
+  computeWeights();
+}
+
+template <typename T>
+void TrainLasso<T>::computeWeights()
+  throw(AUExcept)
+{
+  // get parameters
+  T lambda = esn_->init_params_[LASSO_LAMBDA];
+  int iterations = 1000;
+  if( esn_->init_params_.find(LASSO_ITERATIONS) != esn_->init_params_.end() )
+    iterations = (int) esn_->init_params_[LASSO_ITERATIONS];
+  T tolerance = 1e-6;
+  if( esn_->init_params_.find(LASSO_TOLERANCE) != esn_->init_params_.end() )
+    tolerance = esn_->init_params_[LASSO_TOLERANCE];
+
   // add additional squared states when using SIM_SQUARE
   if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
     this->squareStates();
 
-
-  // 2. offline weight computation
-
   // undo output activation function
   esn_->outputInvAct_( O.data(), O.numRows()*O.numCols() );
 
+  // gram matrices G = M.T*M/N and B = M.T*O/N
+  typename ESN<T>::DEMatrix G, B;
+  this->gramMatrices(G, B);
+  int n = G.numRows();
+  int outputs = B.numCols();
+  T scale = 1. / M.numRows();
+  this->clearData();
+  for(int k=0; k<n*n; ++k) G.data()[k] *= scale;
+  for(int k=0; k<n*outputs; ++k) B.data()[k] *= scale;
 
-  // calc weights with ridge regression (.T = transpose):
-  // Wout = ( (M.T*M + alpha^2*I)^-1 *M.T * O )
-
-  // get regularization factor and square it
-  T alpha = pow(esn_->init_params_[TIKHONOV_FACTOR],2);
-
-  // temporal objects
-  typename ESN<T>::DEMatrix T1(esn_->neurons_+esn_->inputs_,
-                               esn_->neurons_+esn_->inputs_);
-  flens::DenseVector<flens::Array<int> > t2( M.numCols() );
-
-  // M.T * M
-  T1 = flens::transpose(M)*M;
-
-  // ans + alpha^2*I
-  for(int i=1; i<=T1.numRows(); ++i)
-    T1(i,i) += alpha;
+  esn_->Wout_.resizeOrClear(outputs, n);
 
-  // calc inverse: (ans)^-1
-  flens::trf(T1, t2);
-  flens::tri(T1, t2);
+  // coordinate descent for each output
+  #pragma omp parallel
+  {
+    std::vector<T> w(n), c(n);
 
-  // ans * M.T
-  esn_->Wout_ = T1 * flens::transpose(M);
+    #pragma omp for schedule(dynamic)
+    for(int o=1; o<=outputs; ++o)
+    {
+      // weights and gradient c = b - G*w, starting with w = 0
+      std::fill( w.begin(), w.end(), 0 );
+      for(int j=0; j<n; ++j)
+        c[j] = B(j+1,o);
 
-  // ans * O
-  T1 = esn_->Wout_ * O;
+      for(int it=0; it<iterations; ++it)
+      {
+        T maxdiff = 0, maxw = 0;
 
-  // result = ans.T
-  esn_->Wout_ = flens::transpose(T1);
+        for(int j=0; j<n; ++j)
+        {
+          T gjj = G(j+1,j+1);
+          if( gjj <= 0 ) continue;
+
+          // soft thresholding
+          T rho = c[j] + gjj*w[j];
+          T wnew = 0;
+          if( rho > lambda )
+            wnew = (rho - lambda) / gjj;
+          else if( rho < -lambda )
+            wnew = (rho + lambda) / gjj;
+
+          T diff = wnew - w[j];
+          if( diff == 0 ) continue;
+
+          // update gradient with column j of G
+          const T *g = &G(1,j+1);
+          for(int k=0; k<n; ++k)
+            c[k] -= diff * g[k];
+          w[j] = wnew;
+
+          maxdiff = std::max( maxdiff, (T) std::abs(diff) );
+          maxw = std::max( maxw, (T) std::abs(wnew) );
+        }
 
+        if( maxdiff <= tolerance*maxw )
+          break;
+      }
 
-  this->clearData();
+      for(int j=0; j<n; ++j)
+        esn_->Wout_(o,j+1) = w[j];
+    }
+  }
 }
 
 //@}
@@ -267,9 +1223,6 @@ void TrainDSPI<T>::train(const typename ESN<T>::DEMatrix &in,
   // collects reservoir activations and inputs of all timesteps in M
   M.resize(steps, esn_->neurons_+esn_->inputs_);
 
-  // collect desired outputs
-  O.resize(steps-washout, 1);
-
   typename ESN<T>::DEMatrix sim_in(esn_->inputs_ ,1),
                             sim_out(esn_->outputs_ ,1);
   for(int n=1; n<=steps; ++n)
@@ -338,91 +1291,87 @@ void TrainDSPI<T>::delayLearningSimple(const typename ESN<T>::DEMatrix &in,
 				       int emiters)
   throw(AUExcept)
 {
-  int delay = 0;
+  int L = esn_->neurons_+esn_->inputs_;
+  int outputs = esn_->outputs_;
+  int rows = steps-washout;
   int fftsize = (int) pow( 2, ceil(log(steps)/log(2)) ); // next power of 2
-  typename CDEVector<T>::Type X,Y;
-  typename DEVector<T>::Type x,y,rest;
-  typename DEMatrix<T>::Type T1(1,esn_->neurons_+esn_->inputs_);
-  typename DEMatrix<T>::Type Mtmp(M.numRows(),M.numCols()); /// \todo memory !!!
+  bool square = ( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE );
+
+  // choose delay calculation in time or frequency domain
+  bool timedomain = CalcDelay<T>::useCrossCorr(steps, fftsize, maxdelay, filter);
+
+  // collect target vectors (and their FFTs)
+  std::vector<typename DEVector<T>::Type> y(outputs);
+  std::vector<typename CDEVector<T>::Type> Y(outputs);
+  #pragma omp parallel for
+  for(int i=0; i<outputs; ++i)
+  {
+    y[i] = out(i+1,_);
+    esn_->outputInvAct_( y[i].data(), y[i].length() );
+    if( !timedomain )
+      rfft( y[i], Y[i], fftsize );
+  }
 
-  for(int i=1; i<=esn_->outputs_; ++i)
+  // calc delays to reservoir neurons and inputs, the neuron/input
+  // vectors are transformed in blocks of columns with batched FFTs
+  // and each spectrum is used for all outputs
+  const int block = 16;
+  int nc = fftsize/2+1;
+  int nblocks = (L+block-1) / block;
+  std::vector<int> delays(outputs*L);
+
+  #pragma omp parallel for schedule(dynamic)
+  for(int b=0; b<nblocks; ++b)
   {
-    // calc FFT of target vector
-    y = out(i,_);
-    esn_->outputInvAct_( y.data(), y.length() );
-    rfft( y, Y, fftsize );
+    int first = b*block+1;
+    int howmany = std::min(block, L-first+1);
+    typename CDEVector<T>::Type X, work;
+    if( !timedomain )
+      rfft( M, first, howmany, X, fftsize );
 
-    // calc delays to reservoir neurons and inputs
-    for(int j=1; j<=esn_->neurons_+esn_->inputs_; ++j)
+    for(int k=0; k<howmany; ++k)
     {
-      // calc FFT of neuron/input vector
-      x = M(_,j);
-      rfft( x, X, fftsize );
-
-      // calc delay with GCC
-      delay = CalcDelay<T>::gcc(X,Y,maxdelay,filter);
+      int j = first+k;
 
-      if( delay != 0 )
+      for(int i=1; i<=outputs; ++i)
       {
-        // shift signal the right amount
-        rest = M( _(M.numRows()-delay+1,M.numRows()), j );
-        Mtmp( _(1,delay), j ) = 0.;
-        Mtmp( _(delay+1,M.numRows()), j ) = M( _(1,M.numRows()-delay), j );
+        // calc delay with GCC or directly with cross correlation
+        int delay;
+        if( timedomain )
+          delay = CalcDelay<T>::crosscorr( &M(1,j), steps, y[i-1].data(),
+                                           steps, fftsize, maxdelay );
+        else
+          delay = CalcDelay<T>::gcc( X.data()+k*nc, Y[i-1].data(), nc,
+                                     work, maxdelay, filter );
+        delays[(i-1)*L+j-1] = delay;
 
         // init delay lines with the rest of the buffer
-        esn_->sim_->initDelayLine((i-1)*(esn_->neurons_+esn_->inputs_)+j-1, rest);
+        if( delay != 0 )
+        {
+          typename DEVector<T>::Type rest =
+            M( _(M.numRows()-delay+1,M.numRows()), j );
+          esn_->sim_->initDelayLine((i-1)*L+j-1, rest);
+        }
       }
-      else
-        Mtmp(_,j) = M(_,j);
     }
+  }
 
 
-    // offline weight computation for each output extra
+  // offline weight computation for each output extra, the delayed
+  // rows are gathered block by block (solveDelayed), M itself is not
+  // changed
 
+  #pragma omp parallel for schedule(dynamic)
+  for(int i=1; i<=outputs; ++i)
+  {
     // collect desired outputs
-    O(_,1) = out( i ,_(washout+1,steps) );
+    typename DEMatrix<T>::Type Oi(rows, 1);
+    Oi(_,1) = out( i ,_(washout+1,steps) );
 
     // undo output activation function
-    esn_->outputInvAct_( O.data(), O.numRows()*O.numCols() );
-
-    // square and double state if we have additional squared state updates
-    if( esn_->net_info_[ESN<T>::SIMULATE_ALG] != SIM_SQUARE )
-    {
-      M = Mtmp( _(washout+1,steps), _);
-    }
-    else
-    {
-      M.resize( steps-washout, Mtmp.numCols()*2 );
-      M( _, _(1,Mtmp.numCols()) ) = Mtmp( _(washout+1,steps), _);
-      this->squareStates();
-    }
+    esn_->outputInvAct_( Oi.data(), rows );
 
-    // calc weights with pseudo inv: Wout_ = (M^-1) * O
-    flens::lss( M, O );
-    T1 = flens::transpose( O(_( 1, M.numCols() ),_) );
-    esn_->Wout_(i,_) = T1(1,_);
-
-
-    // 4. restore simulation matrix M
-    if( i < esn_->outputs_ )
-    {
-      M.resize( Mtmp.numRows(), Mtmp.numCols() );
-
-      // undo the delays and store it again into M
-      for(int j=1; j<=esn_->neurons_+esn_->inputs_; ++j)
-      {
-        rest = esn_->sim_->getDelayBuffer(i-1,j-1);
-        delay = rest.length();
-
-        if( delay != 0 )
-        {
-          M( _(1,steps-delay), j ) = Mtmp( _(delay+1,steps), j );
-          M( _(steps-delay+1,steps), j ) = rest;
-        }
-        else
-          M(_,j) = Mtmp(_,j);
-      }
-    }
+    solveDelayed(i, &delays[(i-1)*L], Oi, washout, square);
   }
 }
 
@@ -437,55 +1386,89 @@ void TrainDSPI<T>::delayLearningEM(const typename ESN<T>::DEMatrix &in,
   // check if maxdelay is bigger than the washout
   if( maxdelay > washout+1 )
     throw AUExcept("TrainDSPI::train: max delay must be <= as the washout (or use the simple delay calculation algorithm without EM) !");
-  
+
   int fftsize = (int) pow( 2, ceil(log(steps-washout+1)/log(2)) ); // next power of 2
-  typename DEMatrix<T>::Type Mtmp(steps-washout,M.numCols());
-  int L = Mtmp.numCols();
-  typename DEVector<T>::Type t(steps-washout),targ(steps-washout);
-  typename DEVector<T>::Type r(steps-washout);
-  typename CDEVector<T>::Type rF,tF;
-  typename DEVector<T>::Type rest;
-  typename DEMatrix<T>::Type t2(steps-washout,1);
-  typename DEMatrix<T>::Type r2(steps-washout,1);
-  typename DEVector<T>::Type w(L), wold(L);
+  int L = M.numCols();
+  int rows = steps-washout;
+  bool square = ( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE );
+
+  // check if we should take the weight from EM algorithm
+  bool emweights = false;
+  if( esn_->init_params_.find(DS_WEIGHTS_EM) != esn_->init_params_.end() )
+  {
+    /// \todo squared state update !
+    if( square )
+      throw AUExcept("TrainDSPI::train: SQUARE not yet implemented for DS_WEIGHTS_EM!");
+
+    emweights = true;
+  }
 
   int em_version = 1;
   if( esn_->init_params_.find(EM_VERSION) != esn_->init_params_.end() )
   {
     em_version = (int) esn_->init_params_[EM_VERSION];
     if ( em_version<1 || em_version>3 ) em_version = 1;
-    std::cout << "EM_VERSION: " << em_version << "\n";
   }
 
+  // stop iterating if delays don't change and weights change less
+  // than the tolerance
+  T tolerance = 0.;
+  if( esn_->init_params_.find(DS_EM_TOLERANCE) != esn_->init_params_.end() )
+    tolerance = esn_->init_params_[DS_EM_TOLERANCE];
+
+  // choose delay calculation in time or frequency domain
+  bool timedomain = CalcDelay<T>::useCrossCorr(rows, fftsize, maxdelay, filter);
+
+  // spectra of all neuron/input signals, they don't change during
+  // the EM iterations and are shared by all outputs
+  int nc = fftsize/2+1;
+  typename CDEVector<T>::Type R;
+  if( !timedomain )
+    rfft( M, 1, L, R, fftsize, washout+1 );
 
-  // iterate over all outputs
 
+  // iterate over all outputs, they are independent once M is collected;
+  // all delays are <= washout, so a delayed neuron signal is always
+  // an offset view into M
+
+  #pragma omp parallel
+  {
+  // spectra of the residual and of the target, two buffers for the
+  // spectra of delayed neuron signals and the scratch vector of gcc
+  // (one set per thread)
+  typename CDEVector<T>::Type TARG, tF(nc), XB[2], work;
+
+  #pragma omp for schedule(dynamic)
   for(int n=1; n<=esn_->outputs_; ++n)
   {
+    typename DEVector<T>::Type t(rows),targ(rows);
+    typename DEVector<T>::Type rest, dsig(rows);
+    typename DEMatrix<T>::Type t2(rows,1);
+    typename DEMatrix<T>::Type On(rows,1);
+    typename DEVector<T>::Type w(L), wold(L);
+    std::vector<int> delays(L), delold(L);
+
     // collect desired outputs
-    O(_,1) = out( n ,_(washout+1,steps) );
+    On(_,1) = out( n ,_(washout+1,steps) );
     // undo output activation function
-    esn_->outputInvAct_( O.data(), O.numRows()*O.numCols() );
-    
-    // restore size of t2
-    t2.resize(steps-washout,1);
-
-    int delays[L];
-    int delold[L];
+    esn_->outputInvAct_( On.data(), rows );
 
     // set initial weights and delays to 0
     std::fill_n( w.data(), w.length(), 0. );
-    std::fill_n( delays, L, 0 );
+    std::fill( delays.begin(), delays.end(), 0 );
 
     bool converged = false;
     int itercount = 0;
 
-    // delay neuron signals without delay (just copy)
-    for(int i=0; i<Mtmp.numCols(); ++i)
-      Mtmp(_, i+1) = M( _(washout+1,M.numRows()), i+1 );
+    // init target vector, it always holds the residual of the
+    // target and all weighted, delayed neuron signals
+    targ = On(_,1);
 
-    // init target vector
-    targ = O(_,1);
+    // spectrum of the previous neuron signal with its current delay
+    // (all delays are 0 at the beginning), it may point into XB[p],
+    // so the spectrum of the current neuron signal goes into XB[1-p]
+    const std::complex<T> *Xii = timedomain ? 0 : R.data()+(L-1)*nc;
+    int p = 0;
 
     bool first_time = true;
 
@@ -493,8 +1476,12 @@ void TrainDSPI<T>::delayLearningEM(const typename ESN<T>::DEMatrix &in,
     {
       // store previous delays and weights
       wold = w;
-      for(int i=0; i<esn_->neurons_+esn_->inputs_; ++i)
-        delold[i] = delays[i];
+      delold = delays;
+
+      // the spectrum of the residual is updated together with targ,
+      // it is recalculated once per iteration to avoid a drift
+      if( !timedomain )
+        rfft( targ, TARG, fftsize );
 
       for(int i=0; i<L; ++i)
       {
@@ -505,91 +1492,125 @@ void TrainDSPI<T>::delayLearningEM(const typename ESN<T>::DEMatrix &in,
         int ii = L-1;
         if( i>0 )
           ii = (i-1) % L; // to not get negative numbers out of %
-        Mtmp(_, ii+1) = M( _(washout+1-delays[ii],M.numRows()-delays[ii]), ii+1 );
-        targ = targ-Mtmp(_,ii+1)*w(ii+1);
+        targ = targ - M( _(washout+1-delays[ii],steps-delays[ii]), ii+1 )*w(ii+1);
 
-        // remove contribution from all other neuron signals from target output O
-        // (recursive implementation)
-        if( em_version == 1 )
-        {
-          t2(_,1) = Mtmp(_,i+1)*w(i+1);
-          t = targ + t2(_,1);
-          targ = targ + t2(_,1);
-        }
+        // weight of the residual in the target of neuron i
+        T a = 1.;
         if( em_version == 2 )
-        {
-          t2(_,1) = Mtmp(_,i+1)*w(i+1);
-          t = targ/L + t2(_,1);
-          targ = targ + t2(_,1);
-        }
+          a = 1./L;
         if( em_version == 3 )
         {
-          T beta = 0.;
           if( first_time )
-          {
-            beta = 1.;
             first_time = false;
-          }
           else
           {
             // beta = 1 - ( abs(w(i+1)) / abs(w).sum() )
             T sum = 0.;
-            for(int n=1; n<=L; ++n)
-              sum += std::abs( w(n) );
-            beta = 1 - ( std::abs( w(i+1) ) / sum );
+            for(int k=1; k<=L; ++k)
+              sum += std::abs( w(k) );
+            a = 1 - ( std::abs( w(i+1) ) / sum );
+          }
+        }
+
+        // remove contribution from all other neuron signals from target output O
+        // (recursive implementation)
+        t2(_,1) = M( _(washout+1-delays[i],steps-delays[i]), i+1 )*w(i+1);
+        t = targ*a + t2(_,1);
+        targ = targ + t2(_,1);
+
+        // the same updates of the spectra, the spectrum of a neuron
+        // signal with delay 0 is shared, otherwise it is calculated
+        const std::complex<T> *Xi = 0;
+        if( !timedomain )
+        {
+          if( delays[i] == 0 )
+            Xi = R.data() + i*nc;
+          else
+          {
+            dsig = M( _(washout+1-delays[i],steps-delays[i]), i+1 );
+            rfft( dsig, XB[1-p], fftsize );
+            Xi = XB[1-p].data();
+          }
+
+          std::complex<T> *rF = TARG.data(), *tFd = tF.data();
+          T wii = w(ii+1), wi = w(i+1);
+          for(int k=0; k<nc; ++k)
+          {
+            rF[k] -= wii * Xii[k];
+            tFd[k] = a * rF[k] + wi * Xi[k];
+            rF[k] += wi * Xi[k];
           }
-          t2(_,1) = Mtmp(_,i+1)*w(i+1);
-          t = targ*beta + t2(_,1);
-          targ = targ + t2(_,1);
         }
 
 
         //////////////////
         // M-step
 
-        // current neuron signal
-        r = M( _(washout+1,M.numRows()), i+1 );
-
-        // calc FFT of target and neuron signal
-        rfft( r, rF, fftsize );
-        rfft( t, tF, fftsize );
         // estimate time delay between target signal x
-        delays[i] = CalcDelay<T>::gcc(rF,tF,maxdelay,filter);
-
-        // delay current neuron signal with new delay
-        r = M( _(washout+1-delays[i],M.numRows()-delays[i]), i+1 );
+        if( timedomain )
+          delays[i] = CalcDelay<T>::crosscorr( &M(washout+1,i+1), rows,
+                                               t.data(), rows, fftsize,
+                                               maxdelay );
+        else
+        {
+          // the spectrum of the target is already known
+          delays[i] = CalcDelay<T>::gcc( R.data()+i*nc, tF.data(), nc,
+                                         work, maxdelay, filter );
+
+          // spectrum of the neuron signal with the new delay for the
+          // residual update of the next neuron
+          if( delays[i] == delold[i] )
+            Xii = Xi;
+          else if( delays[i] == 0 )
+            Xii = R.data() + i*nc;
+          else
+          {
+            dsig = M( _(washout+1-delays[i],steps-delays[i]), i+1 );
+            rfft( dsig, XB[1-p], fftsize );
+            Xii = XB[1-p].data();
+          }
+          if( Xii == XB[1-p].data() )
+            p = 1-p;
+        }
 
-        r2(_,1) = r;
-        t2(_,1) = t;
-        flens::ls( flens::NoTrans, r2, t2 );
-//         flens::lss( r2, t2 );  // pinv
-        w(i+1) = t2(1,1);
+        // least squares weight of the delayed neuron signal r:
+        // w = r.T*t / r.T*r
+        const T *r = &M(washout+1-delays[i], i+1);
+        T rt = 0., rr = 0.;
+        for(int k=0; k<rows; ++k)
+        {
+          rt += r[k] * t(k+1);
+          rr += r[k] * r[k];
+        }
+        w(i+1) = ( rr > 0. ) ? rt / rr : 0.;
       }
       itercount++;
 
-      // TODO: make a variable to switch on/off these diagnostics
-
       // calc delay difference:
       int deldiff = 0;
-      for(int i=0; i<esn_->neurons_+esn_->inputs_; ++i)
+      for(int i=0; i<L; ++i)
         deldiff += abs( delold[i] - delays[i] );
 
       // calc weight difference:
       T wdiff = 0;
-      for(int i=0; i<esn_->neurons_+esn_->inputs_; ++i)
+      for(int i=0; i<L; ++i)
         wdiff += std::abs( wold(i+1) - w(i+1) );
 
-      // calc average weight
-      T wmean = 0;
-      for(int i=0; i<w.length(); ++i)
-        wmean += w(i+1);
-      wmean /= w.length();
-
-      std::cout << "\titeration " << itercount << " - |d-dold| diff = "
-                << deldiff << " - |w-wold| diff = " << wdiff
-                << " - average weight = " << wmean << "\n";
+      // diagnostics
+      if( esn_->em_callback_ )
+      {
+        // calc average weight
+        T wmean = 0;
+        for(int i=0; i<w.length(); ++i)
+          wmean += w(i+1);
+        wmean /= w.length();
+
+        #pragma omp critical (aureservoir_em_callback)
+        esn_->em_callback_( n, itercount, deldiff, wdiff, wmean,
+                            esn_->em_callback_data_ );
+      }
 
-      if( itercount >= emiters )
+      if( itercount >= emiters || ( deldiff == 0 && wdiff <= tolerance ) )
         converged = true;
     }
 
@@ -598,58 +1619,88 @@ void TrainDSPI<T>::delayLearningEM(const typename ESN<T>::DEMatrix &in,
     {
       if( delays[i] != 0 )
       {
-        // shift reservoir signals the right amount
-        Mtmp(_, i+1) = M( _(washout+1-delays[i],M.numRows()-delays[i]), i+1 );
-
         // init delay lines with the rest of the buffer
         rest = M( _(M.numRows()-delays[i]+1,M.numRows()), i+1 );
-        esn_->sim_->initDelayLine((n-1)*(esn_->neurons_+esn_->inputs_)+i, rest);
+        esn_->sim_->initDelayLine((n-1)*L+i, rest);
       }
-      else
-        Mtmp(_, i+1) = M( _(washout+1,M.numRows()), i+1 );
     }
 
-    // check if we should take the weight from EM algorithm
-    if( esn_->init_params_.find(DS_WEIGHTS_EM) != esn_->init_params_.end() )
+    if( emweights )
     {
-      /// \todo squared state update !
-      if( esn_->net_info_[ESN<T>::SIMULATE_ALG] == SIM_SQUARE )
-        throw AUExcept("TrainDSPI::train: SQUARE not yet implemented for DS_WEIGHTS_EM!");
-
-      std::cout << "\tusing weights from EM algorithm !\n";
       esn_->Wout_(n,_) = w;
-      this->clearData();
-      return;
+      continue;
     }
 
-    // otherwise calculate output weights with pseudo inverse
+    solveDelayed(n, &delays[0], On, washout, square);
+  }
+  }
+}
 
-    if( esn_->net_info_[ESN<T>::SIMULATE_ALG] != SIM_SQUARE )
+template <typename T>
+void TrainDSPI<T>::solveDelayed(int n, const int *delays,
+                                const typename DEMatrix<T>::Type &On,
+                                int washout, bool square)
+  throw(AUExcept)
+{
+  int L = M.numCols();
+  int cols = square ? 2*L : L;
+  int rows = On.numRows();
+
+  // triangular factor and right hand side of the rows reduced so far
+  typename DEMatrix<T>::Type R, C;
+  R.resizeOrClear(cols, cols);
+  C.resizeOrClear(cols, 1);
+  // stacked [R; gathered rows] and [C; desired outputs]
+  typename DEMatrix<T>::Type S, SC;
+  typename DEVector<T>::Type tau;
+
+  for(int first=1; first<=rows; first+=BLOCKROWS)
+  {
+    int r = std::min<int>(BLOCKROWS, rows-first+1);
+    if( S.numRows() != cols+r )
     {
-       // calc weights with pseudo inv: Wout_ = (M^-1) * O
-       flens::lss( Mtmp, O );
-       t2 = flens::transpose( O(_( 1, M.numCols() ),_) );
-       esn_->Wout_(n,_) = t2(1,_);
+      S.resize(cols+r, cols);
+      SC.resize(cols+r, 1);
     }
-    else
+
+    for(int j=0; j<cols; ++j)
+      std::copy( R.data()+j*cols, R.data()+(j+1)*cols, S.data()+j*(cols+r) );
+    std::copy( C.data(), C.data()+cols, SC.data() );
+    std::copy( On.data()+first-1, On.data()+first-1+r, SC.data()+cols );
+
+    // delayed signals (and their squares if we have additional squared
+    // state updates), rows before the start of M are zero
+    for(int j=0; j<L; ++j)
     {
-      // square and double state if we have additional squared state updates
-      typename DEMatrix<T>::Type Mtmp2(M.numRows(),M.numCols());
-      Mtmp2 = M; /// \todo find a better way to reconstruct this matrix ...
-      
-      M.resize( steps-washout, Mtmp.numCols()*2 );
-      M( _, _(1,Mtmp.numCols()) ) = Mtmp;
-      this->squareStates();
-
-      // calc weights with pseudo inv: Wout_ = (M^-1) * O
-      flens::lss( M, O );
-      t2 = flens::transpose( O(_( 1, M.numCols() ),_) );
-      esn_->Wout_(n,_) = t2(1,_);
-      
-      // resconstruct old M
-      M = Mtmp2;
+      const T *col = M.data() + j*M.numRows();
+      T *dst = S.data() + j*(cols+r) + cols;
+      int src = washout + first - 1 - delays[j];
+      for(int k=0; k<r; ++k)
+        dst[k] = ( src+k >= 0 ) ? col[src+k] : 0;
+
+      if( square )
+      {
+        T *sq = S.data() + (j+L)*(cols+r) + cols;
+        for(int k=0; k<r; ++k)
+          sq[k] = dst[k]*dst[k];
+      }
     }
+
+    if( geqrf(S, tau) != 0 || ormqr(S, tau, SC) != 0 )
+      throw AUExcept("TrainDSPI::train: QR factorization failed !");
+
+    // new triangular factor and right hand side
+    for(int j=1; j<=cols; ++j) {
+    for(int i=1; i<=cols; ++i) {
+      R(i,j) = (i<=j) ? S(i,j) : 0;
+    } }
+    C(_,1) = SC(_(1,cols),1);
   }
+
+  // calc weights with pseudo inv: Wout_ = (R^-1) * C
+  flens::lss( R, C );
+  for(int j=1; j<=cols; ++j)
+    esn_->Wout_(n,j) = C(j,1);
 }
 
 //@}
@@ -114,6 +114,116 @@ class Rand
     vec *= (max-min);
     vec += min;
   }
+
+};
+
+/*!
+ * \class RandomStream
+ *
+ * \brief independent stream of pseudo random numbers
+ *
+ * Each network has its own stream (xorshift64* generator), so that
+ * networks can be initialized, trained and simulated in parallel and
+ * the results only depend on the seed and not on the order in which
+ * the networks draw their random numbers.
+ * Seeds are scrambled (splitmix64), so that consecutive seeds give
+ * uncorrelated streams.
+ */
+class RandomStream
+{
+ public:
+
+  /// Constructor
+  RandomStream(unsigned long long seed=0) { setSeed(seed); }
+
+  /// restarts the stream with a new seed
+  void setSeed(unsigned long long seed)
+  {
+    state_ = mix(seed);
+    if( state_ == 0 )
+      state_ = 0x9E3779B97F4A7C15ULL;
+  }
+
+  /// scrambles a 64 bit value (splitmix64)
+  static unsigned long long mix(unsigned long long z)
+  {
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+  }
+
+  /*!
+   * derives the seed of stream nr i from a seed (hash of both), used for
+   * the members of an ensemble and for copies of a network, so that
+   * streams of different seeds do not overlap as seed+i would
+   * @param seed the base seed
+   * @param i nr of the stream
+   */
+  static unsigned long long derive(unsigned long long seed,
+                                   unsigned long long i)
+  { return mix( mix(seed) ^ mix(i ^ 0xD1B54A32D192ED03ULL) ); }
+
+  /// @return next 64 bit pseudo random number
+  unsigned long long next()
+  {
+    state_ ^= state_ >> 12;
+    state_ ^= state_ << 25;
+    state_ ^= state_ >> 27;
+    return state_ * 0x2545F4914F6CDD1DULL;
+  }
+
+  /*!
+   * generates a pseudo random number from a uniform distribution
+   * @param min minimum value
+   * @param max maximum value
+   * @return value between [min|max)
+   */
+  double uniform(double min=-1, double max=1)
+  {
+    double tmp = (next() >> 11) * (1. / 9007199254740992.); // [0|1)
+    return tmp*(max-min) + min;
+  }
+
+  /*!
+   * generates a pseudo random number vector from a uniform distribution
+   * @param vec fills this vector with rand values between [min|max)
+   * @param min minimum value
+   * @param max maximum value
+   */
+  template <typename T>
+  void uniform(flens::DenseVector<flens::Array<T> > &vec,
+               double min=-1, double max=1)
+  {
+    T *data = vec.data();
+    for(int i=0; i<vec.length(); ++i)
+      data[i] = uniform(min, max);
+  }
+
+  /*!
+   * generates a pseudo random integer from a uniform distribution
+   * @param n nr of possible values
+   * @return value between [0|n)
+   */
+  size_t index(size_t n)
+  { return next() % n; }
+
+  /*!
+   * @return a different seed for each call, from the time and a counter,
+   *         used for networks without an explicit seed (scrambled, so that
+   *         seeds of consecutive calls are not adjacent)
+   */
+  static unsigned long long defaultSeed()
+  {
+    static unsigned long long counter = 0;
+    unsigned long long c;
+    #pragma omp critical (aureservoir_seed)
+    c = ++counter;
+    return mix( ( (unsigned long long) time(0) << 20 ) + c );
+  }
+
+ private:
+  unsigned long long state_;
 };
 
 /// specialization for complex
@@ -80,6 +80,7 @@ import_array();
 %apply (float *INPLACE_ARRAY2, int DIM1, int DIM2)
 {  (float *inmtx, int inrows, int incols),
    (float *outmtx, int outrows, int outcols),
+   (float *targmtx, int targrows, int targcols),
    (float *wmtx, int wrows, int wcols), 
    (float *amtx, int arows, int acols),
    (float *bmtx, int brows, int bcols) };
@@ -87,6 +88,7 @@ import_array();
 %apply (double *INPLACE_ARRAY2, int DIM1, int DIM2)
 {  (double *inmtx, int inrows, int incols),
    (double *outmtx, int outrows, int outcols),
+   (double *targmtx, int targrows, int targcols),
    (double *wmtx, int wrows, int wcols),
    (double *amtx, int arows, int acols),
    (double *bmtx, int brows, int bcols) };
@@ -94,17 +96,25 @@ import_array();
 %apply (float* INPLACE_ARRAY1, int DIM1)
 {  (float *invec, int insize),
    (float *outvec, int outsize),
+   (float *targvec, int targsize),
    (float *f1vec, int f1size),
    (float *f2vec, int f2size),
+   (float *alphavec, int alphasize),
    (float *last, int size) };
 
 %apply (double* INPLACE_ARRAY1, int DIM1)
 {  (double *invec, int insize),
    (double *outvec, int outsize),
+   (double *targvec, int targsize),
    (double *f1vec, int f1size),
    (double *f2vec, int f2size),
+   (double *alphavec, int alphasize),
    (double *last, int size) };
 
+%apply (int* IN_ARRAY1, int DIM1)
+{  (int *lenvec, int lensize),
+   (int *washvec, int washsize) };
+
 %apply (float** ARGOUTVIEW_ARRAY1, int* DIM1)
 { (float **vec, int *length) };
 
@@ -145,18 +155,30 @@ class ESN
 
   void init();
   void resetState();
-  double adapt(T *inmtx, int inrows, int incols);
+  double adapt(T *inmtx, int inrows, int incols, int sequences=1);
   inline void train(T *inmtx, int inrows, int incols,
                     T *outmtx, int outrows, int outcols,
                     int washout);
   inline void simulate(T *inmtx, int inrows, int incols,
                        T *outmtx, int outrows, int outcols);
   inline void simulateStep(T *invec, int insize, T *outvec, int outsize);
+  void trainOnline(T *inmtx, int inrows, int incols,
+                   T *targmtx, int targrows, int targcols,
+                   T *outmtx, int outrows, int outcols);
+  void trainStep(T *invec, int insize, T *targvec, int targsize,
+                 T *outvec, int outsize);
   void teacherForce(T *inmtx, int inrows, int incols,
                     T *outmtx, int outrows, int outcols);
   void collectStates(T *inmtx, int inrows, int incols,
                      T *outmtx, int outrows, int outcols,
                      int washout);
+  void ridgeRegressionPath(T *inmtx, int inrows, int incols,
+                           T *outmtx, int outrows, int outcols,
+                           int washout, T *alphavec, int alphasize,
+                           T *wmtx, int wrows, int wcols);
+  void trainEpisodes(T *inmtx, int inrows, int incols,
+                     T *outmtx, int outrows, int outcols,
+                     int *lenvec, int lensize, int *washvec, int washsize);
 
   void setBPCutoff(T *f1vec, int f1size, T *f2vec, int f2size);
   void setIIRCoeff(T *bmtx, int brows, int bcols,
@@ -181,6 +203,7 @@ class ESN
   void getW(T *wmtx, int wrows, int wcols);
   void getDelays(T *wmtx, int wrows, int wcols);
   void getReservoirDelays(T *wmtx, int wrows, int wcols);
+  void getCVErrors(T *wmtx, int wrows, int wcols);
 
   void setInitAlgorithm(InitAlgorithm alg=INIT_STD);
   void setTrainAlgorithm(TrainAlgorithm alg=TRAIN_LEASTSQUARE);
@@ -189,6 +212,7 @@ class ESN
   void setInputs(int inputs=1);
   void setOutputs(int outputs=1);
   void setNoise(double noise);
+  void setSeed(unsigned long long seed);
   void setInitParam(InitParameter key, T value=0.);
   void setReservoirAct(ActivationFunction f=ACT_TANH);
   void setOutputAct(ActivationFunction f=ACT_LINEAR);
@@ -199,6 +223,9 @@ class ESN
   void setWout(T *inmtx, int inrows, int incols);
   void setX(T *invec, int insize);
   void setLastOutput(T *last, int size);
+
+  void save(const char *filename);
+  void load(const char *filename);
 };
 
 template <typename T>
@@ -215,18 +242,122 @@ class ArrayESN
                 T *outmtx, int outrows, int outcols);
   void teacherForce(T *inmtx, int inrows, int incols,
                     T *outmtx, int outrows, int outcols);
+  void fuse();
 
   int getArraySize();
   ESN<T> getNetwork(int index);
   void printWoutMean();
   void printWoutMax();
   void setNoise(double noise);
+  void setSeed(unsigned long long seed);
+};
+
+template <typename T>
+class StateFactorization
+{
+ public:
+  StateFactorization(ESN<T> &esn);
+  ~StateFactorization();
+
+  void factorize(T *inmtx, int inrows, int incols, int washout);
+  void solve(T *outmtx, int outrows, int outcols,
+             T *wmtx, int wrows, int wcols, T alpha=0);
+  void train(T *outmtx, int outrows, int outcols, T alpha=0);
+};
+
+template <typename T>
+class ParamSearch
+{
+ public:
+  ParamSearch(const ESN<T> &model);
+  ~ParamSearch();
+
+  void setValues(InitParameter key, T *invec, int insize);
+  void setRange(InitParameter key, T min, T max);
+  void setMode(SearchMode mode, int trials=0);
+  void setScreening(T maxgain, T maxsaturation, T minseparation,
+                    int steps=100);
+  void setSeed(unsigned long long seed);
+  void run(T *inmtx, int inrows, int incols,
+           T *outmtx, int outrows, int outcols, int washout,
+           T *amtx, int arows, int acols,
+           T *bmtx, int brows, int bcols);
+  int getNrResults();
+  int getNrColumns();
+  unsigned long long getSeed(int trial);
+  void getResults(T *wmtx, int wrows, int wcols);
+  int getBest();
+  void printResults();
+};
+
+// records the EM diagnostics of TrainDSPI (ESN::setEMCallback), because
+// the callback is called from the OpenMP threads it can't be a python
+// function
+%inline %{
+template <typename T>
+class EMLog
+{
+ public:
+  EMLog() {}
+  ~EMLog() {}
+
+  /// clears the log and records the EM iterations of all following
+  /// trainings of esn, \attention detach before the log is deleted
+  void attach(ESN<T> &esn)
+  { rows_.clear(); esn.setEMCallback(&EMLog<T>::record, this); }
+
+  /// removes the callback from esn
+  void detach(ESN<T> &esn) { esn.setEMCallback(0); }
+
+  /// @return nr of recorded EM iterations
+  int getNrRows() { return rows_.size() / 5; }
+
+  /// copies the log, each row is
+  /// (output, iteration, deldiff, wdiff, wmean)
+  void getLog(T *wmtx, int wrows, int wcols)
+  {
+    if( wrows != getNrRows() || wcols != 5 )
+      throw AUExcept("EMLog::getLog: wrong size!");
+
+    for(int i=0; i<wrows*wcols; ++i)
+      wmtx[i] = rows_[i];
+  }
+
+ private:
+
+  static void record(int output, int iteration, int deldiff,
+                     T wdiff, T wmean, void *data)
+  {
+    std::vector<T> &rows = static_cast<EMLog<T>*>(data)->rows_;
+    rows.push_back(output);
+    rows.push_back(iteration);
+    rows.push_back(deldiff);
+    rows.push_back(wdiff);
+    rows.push_back(wmean);
+  }
+
+  std::vector<T> rows_;
 };
+%}
+
+// FFTW planner settings for delay&sum training
+void setFFTPlannerFlags(unsigned flags);
+bool importFFTWisdom(const char *filename);
+bool exportFFTWisdom(const char *filename);
+%constant unsigned int FFTW_ESTIMATE = FFTW_ESTIMATE;
+%constant unsigned int FFTW_MEASURE = FFTW_MEASURE;
+%constant unsigned int FFTW_PATIENT = FFTW_PATIENT;
 
 %template(DoubleESN) ESN<double>;
 %template(SingleESN) ESN<float>;
 %template(DoubleArrayESN) ArrayESN<double>;
 %template(SingleArrayESN) ArrayESN<float>;
+%template(DoubleStateFactorization) StateFactorization<double>;
+%template(SingleStateFactorization) StateFactorization<float>;
+%template(DoubleParamSearch) ParamSearch<double>;
+%template(SingleParamSearch) ParamSearch<float>;
+%template(DoubleEMLog) EMLog<double>;
+%template(SingleEMLog) EMLog<float>;
 
 
 /***************************************************************************/
@@ -255,12 +386,35 @@ enum InitParameter
   IP_MEAN,          //!< desired mean for Gaussian-IP reservoir adaptation
   IP_VAR,           //!< desired variance for Gaussian-IP reservoir adaptation
   RELAXATION_STAGES, //!< relaxation stages in training algorithm
-  DS_FORCE_MAXDELAY  //!< force a specific maxdelay without checks
+  DS_FORCE_MAXDELAY, //!< force a specific maxdelay without checks
+  CV_FOLDS,         //!< nr of folds for TrainRidgeRegCV
+  CV_TIKHONOV_MIN,  //!< smallest TIKHONOV_FACTOR for TrainRidgeRegCV
+  CV_TIKHONOV_MAX,  //!< largest TIKHONOV_FACTOR for TrainRidgeRegCV
+  CV_TIKHONOV_STEPS, //!< nr of (logarithmic spaced) factors for TrainRidgeRegCV
+  RLS_LAMBDA,       //!< forgetting factor for TrainRLS
+  RLS_DELTA,        //!< initial inverse correlation matrix is I/RLS_DELTA
+  NLMS_MU,          //!< normalized learnrate for TrainNLMS
+  DS_EM_TOLERANCE,  //!< stop EM iterations if delays are unchanged and weights change less
+  OOC_TILE_ROWS,    //!< rows per tile for out of core storage in TrainPI and TrainLS
+  LS_MIXED_PRECISION, //!< double precision gram matrices and solve in TrainLS
+  LS_REFINEMENT_STEPS, //!< nr of iterative refinement steps for LS_MIXED_PRECISION
+  LASSO_LAMBDA,     //!< L1 regularization factor for TrainLasso
+  LASSO_ITERATIONS, //!< maximum nr of coordinate descent sweeps for TrainLasso
+  LASSO_TOLERANCE,  //!< relative weight change to stop TrainLasso iterations
+  ALPHA_TOLERANCE,  //!< relative residual to stop the spectral radius estimation
+  ALPHA_ITERATIONS, //!< maximum nr of Arnoldi restarts for the spectral radius
+  FIXED_INDEGREE,   //!< same nr of connections in each row of the reservoir weight matrix
+  JUMP_SIZE,        //!< distance between the neurons of a jump in INIT_CYCLE_JUMPS
+  JUMP_WEIGHT       //!< weight of the jumps relative to the cycle weight in INIT_CYCLE_JUMPS
 };
 
 enum InitAlgorithm
 {
-  INIT_STD
+  INIT_STD,
+  INIT_CYCLE,
+  INIT_CYCLE_JUMPS,
+  INIT_DELAYLINE,
+  INIT_CIRCULANT
 };
 
 enum SimAlgorithm
@@ -279,7 +433,18 @@ enum TrainAlgorithm
   TRAIN_PI,        //!< offline, pseudo inverse based \sa class TrainPI
   TRAIN_LS,        //!< offline least square algorithm, \sa class TrainLS
   TRAIN_RIDGEREG,  //!< with ridge regression, \sa class TrainRidgeReg
-  TRAIN_DS_PI      //!< trains a delay&sum readout with PI \sa class TrainDSPI
+  TRAIN_DS_PI,     //!< trains a delay&sum readout with PI \sa class TrainDSPI
+  TRAIN_RIDGEREG_CV, //!< cross-validated ridge regression \sa class TrainRidgeRegCV
+  TRAIN_RLS,       //!< online recursive least squares \sa class TrainRLS
+  TRAIN_NLMS,      //!< online normalized least mean squares \sa class TrainNLMS
+  TRAIN_LASSO      //!< offline L1 regularized, sparse readout \sa class TrainLasso
+};
+
+enum SearchMode
+{
+  SEARCH_GRID,          //!< all combinations of the parameter values
+  SEARCH_RANDOM,        //!< independent random samples
+  SEARCH_LATIN_HYPERCUBE //!< stratified random samples
 };
 
 enum ActivationFunction
@@ -92,5 +92,126 @@ class test_adaptation(NumpyTestCase):
 	assert_array_almost_equal(states,states2)
 
 
+
+    def testGaussianIPLeaky(self, level=1):
+	""" test Gaussian IP reservoir adaptation with leaky integrator
+	    neurons, the update uses the state after leakage """
+        
+	# setup net
+	lr = random.uniform(0.1,0.0001)
+	mean = random.uniform(-0.1,0.1)
+	var = random.uniform(0.001,0.3)
+	leak = random.uniform(0.1,0.9)
+	self.net.setSimAlgorithm(SIM_LI)
+	self.net.setInitParam(LEAKING_RATE, leak)
+	self.net.setInitParam(IP_LEARNRATE, lr)
+	self.net.setInitParam(IP_MEAN, mean)
+	self.net.setInitParam(IP_VAR, var)
+	self.net.init()
+	
+	# indata
+	indata = N.asfarray(N.random.rand(self.ins,self.sim_size), \
+	                    self.dtype) * 2 - 1
+	
+	# adapt reservoir
+	self.net.adapt(indata)
+	
+	# simulate network and collect states
+	states = N.zeros((self.size,self.sim_size),self.dtype)
+	outtmp = N.zeros((self.outs),self.dtype)
+	for n in range(self.sim_size):
+		intmp = indata[:,n].copy()
+		self.net.simulateStep( intmp, outtmp )
+		states[:,n] = self.net.getX().copy()
+		
+	# get data to python
+	W = N.zeros((self.size,self.size),self.dtype)
+	self.net.getW( W )
+	Win = self.net.getWin()
+	x = N.zeros((self.size))
+	
+	# recalc adaptation algorithm
+	a = N.ones(x.shape)
+	b = N.zeros(x.shape)
+	for n in range(self.sim_size):
+		x = N.dot( W, x ) + N.dot( Win, indata[:,n] ) + (1-leak)*x
+		y = N.tanh( a*x + b )
+		db = -lr*(-mean/var+(y/var)*(2*var+1-y**2+mean*y))
+		b += db
+		a = a + lr/a + db*x
+	
+	# recalc simulation and collect states
+	states2 = N.zeros((self.size,self.sim_size),self.dtype)
+	for n in range(self.sim_size):
+		xold = x
+		x = N.dot( W, x ) + N.dot( Win, indata[:,n] )
+		x = N.tanh( a*x + b ) + (1-leak)*xold
+		states2[:,n] = x
+	
+	assert_array_almost_equal(states,states2)
+
+
+    def testGaussianIPSequences(self, level=1):
+	""" test Gaussian IP reservoir adaptation with independent
+	    sequences and averaged updates """
+        
+	# setup net
+	lr = random.uniform(0.1,0.0001)
+	mean = random.uniform(-0.1,0.1)
+	var = random.uniform(0.001,0.3)
+	seqs = 3
+	self.net.setInitParam(IP_LEARNRATE, lr)
+	self.net.setInitParam(IP_MEAN, mean)
+	self.net.setInitParam(IP_VAR, var)
+	self.net.init()
+	
+	# indata
+	indata = N.asfarray(N.random.rand(self.ins,seqs*self.sim_size), \
+	                    self.dtype) * 2 - 1
+	
+	# adapt reservoir
+	self.net.adapt(indata, seqs)
+	
+	# simulate network and collect states
+	states = N.zeros((self.size,self.sim_size),self.dtype)
+	outtmp = N.zeros((self.outs),self.dtype)
+	for n in range(self.sim_size):
+		intmp = indata[:,n].copy()
+		self.net.simulateStep( intmp, outtmp )
+		states[:,n] = self.net.getX().copy()
+		
+	# get data to python
+	W = N.zeros((self.size,self.size),self.dtype)
+	self.net.getW( W )
+	Win = self.net.getWin()
+	
+	# recalc adaptation algorithm
+	x = N.zeros((self.size,seqs))
+	a = N.ones((self.size))
+	b = N.zeros((self.size))
+	for n in range(self.sim_size):
+		db = N.zeros((self.size))
+		dbx = N.zeros((self.size))
+		for k in range(seqs):
+			x[:,k] = N.dot( W, x[:,k] )
+			x[:,k] += N.dot( Win, indata[:,k*self.sim_size+n] )
+			y = N.tanh( a*x[:,k] + b )
+			dbk = -lr*(-mean/var+(y/var)*(2*var+1-y**2+mean*y))
+			db += dbk
+			dbx += dbk*x[:,k]
+		b += db / seqs
+		a = a + lr/a + dbx / seqs
+	
+	# recalc simulation and collect states
+	x = N.zeros((self.size))
+	states2 = N.zeros((self.size,self.sim_size),self.dtype)
+	for n in range(self.sim_size):
+		x = N.dot( W, x )
+		x += N.dot( Win, indata[:,n] )
+		x = N.tanh( a*x + b )
+		states2[:,n] = x
+	
+	assert_array_almost_equal(states,states2)
+
 if __name__ == "__main__":
     NumpyTest().run()
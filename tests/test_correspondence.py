@@ -1,7 +1,7 @@
 import sys, filtering
 from numpy.testing import *
 import numpy as N
-import random, scipy.signal
+import random, scipy.signal, tempfile, os
 
 # TODO: right module and path handling
 sys.path.append("python/")
@@ -114,6 +114,92 @@ class test_correspondence(NumpyTestCase):
 
 
 
+    def testSaveLoad(self, level=1):
+	""" test if a network loaded from a model file generates the
+	same result """
+        
+	# set bandpass parameters
+	self.net.setSimAlgorithm(SIM_BP)
+	f1 = N.linspace(0.1, 1., self.net.getSize())
+	f2 = N.linspace(0.0001, 0.5, self.net.getSize())
+	self.net.init()
+	self.net.setBPCutoff(f1,f2)
+	
+	# set output weight matrix without training, because the states
+	# of the filters are not saved
+	wout = N.random.rand(self.outs,self.size+self.ins) * 2 - 1
+	wout = N.asfarray(wout, self.dtype)
+	self.net.setWout(wout)
+	
+	# save and load into a default network
+	fd,filename = tempfile.mkstemp('.aures')
+	os.close(fd)
+	self.net.save(filename)
+	if self.dtype is 'float32':
+		netA = SingleESN()
+	else:
+		netA = DoubleESN()
+	netA.load(filename)
+	os.remove(filename)
+	
+	# test matrices
+	assert netA.getSize() == self.size
+	assert netA.getSimAlgorithm() == SIM_BP
+	assert netA.getOutputAct() == ACT_TANH
+	W = N.empty((self.size,self.size),self.dtype)
+	self.net.getW( W )
+	WA = N.empty((self.size,self.size),self.dtype)
+	netA.getW( WA )
+	assert_array_almost_equal(W,WA)
+	assert_array_almost_equal(self.net.getWback(),netA.getWback())
+	assert_array_almost_equal(self.net.getWout(),netA.getWout())
+	assert_array_almost_equal(self.net.getWin(),netA.getWin())
+	assert_array_almost_equal(self.net.getX(),netA.getX())
+	
+	# simulate both networks separate and test result
+	indata = N.random.rand(self.ins,self.sim_size)*2-1
+	indata = N.asfarray(indata, self.dtype)
+	outdata = N.empty((self.outs,self.sim_size),self.dtype)
+	outdataA = N.empty((self.outs,self.sim_size),self.dtype)
+	self.net.simulate( indata, outdata )
+	netA.simulate( indata, outdataA )
+	assert_array_almost_equal(outdata,outdataA)
+
+
+    def testSaveLoadTanh2(self, level=1):
+	""" test if the adapted slope and bias of tanh2 neurons are
+	saved in a model file """
+        
+	self.net.setReservoirAct(ACT_TANH2)
+	self.net.setOutputAct(ACT_LINEAR)
+	self.net.setInitParam(IP_LEARNRATE, 0.01)
+	self.net.setInitParam(IP_VAR, 0.1)
+	self.net.init()
+	indata = N.random.rand(self.ins,self.train_size)*2-1
+	indata = N.asfarray(indata, self.dtype)
+	self.net.adapt(indata)
+	self.net.resetState()
+	
+	fd,filename = tempfile.mkstemp('.aures')
+	os.close(fd)
+	self.net.save(filename)
+	if self.dtype is 'float32':
+		netA = SingleESN()
+	else:
+		netA = DoubleESN()
+	netA.load(filename)
+	os.remove(filename)
+	assert netA.getReservoirAct() == ACT_TANH2
+	
+	indata = N.random.rand(self.ins,self.sim_size)*2-1
+	indata = N.asfarray(indata, self.dtype)
+	outdata = N.empty((self.outs,self.sim_size),self.dtype)
+	outdataA = N.empty((self.outs,self.sim_size),self.dtype)
+	self.net.simulate( indata, outdata )
+	netA.simulate( indata, outdataA )
+	assert_array_almost_equal(outdata,outdataA)
+
+
     def testSetInternalData(self, level=1):
 	""" test if manually setting the weigth matrices generates the
 	same result """
@@ -160,6 +246,228 @@ class test_correspondence(NumpyTestCase):
 	assert_array_almost_equal(outdata,outdataA)
 
 
+    def testSpectralRadius(self, level=1):
+	""" test if the iteratively estimated spectral radius is the same
+	as the one of a full eigendecomposition """
+	
+	size = random.randint(100,200)
+	alpha = random.uniform(0.5,1.)
+	self.net.setSize( size )
+	self.net.setInitParam(CONNECTIVITY, random.uniform(0.05,0.2))
+	self.net.setInitParam(ALPHA, alpha)
+	self.net.setInitParam(ALPHA_TOLERANCE, 1e-8)
+	self.net.init()
+	
+	W = N.empty((size,size),self.dtype)
+	self.net.getW( W )
+	radius = N.abs( N.linalg.eigvals(W) ).max()
+	assert_almost_equal(radius,alpha,6)
+
+
+    def testSpectralRadiusLarge(self, level=1):
+	""" test the spectral radius of a large sparse reservoir, where
+	many eigenvalues are close to the largest one """
+
+	size = random.randint(800,1200)
+	alpha = random.uniform(0.5,1.)
+	self.net.setSize( size )
+	self.net.setInitParam(CONNECTIVITY, random.uniform(0.01,0.03))
+	self.net.setInitParam(ALPHA, alpha)
+	self.net.setInitParam(ALPHA_TOLERANCE, 1e-8)
+	self.net.init()
+
+	W = N.empty((size,size),self.dtype)
+	self.net.getW( W )
+	radius = N.abs( N.linalg.eigvals(W) ).max()
+	assert_almost_equal(radius,alpha,5)
+
+	# no convergence within the allowed nr of restarts
+	self.net.setSize( 500 )
+	self.net.setInitParam(ALPHA_TOLERANCE, 1e-12)
+	self.net.setInitParam(ALPHA_ITERATIONS, 1)
+	self.assertRaises(RuntimeError, self.net.init)
+
+
+    def testFixedIndegree(self, level=1):
+	""" test if the sampled reservoir has the right nr of connections
+	and the same nr in each row with FIXED_INDEGREE """
+	
+	size = random.randint(50,100)
+	conn = random.uniform(0.1,0.5)
+	self.net.setSize( size )
+	self.net.setInitParam(CONNECTIVITY, conn)
+	W = N.empty((size,size),self.dtype)
+	
+	self.net.init()
+	self.net.getW( W )
+	assert_equal( (W!=0).sum(), N.ceil(size*size*conn-0.5) )
+	
+	self.net.setInitParam(FIXED_INDEGREE, 1)
+	self.net.init()
+	self.net.getW( W )
+	indegree = (W!=0).sum(1)
+	assert_equal( indegree, N.ceil(size*conn-0.5)*N.ones(size) )
+
+
+    def testStructuredReservoirs(self, level=1):
+	""" test if the fast simulation of cycle, cycle with jumps, delay
+	line and circulant reservoirs is the same as with the sparse matrix """
+	
+	for alg in [INIT_CYCLE, INIT_CYCLE_JUMPS, INIT_DELAYLINE, INIT_CIRCULANT]:
+		self.net.setInitAlgorithm(alg)
+		self.net.setInitParam(ALPHA, 0.9)
+		self.net.setInitParam(JUMP_SIZE, random.randint(2,4))
+		self.net.setInitParam(JUMP_WEIGHT, random.uniform(0.5,1.))
+		self.net.init()
+		
+		W = N.empty((self.size,self.size),self.dtype)
+		self.net.getW( W )
+		if alg != INIT_DELAYLINE:
+			radius = N.abs( N.linalg.eigvals(W) ).max()
+			assert_almost_equal(radius,0.9,5)
+		if alg == INIT_CIRCULANT:
+			WW = N.dot(W,W.T)
+			assert_array_almost_equal(WW,0.81*N.eye(self.size))
+		
+		# train output weights
+		trainin = N.random.rand(self.ins,self.train_size) * 2 - 1
+		trainout = N.random.rand(self.outs,self.train_size) * 2 - 1
+		trainin = N.asfarray(trainin, self.dtype)
+		trainout = N.asfarray(trainout, self.dtype)
+		self.net.train(trainin,trainout,1)
+		self.net.resetState()
+		
+		# second network with the same weights as sparse matrix
+		if self.dtype is 'float32':
+			netA = SingleESN(self.net)
+		else:
+			netA = DoubleESN(self.net)
+		netA.setW( W )
+		
+		indata = N.random.rand(self.ins,self.sim_size)*2-1
+		indata = N.asfarray(indata, self.dtype)
+		outdata = N.empty((self.outs,self.sim_size),self.dtype)
+		outdataA = N.empty((self.outs,self.sim_size),self.dtype)
+		self.net.simulate( indata, outdata )
+		netA.simulate( indata, outdataA )
+		assert_array_almost_equal(outdata,outdataA)
+
+
+    def testArrayESN(self, level=1):
+	""" test if the parallel simulation of an ArrayESN is the same as
+	averaging the outputs of the single networks in each step """
+	
+	if self.dtype is 'float32':
+		array = SingleArrayESN(self.net, 3)
+	else:
+		array = DoubleArrayESN(self.net, 3)
+	array.init()
+	
+	trainin = N.random.rand(self.ins,self.train_size) * 2 - 1
+	trainout = N.random.rand(self.outs,self.train_size) * 2 - 1
+	trainin = N.asfarray(trainin, self.dtype)
+	trainout = N.asfarray(trainout, self.dtype)
+	array.train(trainin,trainout,1)
+	nets = [ array.getNetwork(i) for i in range(3) ]
+	
+	indata = N.random.rand(self.ins,self.sim_size)*2-1
+	indata = N.asfarray(indata, self.dtype)
+	outdata = N.empty((self.outs,self.sim_size),self.dtype)
+	array.simulate( indata, outdata )
+	
+	# average in each step and feed it back
+	outdataA = N.empty((self.outs,self.sim_size),self.dtype)
+	outstep = N.empty(self.outs,self.dtype)
+	for n in range(self.sim_size):
+		avg = N.zeros(self.outs,self.dtype)
+		for net in nets:
+			net.simulateStep( indata[:,n].copy(), outstep )
+			avg += outstep
+		avg /= 3
+		for net in nets:
+			net.setLastOutput( avg )
+		outdataA[:,n] = avg
+	assert_array_almost_equal(outdata,outdataA)
+
+    def testFusedArrayESN(self, level=1):
+	""" test if the fused ArrayESN gives the same output as the
+	single networks """
+	
+	self.net.setOutputAct(ACT_LINEAR)
+	trainin = N.random.rand(self.ins,self.train_size) * 2 - 1
+	trainout = N.random.rand(self.outs,self.train_size) * 2 - 1
+	trainin = N.asfarray(trainin, self.dtype)
+	trainout = N.asfarray(trainout, self.dtype)
+	
+	# tanh2 neurons have a slope and bias for each network
+	for act in [ACT_TANH, ACT_TANH2]:
+		self.net.setReservoirAct(act)
+		if self.dtype is 'float32':
+			arrays = [ SingleArrayESN(self.net, 3) for i in range(2) ]
+		else:
+			arrays = [ DoubleArrayESN(self.net, 3) for i in range(2) ]
+		
+		for array in arrays:
+			array.setSeed(3)
+			array.init()
+			array.train(trainin,trainout,1)
+		arrays[1].fuse()
+		
+		# simulate twice, to check that the states are copied back
+		for i in range(2):
+			indata = N.random.rand(self.ins,self.sim_size)*2-1
+			indata = N.asfarray(indata, self.dtype)
+			outdata = N.empty((self.outs,self.sim_size),self.dtype)
+			outdataA = N.empty((self.outs,self.sim_size),self.dtype)
+			arrays[0].simulate( indata, outdata )
+			arrays[1].simulate( indata, outdataA )
+			assert_array_almost_equal(outdata,outdataA)
+
+    def testSeed(self, level=1):
+	""" test if networks with the same seed give the same results """
+	
+	if self.dtype is 'float32':
+		netA = SingleESN(self.net)
+		arrays = [ SingleArrayESN(self.net, 3) for i in range(2) ]
+	else:
+		netA = DoubleESN(self.net)
+		arrays = [ DoubleArrayESN(self.net, 3) for i in range(2) ]
+	self.net.setSeed(42)
+	self.net.init()
+	netA.setSeed(42)
+	netA.init()
+	W = N.empty((self.size,self.size),self.dtype)
+	WA = N.empty((self.size,self.size),self.dtype)
+	self.net.getW( W )
+	netA.getW( WA )
+	assert_array_equal(W,WA)
+	
+	trainin = N.random.rand(self.ins,self.train_size) * 2 - 1
+	trainout = N.random.rand(self.outs,self.train_size) * 2 - 1
+	trainin = N.asfarray(trainin, self.dtype)
+	trainout = N.asfarray(trainout, self.dtype)
+	indata = N.random.rand(self.ins,self.sim_size)*2-1
+	indata = N.asfarray(indata, self.dtype)
+	outdata = [ N.empty((self.outs,self.sim_size),self.dtype)
+	            for i in range(2) ]
+	for i in range(2):
+		arrays[i].setSeed(7)
+		arrays[i].setNoise(1e-4)
+		arrays[i].init()
+		arrays[i].train(trainin,trainout,1)
+		arrays[i].simulate( indata, outdata[i] )
+	assert_array_equal(outdata[0],outdata[1])
+	
+	# arrays with neighbouring seeds must not share reservoirs
+	arrays[1].setSeed(8)
+	arrays[1].init()
+	for i in range(3):
+		for j in range(3):
+			arrays[0].getNetwork(i).getW( W )
+			arrays[1].getNetwork(j).getW( WA )
+			assert N.any(W != WA)
+
+
     def testIIRFilters(self, level=1):
 	""" test correspondence of SIM_FILTER and pythons lfilter """
         
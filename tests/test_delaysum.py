@@ -1,7 +1,7 @@
 import sys
 from numpy.testing import *
 import numpy as N
-import random, scipy.signal
+import random, scipy.signal, os, tempfile
 import testesns
 
 # TODO: right module and path handling
@@ -510,6 +510,48 @@ class test_delaysum(NumpyTestCase):
 	assert_array_almost_equal(outA,outB,5)
 
 
+    def testFFTWisdom(self, level=1):
+	""" test if delays and weights don't depend on the FFTW planner
+	    flags and if FFTW wisdom can be saved and loaded """
+        
+	# init network with a second output
+	self.netA.setInitParam(DS_USE_GCC)
+	self.netA.setOutputs(2)
+	self.netA.init()
+	netC = DoubleESN(self.netA)
+	
+	# training data
+	washout = 20
+	train_size = 100
+	indata = N.random.rand(train_size) * 2 - 1
+	outdata = N.zeros((2,train_size))
+	outdata[0] = self._linearIIR(indata,20)
+	outdata[1] = self._linearIIR(indata,10)
+	indata.shape = 1,-1
+	
+	# train with FFTW_ESTIMATE plans
+	setFFTPlannerFlags(FFTW_ESTIMATE)
+	self.netA.train(indata, outdata, washout)
+	delaysA = N.ones((2,self.ins+self.size))
+	self.netA.getDelays(delaysA)
+	woutA = self.netA.getWout().copy()
+	
+	# train with FFTW_MEASURE plans and write/read the wisdom
+	setFFTPlannerFlags(FFTW_MEASURE)
+	netC.train(indata, outdata, washout)
+	filename = tempfile.mktemp()
+	assert exportFFTWisdom(filename)
+	assert importFFTWisdom(filename)
+	os.remove(filename)
+	setFFTPlannerFlags(FFTW_ESTIMATE)
+	delaysC = N.ones((2,self.ins+self.size))
+	netC.getDelays(delaysC)
+	woutC = netC.getWout().copy()
+	
+	assert_array_almost_equal(delaysA,delaysC,5)
+	assert_array_almost_equal(woutA,woutC,5)
+
+
     def testEM(self, level=1):
 	""" test simulation, delay and Wout calculation with
 	    an EM algorithm """
@@ -786,5 +828,148 @@ class test_delaysum(NumpyTestCase):
 	assert_array_almost_equal(outA,outB,5)
 
 
+    def testDS2OutsSerial(self, level=1):
+	""" test if the outputs trained in parallel are the same as
+	    the outputs trained one after the other """
+
+	# init network
+	self.outs = 2
+	self.netA.setOutputs( self.outs )
+	self.netA.setInitParam(DS_USE_GCC)
+	self.netA.setInitParam(DS_EM_ITERATIONS, 3)
+	self.netA.init()
+	W = N.zeros((self.size,self.size))
+	self.netA.getW(W)
+	
+	# training data
+	washout = 20
+	train_size = 100
+	indata = N.random.rand(train_size) * 2 - 1
+	outdata = N.zeros((2,train_size))
+	outdata[0] = self._linearIIR(indata,5)
+	outdata[1] = self._linearIIR(indata,15)
+	indata.shape = 1,-1
+	
+	# train all outputs at once
+	self.netA.train(indata, outdata, washout)
+	delaysA = N.ones((self.outs,self.ins+self.size))
+	self.netA.getDelays(delaysA)
+	woutA = self.netA.getWout().copy()
+	
+	# train each output with an own network with the same reservoir
+	for n in range(self.outs):
+		netC = DoubleESN(self.netA)
+		netC.setOutputs(1)
+		netC.init()
+		netC.setWin( self.netA.getWin().copy() )
+		netC.setW(W)
+		
+		netC.train(indata, outdata[n:n+1].copy(), washout)
+		delaysC = N.ones((1,self.ins+self.size))
+		netC.getDelays(delaysC)
+		woutC = netC.getWout().copy()
+		
+		assert_array_almost_equal(delaysA[n:n+1],delaysC,5)
+		assert_array_almost_equal(woutA[n:n+1],woutC,5)
+
+
+    def testEMTolerance(self, level=1):
+	""" test if the EM iterations stop with DS_EM_TOLERANCE and
+	    if the callback is called in each iteration """
+
+	# init network
+	emiters = 100
+	self.netA.setInitParam(DS_USE_CROSSCORR)
+	self.netA.setInitParam(DS_EM_ITERATIONS, emiters)
+	self.netA.setInitParam(DS_EM_TOLERANCE, 1e10)
+	self.netA.setInitParam(DS_MAXDELAY, 30)
+	self.netA.init()
+	netC = DoubleESN(self.netA)
+	
+	# training data
+	washout = 30
+	train_size = 150
+	indata = N.random.rand(train_size) * 2 - 1
+	outdata = self._linearIIR(indata,10)
+	indata.shape = 1,-1
+	outdata.shape = 1,-1
+	
+	# train and record the EM iterations
+	log = DoubleEMLog()
+	log.attach(self.netA)
+	self.netA.train(indata, outdata, washout)
+	log.detach(self.netA)
+	rows = N.zeros((log.getNrRows(),5))
+	log.getLog(rows)
+	delaysA = N.ones((self.outs,self.ins+self.size))
+	self.netA.getDelays(delaysA)
+	woutA = self.netA.getWout().copy()
+	
+	# one call per iteration, the iterations stop as soon as the
+	# delays are unchanged
+	iters = len(rows)
+	assert 0 < iters < emiters
+	assert_array_equal(rows[:,0],N.ones(iters))
+	assert_array_equal(rows[:,1],N.arange(1,iters+1))
+	assert rows[-1,2] == 0
+	assert (rows[:-1,2] > 0).all()
+	
+	# the same result with a fixed nr of iterations
+	netC.setInitParam(DS_EM_ITERATIONS, iters)
+	netC.setInitParam(DS_EM_TOLERANCE, 0)
+	netC.train(indata, outdata, washout)
+	delaysC = N.ones((self.outs,self.ins+self.size))
+	netC.getDelays(delaysC)
+	woutC = netC.getWout().copy()
+	assert_array_almost_equal(delaysA,delaysC,5)
+	assert_array_almost_equal(woutA,woutC,5)
+
+
+    def testDelaysCrosscorrTimeDomain(self, level=1):
+	""" test if the time domain cross correlation for small maximum
+	    delays gives the same delays as the FFT based calculation """
+	
+	# with 1000 steps the FFT is more expensive for DS_MAXDELAY = 10,
+	# with DS_MAXDELAY = 100 the FFT is used
+	for maxdelay in [10,100]:
+		self.setUp()
+		self.netA.setInitParam(DS_USE_CROSSCORR)
+		self.netA.setInitParam(DS_MAXDELAY, maxdelay)
+		self.netB.gcctype = 'unfiltered'
+		self.netB.squareupdate = 0
+		self.netB.maxdelay = maxdelay
+		self.netA.init()
+		self.netB.init()
+		
+		# set internal data of netB to the same as in netA
+		self.netB.setWin( self.netA.getWin().copy() )
+		W = N.zeros((self.size,self.size))
+		self.netA.getW(W)
+		self.netB.setW(W)
+		
+		# training data
+		washout = 100
+		iir_delay = 5
+		train_size = 1000
+		indata = N.random.rand(train_size) * 2 - 1
+		outdata = self._linearIIR(indata,iir_delay)
+		indata.shape = 1,-1
+		outdata.shape = 1,-1
+		
+		# train data with python ESN (FFT based)
+		self.netB.train(indata, outdata, washout)
+		delaysB = self.netB.delays
+		woutB = self.netB.getWout().copy()
+		
+		# C++ network
+		self.netA.train(indata, outdata, washout)
+		delaysA = N.ones((self.outs,self.ins+self.size))
+		self.netA.getDelays(delaysA)
+		woutA = self.netA.getWout().copy()
+		
+		assert_array_almost_equal(delaysA,delaysB,5)
+		assert_array_almost_equal(woutA,woutB,5)
+
+
 if __name__ == "__main__":
     NumpyTest().run()
@@ -141,6 +141,79 @@ class test_train(NumpyTestCase):
 	assert_array_almost_equal(wout_target,wout,1)
 
 
+    def testLSMixedPrecision(self, level=1):
+	""" test TRAIN_LS of a single precision net with double precision solve """
+        
+	# single precision network
+	self.dtype = 'float32'
+	self.net = SingleESN()
+	self.net.setReservoirAct(ACT_LINEAR)
+	self.net.setOutputAct(ACT_LINEAR)
+	self.net.setSize( self.size )
+	self.net.setInputs( self.ins )
+	self.net.setOutputs( self.outs )
+	self.net.setInitParam(CONNECTIVITY, self.conn)
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setInitParam(LS_MIXED_PRECISION, 1)
+	self.net.setInitParam(LS_REFINEMENT_STEPS, 3)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_LS)
+	self.net.init()
+	
+	# train network
+	washout = 2
+	indata = N.random.rand(self.ins,self.train_size) * 2 - 1
+	outdata = N.random.rand(self.outs,self.train_size) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	outdata = N.asfarray( outdata, self.dtype )
+	self.net.train( indata, outdata, washout )
+	wout_target = self.net.getWout().copy()
+	
+	# teacher forcing, collect states
+	X = self._teacherForcing(indata,outdata)
+	
+	# restructure data and calc pseudo inverse in double precision
+	M = N.r_[X,indata]
+	M = N.asfarray( M[:,washout:self.train_size].T, 'float64' )
+	T = N.asfarray( outdata[:,washout:self.train_size].T, 'float64' )
+	wout = ( N.dot(pinv(M),T) ).T
+	
+	# normalize result for comparison
+	wout = wout / abs(wout).max()
+	wout_target = wout_target / abs(wout_target).max()
+	assert_array_almost_equal(wout_target,wout,3)
+	
+
+    def testOutOfCore(self, level=1):
+	""" test TRAIN_PI and TRAIN_LS with out of core state storage """
+        
+	washout = 2
+	steps = 4*self.train_size
+	indata = N.random.rand(self.ins,steps) * 2 - 1
+	outdata = N.random.rand(self.outs,steps) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	outdata = N.asfarray( outdata, self.dtype )
+	
+	for alg in [TRAIN_PI, TRAIN_LS]:
+		# init network
+		self.net.setSimAlgorithm(SIM_STD)
+		self.net.setTrainAlgorithm(alg)
+		self.net.init()
+		
+		# train in memory
+		self.net.train( indata, outdata, washout )
+		wout_target = self.net.getWout().copy()
+		
+		# train out of core with a short last tile
+		self.net.setInitParam(OOC_TILE_ROWS, 9)
+		self.net.resetState()
+		self.net.train( indata, outdata, washout )
+		wout = self.net.getWout().copy()
+		self.net.setInitParam(OOC_TILE_ROWS, 0)
+		
+		assert_array_almost_equal(wout_target,wout,5)
+	
+
     def testRidgeRegression(self, level=1):
 	""" test TRAIN_RIDGEREG with noise input without feedback """
         
@@ -213,6 +286,491 @@ class test_train(NumpyTestCase):
 	#assert_array_almost_equal(wout_ridge,wout_pi,5)
 
 
+    def testRidgeRegressionPath(self, level=1):
+	""" test ridge regression path for multiple regularization factors """
+        
+	# init network
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_RIDGEREG)
+	self.net.init()
+	
+	# generate data
+	washout = 2
+	alphas = N.array([0.1, 0.7, 2.], self.dtype)
+	indata = N.random.rand(self.ins,self.train_size) * 2 - 1
+	outdata = N.random.rand(self.outs,self.train_size) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	outdata = N.asfarray( outdata, self.dtype )
+	
+	# calc the whole path
+	self.net.resetState()
+	wouts = N.empty((len(alphas)*self.outs,self.size+self.ins),self.dtype)
+	self.net.ridgeRegressionPath( indata, outdata, washout, alphas, wouts )
+	
+	# teacher forcing, collect states
+	X = self._teacherForcing(indata,outdata)
+	
+	# restructure data
+	S = N.r_[X,indata]
+	S = S[:,washout:self.train_size].T
+	T = outdata[:,washout:self.train_size].T
+	
+	# compare with ridge regression for each factor
+	for k in range(len(alphas)):
+		wout = N.dot( N.dot( inv( N.dot(S.T,S) + (alphas[k]**2) * \
+		              N.eye(self.size+self.ins) ), S.T ), T ).T
+		wout_target = wouts[k*self.outs:(k+1)*self.outs,:]
+		assert_array_almost_equal(wout_target,wout,5)
+
+
+    def testStateFactorization(self, level=1):
+	""" test training of several targets with factorized states """
+        
+	# init network
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_PI)
+	self.net.init()
+	
+	washout = 2
+	indata = N.random.rand(self.ins,self.train_size) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	if self.dtype is 'float32':
+		fact = SingleStateFactorization(self.net)
+	else:
+		fact = DoubleStateFactorization(self.net)
+	self.net.resetState()
+	fact.factorize( indata, washout )
+	
+	# all targets at once
+	targets = 3
+	outdata = N.random.rand(targets*self.outs,self.train_size) * 2 - 1
+	outdata = N.asfarray( outdata, self.dtype )
+	W = N.empty((targets*self.outs,self.size+self.ins),self.dtype)
+	fact.solve( outdata, W, 0. )
+	
+	for t in range(targets):
+		out = outdata[t*self.outs:(t+1)*self.outs,:].copy()
+		
+		# usual training with TRAIN_PI
+		self.net.resetState()
+		self.net.train( indata, out, washout )
+		wout_target = self.net.getWout().copy()
+		
+		# training from the factorization
+		fact.train( out, 0. )
+		wout = self.net.getWout().copy()
+		
+		assert_array_almost_equal(wout_target,wout,5)
+		assert_array_almost_equal(W[t*self.outs:(t+1)*self.outs,:],wout)
+	
+
+    def testParamSearch(self, level=1):
+	""" test grid and latin hypercube parameter search """
+        
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_PI)
+	
+	washout = 2
+	indata = N.random.rand(self.ins,self.train_size) * 2 - 1
+	outdata = N.random.rand(self.outs,self.train_size) * 2 - 1
+	testin = N.random.rand(self.ins,self.train_size) * 2 - 1
+	testout = N.random.rand(self.outs,self.train_size) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	outdata = N.asfarray( outdata, self.dtype )
+	testin = N.asfarray( testin, self.dtype )
+	testout = N.asfarray( testout, self.dtype )
+	
+	# grid search, same results with the same seed
+	alphas = N.array([0.5,0.8],self.dtype)
+	conns = N.array([0.3,0.6,0.9],self.dtype)
+	regs = N.array([0.,0.1],self.dtype)
+	results = []
+	seeds = []
+	for i in range(2):
+		if self.dtype is 'float32':
+			search = SingleParamSearch(self.net)
+		else:
+			search = DoubleParamSearch(self.net)
+		search.setValues(ALPHA, alphas)
+		search.setValues(CONNECTIVITY, conns)
+		search.setValues(TIKHONOV_FACTOR, regs)
+		search.setSeed(5)
+		search.run(indata, outdata, washout, testin, testout)
+		res = N.empty((search.getNrResults(),search.getNrColumns()),self.dtype)
+		search.getResults(res)
+		results.append(res)
+		seeds.append([search.getSeed(t) for t in range(len(res))])
+	assert_equal(results[0].shape, (12,10))
+	assert_array_equal(results[0][:,9],0)
+	assert_array_equal(results[0][:,:4],results[1][:,:4])
+	assert_equal(seeds[0],seeds[1])
+	assert_array_equal(results[0][::2,2],regs[0])
+	assert_array_equal(results[0][1::2,2],regs[1])
+	
+	# same NRMSE as a single network with this seed and TRAIN_PI
+	if self.dtype is 'float32':
+		net = SingleESN(self.net)
+	else:
+		net = DoubleESN(self.net)
+	net.setInitParam(ALPHA, results[0][0,0])
+	net.setInitParam(CONNECTIVITY, results[0][0,1])
+	net.setSeed( seeds[0][0] )
+	net.init()
+	net.train(indata, outdata, washout)
+	simout = N.empty(testout.shape,self.dtype)
+	net.simulate(testin, simout)
+	err = N.sum( (simout-testout)[:,washout:]**2 )
+	var = N.sum( (testout[:,washout:]-testout[:,washout:].mean())**2 )
+	assert_almost_equal(results[0][0,3], N.sqrt(err/var), 5)
+	
+	# latin hypercube: each stratum is used once
+	trials = 8
+	if self.dtype is 'float32':
+		search = SingleParamSearch(self.net)
+	else:
+		search = DoubleParamSearch(self.net)
+	search.setRange(ALPHA, 0., 0.8)
+	search.setMode(SEARCH_LATIN_HYPERCUBE, trials)
+	search.run(indata, outdata, washout, testin, testout)
+	res = N.empty((search.getNrResults(),search.getNrColumns()),self.dtype)
+	search.getResults(res)
+	strata = N.sort( N.floor(res[:,0] / 0.1) )
+	assert_array_equal(strata, N.arange(trials))
+	
+	# the full 64 bit seed reproduces a trial in both precisions
+	for dtype in ['float32','float64']:
+		if dtype is 'float32':
+			model = SingleESN()
+		else:
+			model = DoubleESN()
+		model.setSize( self.size )
+		model.setInputs( self.ins )
+		model.setOutputs( self.outs )
+		model.setReservoirAct(ACT_TANH)
+		model.setInitParam(FB_CONNECTIVITY, 0)
+		model.setTrainAlgorithm(TRAIN_PI)
+		if dtype is 'float32':
+			search = SingleParamSearch(model)
+		else:
+			search = DoubleParamSearch(model)
+		search.setRange(ALPHA, 0.2, 0.9)
+		search.setMode(SEARCH_RANDOM, 3)
+		search.setSeed(11)
+		ind = N.asfarray( indata, dtype )
+		outd = N.asfarray( outdata, dtype )
+		tin = N.asfarray( testin, dtype )
+		tout = N.asfarray( testout, dtype )
+		search.run(ind, outd, washout, tin, tout)
+		res = N.empty((search.getNrResults(),search.getNrColumns()),dtype)
+		search.getResults(res)
+		for t in range(len(res)):
+			if dtype is 'float32':
+				trial = SingleESN(model)
+			else:
+				trial = DoubleESN(model)
+			trial.setInitParam(ALPHA, res[t,0])
+			trial.setSeed( search.getSeed(t) )
+			trial.init()
+			trial.train(ind, outd, washout)
+			simout = N.empty(tout.shape,dtype)
+			trial.simulate(tin, simout)
+			err = N.sum( (simout-tout)[:,washout:]**2 )
+			var = N.sum( (tout[:,washout:]-tout[:,washout:].mean())**2 )
+			assert_almost_equal(res[t,2], N.sqrt(err/var), 4)
+	
+
+    def testParamSearchScreening(self, level=1):
+	""" test rejection of reservoirs with a too large gain """
+        
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setReservoirAct(ACT_TANH)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_PI)
+	
+	washout = 2
+	indata = N.random.rand(self.ins,self.train_size) * 2 - 1
+	outdata = N.random.rand(self.outs,self.train_size) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	outdata = N.asfarray( outdata, self.dtype )
+	
+	if self.dtype is 'float32':
+		search = SingleParamSearch(self.net)
+	else:
+		search = DoubleParamSearch(self.net)
+	search.setValues(ALPHA, N.array([0.5,5.],self.dtype))
+	search.setScreening(2., 1., 0., 10)
+	search.run(indata, outdata, washout, indata, outdata)
+	res = N.empty((search.getNrResults(),search.getNrColumns()),self.dtype)
+	search.getResults(res)
+	
+	assert N.isfinite(res[0,2])
+	assert_equal(res[0,8], 0)
+	assert_equal(res[1,8], 1)
+	assert res[1,5] > 2.
+	assert_equal(search.getBest(), 0)
+
+	# the gain of a cycle reservoir is exactly its spectral radius,
+	# the product uses the structured reservoir
+	self.net.setInitAlgorithm(INIT_CYCLE)
+	if self.dtype is 'float32':
+		search = SingleParamSearch(self.net)
+	else:
+		search = DoubleParamSearch(self.net)
+	search.setValues(ALPHA, N.array([0.5,0.9],self.dtype))
+	search.setScreening(2., 1., 0., 10)
+	search.run(indata, outdata, washout, indata, outdata)
+	res = N.empty((search.getNrResults(),search.getNrColumns()),self.dtype)
+	search.getResults(res)
+	assert_array_almost_equal(res[:,5], res[:,0], 5)
+	
+
+    def testRidgeRegressionCV(self, level=1):
+	""" test TRAIN_RIDGEREG_CV validation errors and chosen readout """
+        
+	# init network
+	folds = 4
+	steps = 5
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setInitParam(CV_FOLDS, folds)
+	self.net.setInitParam(CV_TIKHONOV_MIN, 0.01)
+	self.net.setInitParam(CV_TIKHONOV_MAX, 10.)
+	self.net.setInitParam(CV_TIKHONOV_STEPS, steps)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_RIDGEREG_CV)
+	self.net.init()
+	
+	# train network
+	washout = 2
+	train_size = 100
+	indata = N.random.rand(self.ins,train_size) * 2 - 1
+	outdata = N.random.rand(self.outs,train_size) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	outdata = N.asfarray( outdata, self.dtype )
+	self.net.train( indata, outdata, washout )
+	wout_target = self.net.getWout().copy()
+	errors_target = N.empty((steps,folds+1),self.dtype)
+	self.net.getCVErrors( errors_target )
+	
+	# teacher forcing, collect states
+	X = self._teacherForcing(indata,outdata)
+	
+	# restructure data
+	S = N.r_[X,indata]
+	S = S[:,washout:train_size].T
+	T = outdata[:,washout:train_size].T
+	rows = S.shape[0]
+	
+	# calc validation errors with contiguous folds
+	alphas = 0.01 * (10./0.01) ** (N.arange(steps) / (steps-1.))
+	errors = N.empty((steps,folds+1),self.dtype)
+	errors[:,0] = alphas
+	for k in range(folds):
+		val = N.arange(k*rows//folds, (k+1)*rows//folds)
+		trn = N.setdiff1d( N.arange(rows), val )
+		for a in range(steps):
+			wout = N.dot( inv( N.dot(S[trn].T,S[trn]) + (alphas[a]**2) * \
+			              N.eye(self.size+self.ins) ), N.dot(S[trn].T,T[trn]) )
+			errors[a,k+1] = N.mean( (T[val] - N.dot(S[val],wout))**2 )
+	assert_array_almost_equal(errors_target,errors,5)
+	
+	# readout with the best factor on all data
+	best = alphas[ N.argmin( errors[:,1:].sum(1) ) ]
+	wout = N.dot( inv( N.dot(S.T,S) + (best**2) * \
+	              N.eye(self.size+self.ins) ), N.dot(S.T,T) ).T
+	assert_array_almost_equal(wout_target,wout,5)
+	assert_almost_equal(self.net.getInitParam(TIKHONOV_FACTOR),best,5)
+
+
+    def testLasso(self, level=1):
+	""" test TRAIN_LASSO without regularization against the pseudo inverse """
+        
+	# init network
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setInitParam(LASSO_LAMBDA, 0)
+	self.net.setInitParam(LASSO_ITERATIONS, 100000)
+	self.net.setInitParam(LASSO_TOLERANCE, 1e-12)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_LASSO)
+	self.net.init()
+	
+	# train network
+	washout = 2
+	steps = 3*self.train_size
+	indata = N.random.rand(self.ins,steps) * 2 - 1
+	outdata = N.random.rand(self.outs,steps) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	outdata = N.asfarray( outdata, self.dtype )
+	self.net.train( indata, outdata, washout )
+	wout_target = self.net.getWout().copy()
+	
+	# teacher forcing, collect states
+	X = self._teacherForcing(indata,outdata)
+	
+	# restructure data
+	M = N.r_[X,indata]
+	M = M[:,washout:steps].T
+	T = outdata[:,washout:steps].T
+	
+	# calc pseudo inverse: wout = pinv(M) * T
+	wout = ( N.dot(pinv(M),T) ).T
+	
+	# normalize result for comparison
+	wout = wout / abs(wout).max()
+	wout_target = wout_target / abs(wout_target).max()
+	assert_array_almost_equal(wout_target,wout,2)
+	
+
+    def testLassoSparseReadout(self, level=1):
+	""" test simulation with the compressed readout of TRAIN_LASSO """
+        
+	# init network
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setInitParam(LASSO_LAMBDA, 0.05)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_LASSO)
+	self.net.init()
+	
+	# train network
+	washout = 2
+	indata = N.random.rand(self.ins,self.train_size) * 2 - 1
+	outdata = N.random.rand(self.outs,self.train_size) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	outdata = N.asfarray( outdata, self.dtype )
+	self.net.train( indata, outdata, washout )
+	wout = self.net.getWout().copy()
+	assert (wout == 0).sum() > 0
+	
+	# simulate network
+	self.net.resetState()
+	output = N.empty((self.outs,self.train_size),self.dtype)
+	self.net.simulate( indata, output )
+	
+	# dense readout of the teacher forced states
+	X = self._teacherForcing(indata,outdata)
+	target = N.dot( wout, N.r_[X,indata] )
+	assert_array_almost_equal(target,output)
+	
+
+    def testRLS(self, level=1):
+	""" test TRAIN_RLS, which must converge to ridge regression """
+        
+	# init network
+	delta = 0.5
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setInitParam(RLS_LAMBDA, 1.)
+	self.net.setInitParam(RLS_DELTA, delta)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_RLS)
+	self.net.init()
+	
+	# train network
+	washout = 2
+	indata = N.random.rand(self.ins,self.train_size) * 2 - 1
+	outdata = N.random.rand(self.outs,self.train_size) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	outdata = N.asfarray( outdata, self.dtype )
+	self.net.train( indata, outdata, washout )
+	wout_target = self.net.getWout().copy()
+	
+	# teacher forcing, collect states
+	X = self._teacherForcing(indata,outdata)
+	
+	# restructure data
+	S = N.r_[X,indata]
+	S = S[:,washout:self.train_size].T
+	T = outdata[:,washout:self.train_size].T
+	
+	# calc ridge regression with TIKHONOV_FACTOR^2 = RLS_DELTA
+	wout = N.dot( inv( N.dot(S.T,S) + delta * \
+	              N.eye(self.size+self.ins) ), N.dot(S.T,T) ).T
+	assert_array_almost_equal(wout_target,wout,5)
+
+
+    def testRLSReset(self, level=1):
+	""" test if TRAIN_RLS starts again after init and if a new
+	RLS_DELTA is used """
+
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setInitParam(RLS_LAMBDA, 0.99)
+	self.net.setInitParam(RLS_DELTA, 0.5)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_RLS)
+	self.net.setSeed(3)
+	self.net.init()
+	if self.dtype is 'float32':
+		ref = SingleESN(self.net)
+	else:
+		ref = DoubleESN(self.net)
+
+	indata = N.random.rand(self.ins,self.train_size) * 2 - 1
+	target = N.random.rand(self.outs,self.train_size) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	target = N.asfarray( target, self.dtype )
+	outdata = N.empty((self.outs,self.train_size),self.dtype)
+	outref = N.empty((self.outs,self.train_size),self.dtype)
+
+	# same reservoir after init, the online training starts again
+	self.net.trainOnline( indata[:,::-1].copy(), target, outdata )
+	self.net.setSeed(3)
+	self.net.init()
+	self.net.trainOnline( indata, target, outdata )
+	ref.trainOnline( indata, target, outref )
+	assert_array_almost_equal(self.net.getWout(),ref.getWout(),5)
+
+	# a new RLS_DELTA reinitializes the inverse correlation matrix
+	wout = N.zeros((self.outs,self.size+self.ins),self.dtype)
+	self.net.setInitParam(RLS_DELTA, 2.)
+	self.net.setWout( wout )
+	self.net.resetState()
+	if self.dtype is 'float32':
+		fresh = SingleESN(self.net)
+	else:
+		fresh = DoubleESN(self.net)
+	self.net.trainOnline( indata, target, outdata )
+	fresh.trainOnline( indata, target, outref )
+	assert_array_almost_equal(self.net.getWout(),fresh.getWout(),5)
+
+
+    def testNLMS(self, level=1):
+	""" test online TRAIN_NLMS without feedback """
+        
+	# init network
+	mu = 0.5
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setInitParam(NLMS_MU, mu)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_NLMS)
+	self.net.init()
+	
+	# online training
+	indata = N.random.rand(self.ins,self.train_size) * 2 - 1
+	target = N.random.rand(self.outs,self.train_size) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	target = N.asfarray( target, self.dtype )
+	outdata = N.empty((self.outs,self.train_size),self.dtype)
+	self.net.trainOnline( indata, target, outdata )
+	wout_target = self.net.getWout().copy()
+	
+	# states do not depend on the output without feedback
+	X = self._teacherForcing(indata,target)
+	S = N.r_[X,indata]
+	
+	# recalc NLMS with the a priori error
+	wout = N.zeros((self.outs,self.size+self.ins),self.dtype)
+	y = N.empty((self.outs,self.train_size),self.dtype)
+	eps = N.finfo(self.dtype).eps
+	for n in range(self.train_size):
+		z = S[:,n]
+		y[:,n] = N.dot( wout, z )
+		e = target[:,n] - y[:,n]
+		wout += mu / ( eps + N.dot(z,z) ) * N.outer( e, z )
+	assert_array_almost_equal(outdata,y,5)
+	assert_array_almost_equal(wout_target,wout,5)
+
+
     def testPISquare(self, level=1):
 	""" test squared updates with TANH activation functions """
         
@@ -332,5 +890,108 @@ class test_train(NumpyTestCase):
 	assert_array_almost_equal(X1,X2)
 
 
+    def testTrainEpisodes(self, level=1):
+	""" test TRAIN_PI with several episodes without feedback """
+        
+	# init network
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setSimAlgorithm(SIM_STD)
+	self.net.setTrainAlgorithm(TRAIN_PI)
+	self.net.init()
+	
+	# episodes with different lengths and washouts
+	lengths = N.array([self.train_size, self.train_size+5, 14], N.int32)
+	washouts = N.array([2, 4, 3], N.int32)
+	steps = lengths.sum()
+	indata = N.random.rand(self.ins,steps) * 2 - 1
+	outdata = N.random.rand(self.outs,steps) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	outdata = N.asfarray( outdata, self.dtype )
+	self.net.trainEpisodes( indata, outdata, lengths, washouts )
+	wout_target = self.net.getWout().copy()
+	
+	# teacher forcing of each episode, collect states
+	M = N.empty((0,self.size+self.ins),self.dtype)
+	T = N.empty((0,self.outs),self.dtype)
+	start = 0
+	for k in range(len(lengths)):
+		end = start + lengths[k]
+		X = self._teacherForcing(indata[:,start:end],outdata[:,start:end])
+		Mk = N.r_[X,indata[:,start:end]]
+		M = N.r_[M, Mk[:,washouts[k]:].T]
+		T = N.r_[T, outdata[:,start+washouts[k]:end].T]
+		start = end
+	
+	# calc pseudo inverse: wout = pinv(M) * T
+	wout = ( N.dot(pinv(M),T) ).T
+	
+	# normalize result for comparison
+	wout = wout / abs(wout).max()
+	wout_target = wout_target / abs(wout_target).max()
+	assert_array_almost_equal(wout_target,wout,2)
+
+
+    def testTrainEpisodesBP(self, level=1):
+	""" test TRAIN_PI with several episodes and bandpass neurons,
+	    the filters of each episode start from a reset state """
+        
+	# init network
+	self.net.setInitParam(FB_CONNECTIVITY, 0)
+	self.net.setSimAlgorithm(SIM_BP)
+	self.net.setTrainAlgorithm(TRAIN_PI)
+	self.net.init()
+	
+	# set cutoff frequencies
+	f1 = N.random.rand(self.size) * 0.8 + 0.1
+	f2 = N.random.rand(self.size) * 0.8 + 0.1
+	self.net.setBPCutoff(f1,f2)
+	
+	# more episodes than threads
+	episodes = 8
+	lengths = N.array([random.randint(10,20) for k in range(episodes)],
+	                  N.int32)
+	washouts = N.array([random.randint(0,3) for k in range(episodes)],
+	                   N.int32)
+	steps = lengths.sum()
+	indata = N.random.rand(self.ins,steps) * 2 - 1
+	outdata = N.random.rand(self.outs,steps) * 2 - 1
+	indata = N.asfarray( indata, self.dtype )
+	outdata = N.asfarray( outdata, self.dtype )
+	self.net.trainEpisodes( indata, outdata, lengths, washouts )
+	wout_target = self.net.getWout().copy()
+	
+	# get data to python
+	W = N.empty((self.size,self.size),self.dtype)
+	self.net.getW( W )
+	Win = self.net.getWin()
+	scale = f2 / f1 + 1.
+	
+	# recalc simulation of each episode, collect states
+	M = N.empty((0,self.size+self.ins),self.dtype)
+	T = N.empty((0,self.outs),self.dtype)
+	start = 0
+	for k in range(episodes):
+		x = N.zeros((self.size))
+		ema1 = N.zeros((self.size))
+		ema2 = N.zeros((self.size))
+		for n in range(start,start+lengths[k]):
+			x = N.dot( W, x ) + N.dot( Win, indata[:,n] )
+			ema1 = ema1 + f1 * (x-ema1)
+			ema2 = ema2 + f2 * (ema1-ema2)
+			x = (ema1 - ema2) * scale
+			if n >= start + washouts[k]:
+				M = N.r_[M, N.r_[x,indata[:,n]][N.newaxis,:]]
+				T = N.r_[T, outdata[:,n][N.newaxis,:]]
+		start += lengths[k]
+	
+	# calc pseudo inverse: wout = pinv(M) * T
+	wout = ( N.dot(pinv(M),T) ).T
+	
+	# normalize result for comparison
+	wout = wout / abs(wout).max()
+	wout_target = wout_target / abs(wout_target).max()
+	assert_array_almost_equal(wout_target,wout,2)
+
+
 if __name__ == "__main__":
     NumpyTest().run()